@@ -11,6 +11,12 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <utility>
+#include <mutex>
+#include <atomic>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
 
 #include <cassert>
 #include <cstdint>
@@ -20,7 +26,7 @@ namespace RegScript2
 {
 
 // For internal use only.
-extern const wchar_t* const ERR_MSG_VALUE_NOT_CONST;
+extern const Char_t* const ERR_MSG_VALUE_NOT_CONST;
 
 class StructDesc;
 
@@ -29,17 +35,20 @@ class EnumDesc
 public:
 	static const size_t INVALID_INDEX = (size_t)-1;
 
-	const wchar_t* Name;
+	const Char_t* Name;
 	size_t ItemCount;
-	const wchar_t* const* ItemNames;
+	const Char_t* const* ItemNames;
 	// Optional. If null, values are just indices to ItemNames: 0, 1, 2, ...
 	const int32_t* ItemValues;
 
-	// All passed pointers must exist during lifetime of this object. Data is not copied.
+	/*
+	All passed pointers must exist during lifetime of this object. Data is not copied.
+	Items must not change after first lookup, which builds index of names and values.
+	*/
 	EnumDesc(
-		const wchar_t* name,
+		const Char_t* name,
 		size_t itemCount,
-		const wchar_t* const* itemNames,
+		const Char_t* const* itemNames,
 		const int32_t* itemValues = nullptr);
 	
 	// Works regardless of whether ItemValues != null.
@@ -49,7 +58,9 @@ public:
 	}
 
 	// Returns index or INVALID_INDEX if not found.
-	size_t FindItemByName(const wchar_t* name, bool caseSensitive) const;
+	size_t FindItemByName(const Char_t* name, bool caseSensitive) const;
+	// name doesn't need to be null-terminated.
+	size_t FindItemByName(const Char_t* name, size_t nameLen, bool caseSensitive) const;
 	// Returns index or INVALID_INDEX if not found.
 	size_t FindItemByValue(int32_t value) const;
 
@@ -57,8 +68,32 @@ public:
 	{
 		return FindItemByValue(value) != INVALID_INDEX;
 	}
-	void ValueToStr(std::wstring& out, int32_t value) const;
-	bool StrToValue(int32_t& out, const wchar_t* str, bool caseSensitive, bool allowInteger) const;
+	void ValueToStr(String_t& out, int32_t value) const;
+	void AppendValueToStr(String_t& out, int32_t value) const;
+	bool StrToValue(int32_t& out, const Char_t* str, bool caseSensitive, bool allowInteger) const;
+	bool StrToValue(int32_t& out, const Char_t* str, size_t strLen, bool caseSensitive, bool allowInteger) const;
+
+private:
+	struct ValueEntry
+	{
+		int32_t Value;
+		uint32_t Index;
+	};
+
+	// Index is built on first lookup. Thread-safe, as enum descriptors are often static and shared.
+	mutable std::once_flag m_IndexBuilt;
+	// Values are indices into ItemNames.
+	mutable NameIndex m_NameIndex;
+	/*
+	Used when ItemValues are not too sparse: element i is index of item with
+	value m_MinValue + i, or UINT32_MAX. Otherwise m_SortedValues is used, sorted
+	by value, for binary search.
+	*/
+	mutable std::vector<uint32_t> m_DenseValues;
+	mutable int32_t m_MinValue = 0;
+	mutable std::vector<ValueEntry> m_SortedValues;
+
+	void BuildIndex() const;
 };
 
 template<typename Enum_t>
@@ -68,25 +103,25 @@ class TypedEnumDesc : public EnumDesc
 
 public:
 	TypedEnumDesc(
-		const wchar_t* name,
+		const Char_t* name,
 		size_t itemCount,
-		const wchar_t* const* itemNames,
+		const Char_t* const* itemNames,
 		const int32_t* itemValues = nullptr) :
 		EnumDesc(name, itemCount, itemNames, itemValues)
 	{
 	}
 	TypedEnumDesc(
-		const wchar_t* name,
+		const Char_t* name,
 		size_t itemCount,
-		const wchar_t* const* itemNames,
+		const Char_t* const* itemNames,
 		const Enum_t* itemValues) :
 		EnumDesc(name, itemCount, itemNames, (const int32_t*)itemValues)
 	{
 	}
 
 	bool ValueIsValid(Enum_t value) const { return EnumDesc::ValueIsValid((int32_t)value); }
-	void ValueToStr(std::wstring& out, Enum_t value) const { EnumDesc::ValueToStr(out, (int32_t)value); }
-	bool StrToValue(Enum_t& out, const wchar_t* str, bool caseSensitive, bool allowInteger) const { return EnumDesc::StrToValue((int32_t&)out, str, caseSensitive, allowInteger); }
+	void ValueToStr(String_t& out, Enum_t value) const { EnumDesc::ValueToStr(out, (int32_t)value); }
+	bool StrToValue(Enum_t& out, const Char_t* str, bool caseSensitive, bool allowInteger) const { return EnumDesc::StrToValue((int32_t&)out, str, caseSensitive, allowInteger); }
 };
 
 // Class is NOT polymorphic.
@@ -229,21 +264,21 @@ class StringParam : public Param
 {
 public:
 	StringParam() { }
-	StringParam(const wchar_t* initialValue) : m_Value(initialValue) { }
-	StringParam(const std::wstring& initialValue) : m_Value(initialValue) { }
+	StringParam(const Char_t* initialValue) : m_Value(initialValue) { }
+	StringParam(const String_t& initialValue) : m_Value(initialValue) { }
 
 	bool IsConst() const { return true; } // TODO
-	bool TryGetConst(std::wstring& outValue) const { outValue = m_Value; return true; } // TODO
-	void GetConst(std::wstring& outValue) const;
-    const std::wstring* AccessConst() const;
+	bool TryGetConst(String_t& outValue) const { outValue = m_Value; return true; } // TODO
+	void GetConst(String_t& outValue) const;
+    const String_t* AccessConst() const;
 
-	void SetConst(const wchar_t* value, size_t valueLen);
-	void SetConst(const wchar_t* value);
-	StringParam& operator=(const std::wstring& value) { SetConst(value.c_str()); return *this; }
-	StringParam& operator=(const wchar_t* value) { SetConst(value); return *this; }
+	void SetConst(const Char_t* value, size_t valueLen);
+	void SetConst(const Char_t* value);
+	StringParam& operator=(const String_t& value) { SetConst(value.c_str()); return *this; }
+	StringParam& operator=(const Char_t* value) { SetConst(value); return *this; }
 
 private:
-	std::wstring m_Value;
+	String_t m_Value;
 };
 
 class GameTimeParam : public Param
@@ -296,6 +331,105 @@ enum class STORAGE
 typedef struct StorageFunction StorageFunction;
 extern StorageFunction storageFunction;
 
+/*
+Getter and setter of a STORAGE::FUNCTION parameter as plain function pointers
+plus context pointer. Alternative to GetFunc and SetFunc stored as
+std::function - it never allocates and the call is a single indirect call.
+
+Use captureless lambdas or functions with matching signature, or
+RS2_MEMBER_ACCESSOR to call member functions of the object directly. param is
+pointer to the object, same as for GetFunc and SetFunc.
+*/
+template<typename Value_t>
+struct FunctionAccessor
+{
+	typedef bool (*GetFunc_t)(Value_t& outValue, const void* param, void* context);
+	typedef bool (*SetFunc_t)(void* param, const Value_t& value, void* context);
+
+	GetFunc_t GetFunc;
+	SetFunc_t SetFunc;
+	void* Context;
+
+	FunctionAccessor() : GetFunc(nullptr), SetFunc(nullptr), Context(nullptr) { }
+	FunctionAccessor(GetFunc_t getFunc, SetFunc_t setFunc, void* context = nullptr) :
+		GetFunc(getFunc), SetFunc(setFunc), Context(context) { }
+
+	bool Get(Value_t& outValue, const void* param) const { return GetFunc(outValue, param, Context); }
+	bool Set(void* param, const Value_t& value) const { return SetFunc(param, value, Context); }
+};
+
+// Trampolines for RS2_MEMBER_ACCESSOR. Member function is a template argument, so its call can be inlined.
+template<typename Getter_t, Getter_t Getter> struct MemberGetter;
+template<typename Obj_t, typename Result_t, Result_t (Obj_t::*Getter)() const>
+struct MemberGetter<Result_t (Obj_t::*)() const, Getter>
+{
+	typedef typename std::decay<Result_t>::type Value_t;
+	static bool Get(Value_t& outValue, const void* param, void* context)
+	{
+		outValue = (((const Obj_t*)param)->*Getter)();
+		return true;
+	}
+};
+
+template<typename Setter_t, Setter_t Setter> struct MemberSetter;
+template<typename Obj_t, typename Arg_t, void (Obj_t::*Setter)(Arg_t)>
+struct MemberSetter<void (Obj_t::*)(Arg_t), Setter>
+{
+	template<typename Value_t>
+	static bool Set(void* param, const Value_t& value, void* context)
+	{
+		(((Obj_t*)param)->*Setter)(value);
+		return true;
+	}
+};
+// Setter returning bool can report failure.
+template<typename Obj_t, typename Arg_t, bool (Obj_t::*Setter)(Arg_t)>
+struct MemberSetter<bool (Obj_t::*)(Arg_t), Setter>
+{
+	template<typename Value_t>
+	static bool Set(void* param, const Value_t& value, void* context)
+	{
+		return (((Obj_t*)param)->*Setter)(value);
+	}
+};
+
+template<typename Getter_t, Getter_t Getter, typename Setter_t, Setter_t Setter>
+FunctionAccessor<typename MemberGetter<Getter_t, Getter>::Value_t> MakeMemberAccessor()
+{
+	typedef typename MemberGetter<Getter_t, Getter>::Value_t Value_t;
+	return FunctionAccessor<Value_t>(
+		&MemberGetter<Getter_t, Getter>::Get,
+		&MemberSetter<Setter_t, Setter>::template Set<Value_t>);
+}
+
+/*
+List of all parameter descriptor classes, as X(PARAM_TYPE tag, class name).
+Enum PARAM_TYPE and dispatch in VisitParamDesc are generated from it.
+
+ADD NEW PARAMETER TYPES HERE.
+*/
+#define RS2_PARAM_TYPES(X) \
+	X(BOOL, BoolParamDesc) \
+	X(INT, IntParamDesc) \
+	X(UINT, UintParamDesc) \
+	X(ENUM, EnumParamDesc) \
+	X(FLOAT, FloatParamDesc) \
+	X(STRING, StringParamDesc) \
+	X(GAMETIME, GameTimeParamDesc) \
+	X(VEC2, Vec2ParamDesc) \
+	X(VEC3, Vec3ParamDesc) \
+	X(VEC4, Vec4ParamDesc) \
+	X(STRUCT, StructParamDesc) \
+	X(FIXED_SIZE_ARRAY, FixedSizeArrayParamDesc)
+
+enum class PARAM_TYPE : uint8_t
+{
+#define RS2_PARAM_TYPE_ENUM_ITEM(tag, className) tag,
+	RS2_PARAM_TYPES(RS2_PARAM_TYPE_ENUM_ITEM)
+#undef RS2_PARAM_TYPE_ENUM_ITEM
+	COUNT
+};
+
 class ParamDesc
 {
 public:
@@ -311,15 +445,19 @@ public:
 	};
 
 	uint32_t Flags;
-	std::wstring UnitName;
+	InternedString UnitName;
 
-	ParamDesc(STORAGE storage, uint32_t flags) : Flags(flags), m_Storage(storage) { }
+	ParamDesc(PARAM_TYPE type, STORAGE storage, uint32_t flags) : Flags(flags), m_Type(type), m_Storage(storage) { }
 	virtual ~ParamDesc() { }
 
 	ParamDesc& SetFlags(uint32_t flags) { this->Flags = flags; return *this; }
 	ParamDesc& AddFlags(uint32_t flags) { this->Flags |= flags; return *this; }
-	ParamDesc& SetUnitName(const wchar_t* unitName) { UnitName = unitName; return *this; }
+	ParamDesc& SetUnitName(const Char_t* unitName) { UnitName = unitName; return *this; }
+	// Equal unit names have equal pointers.
+	const Char_t* GetInternedUnitName() const { return UnitName.c_str(); }
 
+	// Use it instead of typeid to find out actual class of this object. See also VisitParamDesc.
+	PARAM_TYPE GetType() const { return m_Type; }
 	STORAGE GetStorage() const { return m_Storage; }
 
 	virtual size_t GetParamSize() const = 0;
@@ -330,9 +468,13 @@ public:
 	virtual void SetToDefault(void* param) const = 0;
 	virtual void Copy(void* dstParam, const void* srcParam) const = 0;
 	// If not supported, returns false.
-	virtual bool ToString(std::wstring& out, const void* srcParam) const { out.clear(); return false; }
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return false; }
+	// Appends to out instead of replacing it, so many values can be printed to one buffer. Default implementation calls ToString.
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
 	// If not supported or parse error, returns false and leaves value undefined.
-	virtual bool Parse(void* dstParam, const wchar_t* src) const { return false; }
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return false; }
+	// Parses srcLen characters, which don't need to be null-terminated. Default implementation copies them and calls Parse.
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 
 protected:
 	// If !CanWrite(), throws appropriate exception.
@@ -341,6 +483,7 @@ protected:
 	void CheckCanRead() const;
 
 private:
+	PARAM_TYPE m_Type;
 	STORAGE m_Storage;
 };
 
@@ -348,7 +491,7 @@ class StructParamDesc : public ParamDesc
 {
 public:
 	StructParamDesc(const StructDesc* structDesc) :
-		ParamDesc(STORAGE::RAW, 0),
+		ParamDesc(PARAM_TYPE::STRUCT, STORAGE::RAW, 0),
 		m_StructDesc(structDesc)
 	{
 		assert(structDesc != nullptr);
@@ -371,7 +514,7 @@ class FixedSizeArrayParamDesc : public ParamDesc
 public:
 	// Takes ownership of elementParamDesc.
 	FixedSizeArrayParamDesc(const ParamDesc* elementParamDesc, size_t count) :
-		ParamDesc(STORAGE::RAW, 0),
+		ParamDesc(PARAM_TYPE::FIXED_SIZE_ARRAY, STORAGE::RAW, 0),
 		m_ElementParamDesc(elementParamDesc), m_Count(count)
 	{
 		assert(elementParamDesc != nullptr);
@@ -403,8 +546,8 @@ class TypedParamDesc : public ParamDesc
 public:
 	Value_t DefaultValue;
 
-	TypedParamDesc(STORAGE storage, const Value_t& defaultValue, uint32_t flags) :
-		ParamDesc(storage, flags),
+	TypedParamDesc(PARAM_TYPE type, STORAGE storage, const Value_t& defaultValue, uint32_t flags) :
+		ParamDesc(type, storage, flags),
 		DefaultValue(defaultValue)
 	{
 	}
@@ -419,20 +562,28 @@ public:
 	typedef bool Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, Value_t)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	BoolParamDesc(STORAGE storage, Value_t defaultValue = Value_t(), uint32_t flags = 0) :
-		TypedParamDesc<bool>(storage, defaultValue, flags)
+		TypedParamDesc<bool>(PARAM_TYPE::BOOL, storage, defaultValue, flags)
 	{
 	}
 	BoolParamDesc(StorageFunction& storageFunction, GetFunc_t getFunc, SetFunc_t setFunc, Value_t defaultValue = Value_t(), uint32_t flags = 0) :
-		TypedParamDesc<bool>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<bool>(PARAM_TYPE::BOOL, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc)
 	{
 	}
+	BoolParamDesc(StorageFunction& storageFunction, const Accessor_t& accessor, Value_t defaultValue = Value_t(), uint32_t flags = 0) :
+		TypedParamDesc<bool>(PARAM_TYPE::BOOL, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor)
+	{
+	}
 
 	BoolParamDesc& SetDefault(Value_t defaultValue) { DefaultValue = defaultValue; return *this; }
 
@@ -443,8 +594,8 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	Value_t GetConst(const void* param) const;
@@ -453,8 +604,10 @@ public:
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
 class IntParamDesc : public TypedParamDesc<int32_t>
@@ -464,9 +617,12 @@ public:
 	typedef int32_t Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, Value_t)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	Value_t MinValue, MaxValue;
 
@@ -474,7 +630,7 @@ public:
 		STORAGE storage,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<int32_t>(storage, defaultValue, flags),
+		TypedParamDesc<int32_t>(PARAM_TYPE::INT, storage, defaultValue, flags),
 		MinValue(INT_MIN),
 		MaxValue(INT_MAX)
 	{
@@ -485,13 +641,24 @@ public:
 		SetFunc_t setFunc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<int32_t>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<int32_t>(PARAM_TYPE::INT, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc),
 		MinValue(INT_MIN),
 		MaxValue(INT_MAX)
 	{
 	}
+	IntParamDesc(
+		StorageFunction& storageFunction,
+		const Accessor_t& accessor,
+		Value_t defaultValue = Value_t(),
+		uint32_t flags = 0) :
+		TypedParamDesc<int32_t>(PARAM_TYPE::INT, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor),
+		MinValue(INT_MIN),
+		MaxValue(INT_MAX)
+	{
+	}
 
 	IntParamDesc& SetDefault(Value_t defaultValue) { DefaultValue = defaultValue; return *this; }
 	IntParamDesc& SetMin(Value_t minValue) { MinValue = minValue; return *this; }
@@ -507,18 +674,28 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	Value_t GetConst(const void* param) const;
 	bool TrySetConst(void* param, Value_t value) const;
 	void SetConst(void* param, Value_t value) const;
+	/*
+	Reads or writes this parameter in count objects, firstParam pointing to the
+	parameter in the first one and each next one stride bytes further. Throws
+	on failure. With FLAG_MINMAX_FAIL_ON_SET, all values are checked before any
+	is written. For STORAGE::RAW, min-max clamping is vectorized.
+	*/
+	void GetBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count) const;
+	void SetBatch(void* firstParam, size_t stride, const Value_t* values, size_t count) const;
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
 class UintParamDesc : public TypedParamDesc<uint32_t>
@@ -528,9 +705,12 @@ public:
 	typedef uint32_t Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, Value_t)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	// It only affects the way of displaying value.
 	enum UINT_FLAGS
@@ -544,7 +724,7 @@ public:
 		STORAGE storage,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<uint32_t>(storage, defaultValue, flags),
+		TypedParamDesc<uint32_t>(PARAM_TYPE::UINT, storage, defaultValue, flags),
 		MinValue(0),
 		MaxValue(UINT_MAX)
 	{
@@ -555,13 +735,24 @@ public:
 		SetFunc_t setFunc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<uint32_t>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<uint32_t>(PARAM_TYPE::UINT, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc),
 		MinValue(0),
 		MaxValue(UINT_MAX)
 	{
 	}
+	UintParamDesc(
+		StorageFunction& storageFunction,
+		const Accessor_t& accessor,
+		Value_t defaultValue = Value_t(),
+		uint32_t flags = 0) :
+		TypedParamDesc<uint32_t>(PARAM_TYPE::UINT, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor),
+		MinValue(0),
+		MaxValue(UINT_MAX)
+	{
+	}
 
 	UintParamDesc& SetDefault(Value_t defaultValue) { DefaultValue = defaultValue; return *this; }
 	UintParamDesc& SetMin(Value_t minValue) { MinValue = minValue; return *this; }
@@ -577,18 +768,23 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	Value_t GetConst(const void* param) const;
 	bool TrySetConst(void* param, Value_t value) const;
 	void SetConst(void* param, Value_t value) const;
+	// See IntParamDesc::GetBatch.
+	void GetBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count) const;
+	void SetBatch(void* firstParam, size_t stride, const Value_t* values, size_t count) const;
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
 class EnumParamDesc : public TypedParamDesc<int32_t>
@@ -598,10 +794,13 @@ public:
 	typedef int32_t Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, Value_t)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	const EnumDesc* m_EnumDesc;
 	GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	/*
 	FLAG_MINMAX_FAIL_ON_SET works with this type.
@@ -614,7 +813,7 @@ public:
 		const EnumDesc* enumDesc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<int32_t>(storage, defaultValue, flags),
+		TypedParamDesc<int32_t>(PARAM_TYPE::ENUM, storage, defaultValue, flags),
 		m_EnumDesc(enumDesc)
 	{
 		assert(enumDesc);
@@ -626,13 +825,25 @@ public:
 		SetFunc_t setFunc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<int32_t>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<int32_t>(PARAM_TYPE::ENUM, STORAGE::FUNCTION, defaultValue, flags),
 		m_EnumDesc(enumDesc),
 		GetFunc(getFunc),
 		SetFunc(setFunc)
 	{
 		assert(enumDesc);
 	}
+	EnumParamDesc(
+		StorageFunction& storageFunction,
+		const EnumDesc* enumDesc,
+		const Accessor_t& accessor,
+		Value_t defaultValue = Value_t(),
+		uint32_t flags = 0) :
+		TypedParamDesc<int32_t>(PARAM_TYPE::ENUM, STORAGE::FUNCTION, defaultValue, flags),
+		m_EnumDesc(enumDesc),
+		Accessor(accessor)
+	{
+		assert(enumDesc);
+	}
 
 	EnumParamDesc& SetDefault(Value_t defaultValue) { DefaultValue = defaultValue; return *this; }
 
@@ -643,8 +854,8 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	Value_t GetConst(const void* param) const;
@@ -653,8 +864,10 @@ public:
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
 class FloatParamDesc : public TypedParamDesc<float>
@@ -664,9 +877,12 @@ public:
 	typedef float Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, Value_t)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	// It only affects the way of displaying value.
 	enum FLOAT_FLAGS
@@ -685,7 +901,7 @@ public:
 		STORAGE storage,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<float>(storage, defaultValue, flags),
+		TypedParamDesc<float>(PARAM_TYPE::FLOAT, storage, defaultValue, flags),
 		MinValue(-FLT_MAX),
 		MaxValue(FLT_MAX),
 		Step(1.f),
@@ -698,7 +914,7 @@ public:
 		SetFunc_t setFunc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<float>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<float>(PARAM_TYPE::FLOAT, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc),
 		MinValue(-FLT_MAX),
@@ -707,6 +923,19 @@ public:
 		Precision(UINT_MAX)
 	{
 	}
+	FloatParamDesc(
+		StorageFunction& storageFunction,
+		const Accessor_t& accessor,
+		Value_t defaultValue = Value_t(),
+		uint32_t flags = 0) :
+		TypedParamDesc<float>(PARAM_TYPE::FLOAT, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor),
+		MinValue(-FLT_MAX),
+		MaxValue(FLT_MAX),
+		Step(1.f),
+		Precision(UINT_MAX)
+	{
+	}
 
 	virtual size_t GetParamSize() const;
 
@@ -725,30 +954,36 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	Value_t GetConst(const void* param) const;
 	bool TrySetConst(void* param, Value_t value) const;
 	void SetConst(void* param, Value_t value) const;
+	// See IntParamDesc::GetBatch.
+	void GetBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count) const;
+	void SetBatch(void* firstParam, size_t stride, const Value_t* values, size_t count) const;
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 
 private:
-	void ValueToStr(std::wstring& out, float value) const;
+	void AppendValueToStr(String_t& out, float value) const;
 };
 
-class StringParamDesc : public TypedParamDesc<std::wstring>
+class StringParamDesc : public TypedParamDesc<String_t>
 {
 public:
 	typedef StringParam Param_t;
-	typedef std::wstring Value_t;
+	typedef String_t Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, const Value_t&)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	enum STRING_FLAGS
 	{
@@ -758,20 +993,27 @@ public:
 
     GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	StringParamDesc(STORAGE storage, const Value_t& defaultValue = Value_t(), uint32_t flags = 0) :
-		TypedParamDesc<std::wstring>(storage, defaultValue, flags)
+		TypedParamDesc<String_t>(PARAM_TYPE::STRING, storage, defaultValue, flags)
 	{
 	}
 	StringParamDesc(StorageFunction& storageFunction, GetFunc_t getFunc, SetFunc_t setFunc, const Value_t& defaultValue = Value_t(), uint32_t flags = 0) :
-		TypedParamDesc<std::wstring>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<String_t>(PARAM_TYPE::STRING, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc)
 	{
 	}
+	StringParamDesc(StorageFunction& storageFunction, const Accessor_t& accessor, const Value_t& defaultValue = Value_t(), uint32_t flags = 0) :
+		TypedParamDesc<String_t>(PARAM_TYPE::STRING, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor)
+	{
+	}
 
 	StringParamDesc& SetDefault(const Value_t& defaultValue) { DefaultValue = defaultValue; return *this; }
-	StringParamDesc& SetDefault(const wchar_t* defaultValue) { DefaultValue = defaultValue; return *this; }
+	StringParamDesc& SetDefault(const Char_t* defaultValue) { DefaultValue = defaultValue; return *this; }
 
 	virtual size_t GetParamSize() const;
 
@@ -780,23 +1022,25 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	void GetConst(Value_t& outValue, const void* param) const;
     const Value_t* AccessConst(const void* param) const;
-	bool TrySetConst(void* param, const wchar_t* value, size_t valueLen) const;
-	void SetConst(void* param, const wchar_t* value, size_t valueLen) const;
-	bool TrySetConst(void* param, const wchar_t* value) const;
-	void SetConst(void* param, const wchar_t* value) const;
-	bool TrySetConst(void* param, const std::wstring& value) const { return TrySetConst(param, value.data(), value.length()); }
-	void SetConst(void* param, const std::wstring& value) const { SetConst(param, value.data(), value.length()); }
+	bool TrySetConst(void* param, const Char_t* value, size_t valueLen) const;
+	void SetConst(void* param, const Char_t* value, size_t valueLen) const;
+	bool TrySetConst(void* param, const Char_t* value) const;
+	void SetConst(void* param, const Char_t* value) const;
+	bool TrySetConst(void* param, const String_t& value) const { return TrySetConst(param, value.data(), value.length()); }
+	void SetConst(void* param, const String_t& value) const { SetConst(param, value.data(), value.length()); }
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue.c_str()); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
 class GameTimeParamDesc : public TypedParamDesc<common::GameTime>
@@ -806,9 +1050,12 @@ public:
 	typedef common::GameTime Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, Value_t)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
 	GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	Value_t MinValue, MaxValue;
 
@@ -816,7 +1063,7 @@ public:
 		STORAGE storage,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<common::GameTime>(storage, defaultValue, flags),
+		TypedParamDesc<common::GameTime>(PARAM_TYPE::GAMETIME, storage, defaultValue, flags),
 		MinValue(common::GameTime::MIN_VALUE),
 		MaxValue(common::GameTime::MAX_VALUE)
 	{
@@ -827,13 +1074,24 @@ public:
 		SetFunc_t setFunc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<common::GameTime>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<common::GameTime>(PARAM_TYPE::GAMETIME, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc),
 		MinValue(common::GameTime::MIN_VALUE),
 		MaxValue(common::GameTime::MAX_VALUE)
 	{
 	}
+	GameTimeParamDesc(
+		StorageFunction& storageFunction,
+		const Accessor_t& accessor,
+		Value_t defaultValue = Value_t(),
+		uint32_t flags = 0) :
+		TypedParamDesc<common::GameTime>(PARAM_TYPE::GAMETIME, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor),
+		MinValue(common::GameTime::MIN_VALUE),
+		MaxValue(common::GameTime::MAX_VALUE)
+	{
+	}
 
 	GameTimeParamDesc& SetDefault(Value_t defaultValue) { DefaultValue = defaultValue; return *this; }
 	GameTimeParamDesc& SetMin(Value_t minValue) { MinValue = minValue; return *this; }
@@ -849,8 +1107,8 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	Value_t GetConst(const void* param) const;
@@ -859,10 +1117,17 @@ public:
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
+template<typename Vec_t> struct VecParamType;
+template<> struct VecParamType<common::VEC2> { static const PARAM_TYPE Value = PARAM_TYPE::VEC2; };
+template<> struct VecParamType<common::VEC3> { static const PARAM_TYPE Value = PARAM_TYPE::VEC3; };
+template<> struct VecParamType<common::VEC4> { static const PARAM_TYPE Value = PARAM_TYPE::VEC4; };
+
 template<typename Vec_t>
 class VecParamDesc : public TypedParamDesc<Vec_t>
 {
@@ -871,6 +1136,7 @@ public:
 	typedef Vec_t Value_t;
 	typedef std::function<bool(Value_t&, const void*)> GetFunc_t;
 	typedef std::function<bool(void*, const Value_t&)> SetFunc_t;
+	typedef FunctionAccessor<Value_t> Accessor_t;
 
     enum VEC_FLAGS
 	{
@@ -880,6 +1146,8 @@ public:
 
     GetFunc_t GetFunc;
 	SetFunc_t SetFunc;
+	// Used instead of GetFunc and SetFunc if not empty.
+	Accessor_t Accessor;
 
 	float MinValue, MaxValue, Step;
 
@@ -887,7 +1155,7 @@ public:
 		STORAGE storage,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<Vec_t>(storage, defaultValue, flags),
+		TypedParamDesc<Vec_t>(VecParamType<Vec_t>::Value, storage, defaultValue, flags),
 		MinValue(-FLT_MAX),
 		MaxValue(FLT_MAX),
         Step(1.f)
@@ -899,7 +1167,7 @@ public:
 		SetFunc_t setFunc,
 		Value_t defaultValue = Value_t(),
 		uint32_t flags = 0) :
-		TypedParamDesc<Vec_t>(STORAGE::FUNCTION, defaultValue, flags),
+		TypedParamDesc<Vec_t>(VecParamType<Vec_t>::Value, STORAGE::FUNCTION, defaultValue, flags),
 		GetFunc(getFunc),
 		SetFunc(setFunc),
 		MinValue(-FLT_MAX),
@@ -907,6 +1175,18 @@ public:
         Step(1.f)
 	{
 	}
+	VecParamDesc(
+		StorageFunction& storageFunction,
+		const Accessor_t& accessor,
+		Value_t defaultValue = Value_t(),
+		uint32_t flags = 0) :
+		TypedParamDesc<Vec_t>(VecParamType<Vec_t>::Value, STORAGE::FUNCTION, defaultValue, flags),
+		Accessor(accessor),
+		MinValue(-FLT_MAX),
+		MaxValue(FLT_MAX),
+        Step(1.f)
+	{
+	}
 
 	VecParamDesc<Vec_t>& SetDefault(const Value_t& defaultValue) { DefaultValue = defaultValue; return *this; }
 	VecParamDesc<Vec_t>& SetMin(float minValue) { this->MinValue = minValue; return *this; }
@@ -923,8 +1203,8 @@ public:
 	Param_t* AccessAsParam(void* param) const { assert(GetStorage() == STORAGE::PARAM); Param_t* result = (Param_t*)param; result->CheckMagicNumber(); return result; }
 	const Param_t* AccessAsParam(const void* param) const { assert(GetStorage() == STORAGE::PARAM); const Param_t* result = (const Param_t*)param; result->CheckMagicNumber(); return result; }
 
-	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
-	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
+	virtual bool CanWrite() const { if(GetStorage() == STORAGE::FUNCTION && !SetFunc && !Accessor.SetFunc) return false; return !(Flags & FLAG_READ_ONLY); }
+	virtual bool CanRead() const { if(GetStorage() == STORAGE::FUNCTION && !GetFunc && !Accessor.GetFunc) return false; return !(Flags & FLAG_WRITE_ONLY); }
 	virtual bool IsConst(const void* param) const;
 	bool TryGetConst(Value_t& outValue, const void* param) const;
 	void GetConst(Value_t& outValue, const void* param) const;
@@ -933,35 +1213,183 @@ public:
 
 	virtual void SetToDefault(void* param) const { SetConst(param, DefaultValue); }
 	virtual void Copy(void* dstParam, const void* srcParam) const;
-	virtual bool ToString(std::wstring& out, const void* srcParam) const;
-	virtual bool Parse(void* dstParam, const wchar_t* src) const;
+	virtual bool ToString(String_t& out, const void* srcParam) const { out.clear(); return AppendToString(out, srcParam); }
+	virtual bool AppendToString(String_t& out, const void* srcParam) const;
+	virtual bool Parse(void* dstParam, const Char_t* src) const { return Parse(dstParam, src, StrLen(src)); }
+	virtual bool Parse(void* dstParam, const Char_t* src, size_t srcLen) const;
 };
 
 typedef VecParamDesc<common::VEC2> Vec2ParamDesc;
 typedef VecParamDesc<common::VEC3> Vec3ParamDesc;
 typedef VecParamDesc<common::VEC4> Vec4ParamDesc;
 
+/*
+Calls visitor with paramDesc cast to its actual class, selected by
+paramDesc.GetType() in a single switch. Visitor is typically a generic lambda
+or a class with operator() overloaded for parameter types it supports, e.g.:
+
+	VisitParamDesc(paramDesc, [&](const auto& typedParamDesc) { return Save(typedParamDesc); });
+
+All overloads must return the same type, which is also returned from this
+function.
+*/
+template<typename Visitor_t>
+auto VisitParamDesc(const ParamDesc& paramDesc, Visitor_t&& visitor) -> decltype(visitor(std::declval<const BoolParamDesc&>()))
+{
+	switch(paramDesc.GetType())
+	{
+#define RS2_VISIT_PARAM_DESC_CASE(tag, className) \
+	case PARAM_TYPE::tag: return visitor(static_cast<const className&>(paramDesc));
+	RS2_PARAM_TYPES(RS2_VISIT_PARAM_DESC_CASE)
+#undef RS2_VISIT_PARAM_DESC_CASE
+	default:
+		throw common::Error(RS2_TEXT("Unsupported parameter type."), __TFILE__, __LINE__);
+	}
+}
+
+/*
+Single entry of a layout plan - see class LayoutPlan.
+
+Struct and array parameters are represented by a pair of *_BEGIN and *_END
+entries, with entries of their contents in between. All other parameters are
+represented by single PARAM entry.
+*/
+struct LayoutEntry
+{
+	enum class KIND
+	{
+		PARAM,
+		STRUCT_BEGIN,
+		STRUCT_END,
+		ARRAY_BEGIN,
+		ARRAY_END,
+	};
+
+	enum FLAGS
+	{
+		// Entry is an element of fixed size array. Name is null, ElementIndex is valid.
+		FLAG_ARRAY_ELEMENT = 0x01,
+		// Snapshots of ParamDesc::CanRead(), CanWrite().
+		FLAG_CAN_READ      = 0x02,
+		FLAG_CAN_WRITE     = 0x04,
+		// Plain data with RAW storage and no flags that need checking, like read-only or min-max.
+		// It can be copied and reset to default with memcpy.
+		FLAG_POD           = 0x08,
+	};
+
+	KIND Kind;
+	STORAGE Storage;
+	// Copy of ParamDesc::Flags.
+	uint32_t ParamFlags;
+	// Combination of LayoutEntry::FLAGS.
+	uint32_t LayoutFlags;
+	// Number of enclosing nested structures. Parameters of top-level structure and its base structures have 0.
+	uint32_t Depth;
+	// Offset from the beginning of top-level object.
+	size_t Offset;
+	// Index of this element in the array, if FLAG_ARRAY_ELEMENT.
+	size_t ElementIndex;
+	// For STRUCT_BEGIN, ARRAY_BEGIN: index of matching *_END entry. Otherwise: index of this entry.
+	// Use EndIndex + 1 to skip whole subtree.
+	size_t EndIndex;
+	// For STRUCT_END, ARRAY_END: same as in matching *_BEGIN.
+	const ParamDesc* Desc;
+	// Null if FLAG_ARRAY_ELEMENT.
+	const Char_t* Name;
+
+	bool IsArrayElement() const { return (LayoutFlags & FLAG_ARRAY_ELEMENT) != 0; }
+	bool CanRead() const { return (LayoutFlags & FLAG_CAN_READ) != 0; }
+	bool CanWrite() const { return (LayoutFlags & FLAG_CAN_WRITE) != 0; }
+	bool IsPod() const { return (LayoutFlags & FLAG_POD) != 0; }
+};
+
+/*
+Flattened tree of all parameters of a structure: parameters of its base
+structures first, then its own parameters, with nested structures and all
+elements of fixed size arrays expanded in place. Offsets are absolute, so whole
+object can be processed in a single loop without recursion.
+
+It is built on first use by StructDesc::GetLayoutPlan() and contains copies of
+parameter flags, so descriptors should not be modified after that. If they are,
+call StructDesc::InvalidateLayoutPlan().
+*/
+class LayoutPlan
+{
+public:
+	/*
+	Single step of StructDesc::CopyObj or SetObjToDefault. If Size > 0, it is a
+	range of adjacent POD parameters processed with single memcpy. Otherwise it
+	is Entries[EntryIndex], processed by calling its ParamDesc.
+	*/
+	struct Op
+	{
+		size_t Offset;
+		size_t Size;
+		size_t EntryIndex;
+	};
+
+	std::vector<LayoutEntry> Entries;
+	std::vector<Op> CopyOps;
+	std::vector<Op> ResetOps;
+	// Image of the whole structure with default values of all POD parameters. Source for memcpy in ResetOps.
+	std::vector<char> DefaultImage;
+	// True if all parameters form single range of POD data covering the whole structure.
+	bool Pod;
+	// Indices of entries with Depth 0 - parameters of the structure and its base structures, in order.
+	std::vector<size_t> TopLevelEntries;
+	/*
+	For each element of TopLevelEntries: index of the next one with the same name,
+	wrapping around. Parameter with unique name points to itself. Names repeat
+	when parameter of a structure shadows parameter of its base structure.
+	*/
+	std::vector<size_t> SameNameTopLevelEntries;
+};
+
 class StructDesc
 {
 public:
-	std::vector<std::wstring> Names;
+	// Must have same size as Offsets and Params - add parameters with AddParam or EmplaceParam.
+	std::vector<InternedString> Names;
 	std::vector<size_t> Offsets;
 	std::vector<std::shared_ptr<ParamDesc>> Params;
 
-	StructDesc(const wchar_t* name, size_t structSize, const StructDesc* baseStructDesc = nullptr) : m_Name(name), m_StructSize(structSize), m_BaseStructDesc(baseStructDesc) { }
-	const wchar_t* GetName() const { return m_Name.c_str(); }
+	StructDesc(const Char_t* name, size_t structSize, const StructDesc* baseStructDesc = nullptr) : m_Name(GetDescArena().Intern(name)), m_StructSize(structSize), m_BaseStructDesc(baseStructDesc) { }
+	/*
+	Copies share parameter descriptors and their arena with the source. Layout
+	plan and name index are not copied - they are built again on first use.
+	*/
+	StructDesc(const StructDesc& src);
+	StructDesc& operator=(const StructDesc& src);
+	const Char_t* GetName() const { return m_Name; }
 	size_t GetStructSize() const { return m_StructSize; }
 	const StructDesc* GetBaseStructDesc() const { return m_BaseStructDesc; }
+	// Equal names have equal pointers, valid until the end of the program.
+	const Char_t* GetInternedName(size_t paramIndex) const { return Names[paramIndex].c_str(); }
+	// Arena holding descriptors created with EmplaceParam. Null if there are none.
+	const DescArena* GetParamArena() const { return m_ParamArena.get(); }
 
-	// Takes ownership of param.
+	// Takes ownership of param, which must be allocated with new.
 	template<typename ParamDesc_t>
-	ParamDesc_t& AddParam(const wchar_t* name, size_t offset, ParamDesc_t* param)
+	ParamDesc_t& AddParam(const Char_t* name, size_t offset, ParamDesc_t* param)
 	{
-		Names.push_back(name);
-		Offsets.push_back(offset);
-		Params.emplace_back(std::shared_ptr<ParamDesc>(param));
+		AddParamDesc(name, offset, std::shared_ptr<ParamDesc>(param));
 		return *param;
 	}
+	/*
+	Creates the parameter descriptor in arena of this structure, next to previously
+	created ones, passing args to its constructor. Preferred over AddParam - used by
+	RS2_ADD_PARAM_* macros. The arena is freed when this structure and all copies
+	of its Params are destroyed.
+	*/
+	template<typename ParamDesc_t, typename... Args_t>
+	ParamDesc_t& EmplaceParam(const Char_t* name, size_t offset, Args_t&&... args)
+	{
+		std::shared_ptr<ParamDesc_t> param = std::allocate_shared<ParamDesc_t>(
+			DescArenaAllocator<ParamDesc_t>(AccessParamArena()), std::forward<Args_t>(args)...);
+		ParamDesc_t& result = *param;
+		AddParamDesc(name, offset, std::move(param));
+		return result;
+	}
 
 	char* AccessRawParam(void* obj, size_t paramIndex) const { return (char*)obj + Offsets[paramIndex]; }
 	const char* AccessRawParam(const void* obj, size_t paramIndex) const { return (const char*)obj + Offsets[paramIndex]; }
@@ -978,20 +1406,185 @@ public:
 	void CopyObj(void* dstObj, const void* srcObj) const;
 
 	// Returns index. Not found: returns -1.
-	size_t Find(const wchar_t* name, bool caseSensitive = true) const;
+	size_t Find(const Char_t* name, bool caseSensitive = true) const;
+	size_t Find(const Char_t* name, size_t nameLen, bool caseSensitive) const;
+	/*
+	Searches parameters of this structure, then of its base structures, with
+	single hash lookup. Returns structure where the parameter was found and its
+	index in that structure. Not found: returns false.
+	*/
+	bool FindInherited(const StructDesc*& outStructDesc, size_t& outIndex, const Char_t* name, size_t nameLen, bool caseSensitive) const;
+	bool FindInherited(const StructDesc*& outStructDesc, size_t& outIndex, const Char_t* name, bool caseSensitive = true) const
+	{
+		return FindInherited(outStructDesc, outIndex, name, StrLen(name), caseSensitive);
+	}
+	// Like FindInherited, but returns index in GetLayoutPlan().TopLevelEntries. Not found: returns SIZE_MAX.
+	size_t FindTopLevel(const Char_t* name, size_t nameLen, bool caseSensitive) const;
 	ParamDesc* GetParamDesc(size_t index);
 	const ParamDesc* GetParamDesc(size_t index) const;
 
+	// Built once on first call, also when called from many threads at once.
+	const LayoutPlan& GetLayoutPlan() const;
+	// True if the whole structure is plain data that can be copied with memcpy. See LayoutPlan::Pod.
+	bool IsPod() const { return GetLayoutPlan().Pod; }
+	// Call after modifying parameters of this structure or any structure it contains.
+	// Not thread-safe - call only while no other thread uses the descriptor.
+	void InvalidateLayoutPlan();
+	/*
+	Name index used by Find is built on first call, under a lock, so lookups can
+	be done from many threads. It is rebuilt automatically after parameters are
+	added to this structure or any of its base structures. Adding parameters
+	while other threads use the descriptor is not supported. Call this, and
+	InvalidateLayoutPlan, after renaming parameters by assigning to Names.
+	*/
+	void InvalidateNameIndex() { ++m_ParamsVersion; }
+	/*
+	True if names of two parameters of this structure and its base structures,
+	including equal names, have equal HashName, so they cannot be told apart in
+	chunked binary format.
+	*/
+	bool HasNameHashCollision() const;
+
+	/*
+	Bytes of memory owned by this descriptor: vectors, caches, names and parameter
+	descriptors, including the arena of EmplaceParam. Interned strings live in
+	GetDescArena() and are counted by its GetFootprint instead. Nested structure
+	descriptors are not included.
+	*/
+	size_t GetFootprint() const;
+
 private:
-	std::wstring m_Name;
+	struct InheritedParam
+	{
+		const StructDesc* Owner;
+		size_t Index;
+		// Index in LayoutPlan::TopLevelEntries.
+		size_t TopLevelIndex;
+	};
+
+	const Char_t* m_Name;
 	size_t m_StructSize;
 	const StructDesc* m_BaseStructDesc;
+	std::shared_ptr<DescArena> m_ParamArena;
+	mutable std::unique_ptr<LayoutPlan> m_LayoutPlan;
+	// Set when m_LayoutPlan is built, cleared by InvalidateLayoutPlan.
+	mutable std::atomic<bool> m_LayoutPlanReady { false };
+	mutable std::mutex m_LayoutPlanMutex;
+	// Values are indices into m_InheritedParams.
+	mutable NameIndex m_NameIndex;
+	mutable std::vector<InheritedParam> m_InheritedParams;
+	mutable bool m_NameHashCollision = false;
+	// Incremented when parameters of this structure change.
+	size_t m_ParamsVersion = 0;
+	// Sum of m_ParamsVersion of this structure and its bases when the name index was built.
+	mutable std::atomic<size_t> m_NameIndexVersion { SIZE_MAX };
+	mutable std::mutex m_NameIndexMutex;
+
+	void AddParamDesc(const Char_t* name, size_t offset, std::shared_ptr<ParamDesc>&& param);
+	// Creates the arena on first use.
+	const std::shared_ptr<DescArena>& AccessParamArena();
+	size_t GetParamsVersionWithBases() const;
+	void EnsureNameIndex() const;
+	void BuildNameIndex() const;
 };
 
 bool FindObjParamByPath(
 	void*& outParam, const ParamDesc*& outParamDesc,
 	void* obj, const StructDesc& structDesc,
-	const wchar_t* path, bool caseSensitive);
+	const Char_t* path, bool caseSensitive);
+
+/*
+Compares values of parameters with operator== of their type. Structures are
+compared parameter by parameter, including base structures, arrays element by
+element. Parameters that cannot be read are treated as equal.
+*/
+bool ParamEquals(const void* lhsParam, const void* rhsParam, const ParamDesc& paramDesc);
+// True if parameter has its DefaultValue. Structures and arrays: if all their parameters do.
+bool ParamIsDefault(const void* param, const ParamDesc& paramDesc);
+
+/*
+Path to a parameter resolved once by CompilePath, so it can be used to access
+the same parameter in many objects of the same structure. All struct members and
+array elements on the path have fixed offsets, so they are folded into single
+offset from the beginning of the object and Access is just pointer arithmetic.
+
+Immutable. Default-constructed one is invalid. Stays valid as long as the
+StructDesc it was compiled for and its nested descriptors are not modified.
+*/
+class ParamPath
+{
+public:
+	ParamPath() : m_StructDesc(nullptr), m_ParamDesc(nullptr), m_Offset(0) { }
+	ParamPath(const StructDesc* structDesc, const ParamDesc* paramDesc, size_t offset) :
+		m_StructDesc(structDesc), m_ParamDesc(paramDesc), m_Offset(offset) { }
+
+	bool IsValid() const { return m_ParamDesc != nullptr; }
+	// Root structure, which objects passed to Access must be described by.
+	const StructDesc* GetStructDesc() const { return m_StructDesc; }
+	const ParamDesc* GetParamDesc() const { return m_ParamDesc; }
+	size_t GetOffset() const { return m_Offset; }
+
+	void* Access(void* obj) const { assert(IsValid()); return (char*)obj + m_Offset; }
+	const void* Access(const void* obj) const { assert(IsValid()); return (const char*)obj + m_Offset; }
+
+private:
+	const StructDesc* m_StructDesc;
+	const ParamDesc* m_ParamDesc;
+	size_t m_Offset;
+};
+
+// Syntax of path is same as in FindObjParamByPath. If not found, returns invalid path.
+ParamPath CompilePath(const StructDesc& structDesc, const Char_t* path, bool caseSensitive = true);
+
+/*
+Global index of structure and enum descriptors by name, e.g. to create objects
+of types named in level files.
+
+Descriptors created with RS2_GET_STRUCT_DESC_BEGIN/END and RS2_GET_ENUM_DESC_BODY
+are registered automatically on the first call to their function, keyed by
+their C++ type, so types with the same name in different namespaces can coexist.
+Lookup by name then returns the one registered first. To register them eagerly
+at startup, use RS2_REGISTER_STRUCT/RS2_REGISTER_ENUM or just call these
+functions from the main thread before starting worker threads.
+
+Does not own descriptors - they must stay alive as long as they are registered.
+Thread-safe. Lookup by name is a single hash lookup.
+*/
+class TypeRegistry
+{
+public:
+	// If a structure with the same name is already registered, throws common::Error.
+	void RegisterStruct(const StructDesc& structDesc);
+	// If a structure of the same type is already registered, throws common::Error.
+	void RegisterStruct(const StructDesc& structDesc, const std::type_info& type);
+	// If an enum with the same name is already registered, throws common::Error.
+	void RegisterEnum(const EnumDesc& enumDesc);
+	// If an enum of the same type is already registered, throws common::Error.
+	void RegisterEnum(const EnumDesc& enumDesc, const std::type_info& type);
+
+	// Not found: returns null.
+	const StructDesc* FindStruct(const Char_t* name, bool caseSensitive = true) const;
+	const StructDesc* FindStruct(const std::type_info& type) const;
+	// Not found: returns null.
+	const EnumDesc* FindEnum(const Char_t* name, bool caseSensitive = true) const;
+	const EnumDesc* FindEnum(const std::type_info& type) const;
+
+	size_t GetStructCount() const;
+	size_t GetEnumCount() const;
+
+private:
+	mutable std::mutex m_Mutex;
+	// Values are indices into m_Structs, m_Enums. Only first of equal names is added.
+	NameIndex m_StructIndex;
+	NameIndex m_EnumIndex;
+	std::unordered_map<std::type_index, size_t> m_StructTypeIndex;
+	std::unordered_map<std::type_index, size_t> m_EnumTypeIndex;
+	std::vector<const StructDesc*> m_Structs;
+	std::vector<const EnumDesc*> m_Enums;
+};
+
+// Created on first use and never destroyed.
+TypeRegistry& GetTypeRegistry();
 
 inline size_t StructParamDesc::GetParamSize() const
 {
@@ -1020,83 +1613,109 @@ inline size_t FixedSizeArrayParamDesc::GetParamSize() const
 
 } // namespace RegScript2
 
+/*
+Descriptors are created and registered in rs2::GetTypeRegistry() once. Enum
+descriptor is created inside initialization of a function-local static, which
+is thread-safe since C++11. Body of structure descriptor stays inline in the
+function, so it can use anything the function can, and runs under a lock.
+*/
 #define RS2_GET_ENUM_DESC_BODY(enumName, itemCount, itemNames, ...) \
-    static unique_ptr<rs2::TypedEnumDesc<enumName>> enumDesc = \
-        std::make_unique<rs2::TypedEnumDesc<enumName>>( \
-            L#enumName, (size_t)itemCount, itemNames, __VA_ARGS__); \
+    static const std::unique_ptr<rs2::TypedEnumDesc<enumName>> enumDesc = []() { \
+        std::unique_ptr<rs2::TypedEnumDesc<enumName>> enumDesc = \
+            std::make_unique<rs2::TypedEnumDesc<enumName>>( \
+                RS2_TEXT(#enumName), (size_t)itemCount, itemNames, __VA_ARGS__); \
+        rs2::GetTypeRegistry().RegisterEnum(*enumDesc, typeid(enumName)); \
+        return enumDesc; \
+    }(); \
     return enumDesc.get();
 
+// Recursive mutex, so the body can reference its own descriptor, like the original lazy static.
 #define RS2_GET_STRUCT_DESC_BEGIN(structName, ...) \
-	static unique_ptr<rs2::StructDesc> structDesc; \
-	if(!structDesc) \
+	static std::unique_ptr<rs2::StructDesc> structDesc; \
+	static std::atomic<bool> structDescReady(false); \
+	static std::recursive_mutex structDescMutex; \
+	if(!structDescReady.load(std::memory_order_acquire)) \
 	{ \
-		typedef structName Struct_t; \
-		structDesc = std::make_unique<rs2::StructDesc>(L#structName, sizeof(structName), __VA_ARGS__);
+		std::lock_guard<std::recursive_mutex> structDescLock(structDescMutex); \
+		if(!structDesc) \
+		{ \
+			typedef structName Struct_t; \
+			structDesc = std::make_unique<rs2::StructDesc>(RS2_TEXT(#structName), sizeof(structName), __VA_ARGS__);
 
 #define RS2_GET_STRUCT_DESC_END() \
+			rs2::GetTypeRegistry().RegisterStruct(*structDesc, typeid(Struct_t)); \
+			structDescReady.store(true, std::memory_order_release); \
+		} \
 	} \
 	return structDesc.get();
 
+// Use at global scope in a .cpp file to create and register descriptor during static initialization.
+#define RS2_REGISTER_STRUCT(structName) \
+	static const rs2::StructDesc* const g_RS2RegisteredStruct_##structName = structName::GetStructDesc();
+// getEnumDescFunc is a function returning descriptor, defined with RS2_GET_ENUM_DESC_BODY.
+#define RS2_REGISTER_ENUM(getEnumDescFunc) \
+	static const rs2::EnumDesc* const g_RS2RegisteredEnum_##getEnumDescFunc = getEnumDescFunc();
+
 #define RS2_ADD_PARAM_STRUCT(paramName, nestedStructDesc) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::StructParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::StructParamDesc(nestedStructDesc)))
+		nestedStructDesc))
 #define RS2_ADD_PARAM_FIXED_SIZE_ARRAY(paramName, elementStructDesc, count) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::FixedSizeArrayParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::FixedSizeArrayParamDesc(elementStructDesc, count)))
+		elementStructDesc, count))
 #define RS2_ADD_PARAM_BOOL(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::BoolParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::BoolParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_INT(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::IntParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::IntParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_UINT(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::UintParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::UintParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_FLOAT(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::FloatParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::FloatParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_STRING(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::StringParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::StringParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_GAMETIME(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::GameTimeParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::GameTimeParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_VEC2(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::Vec2ParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::Vec2ParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_VEC3(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::Vec3ParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::Vec3ParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_VEC4(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::Vec4ParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::Vec4ParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 #define RS2_ADD_PARAM_ENUM(paramName, storage, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::EnumParamDesc>( \
+		RS2_TEXT(#paramName), \
 		offsetof(Struct_t, paramName), \
-		new rs2::EnumParamDesc(storage, __VA_ARGS__)))
+		storage, __VA_ARGS__))
 
 
 // Initializes float param with Format=Percent|MinMaxClampOnSet, Min=0, Max=1, Step=0.02.
@@ -1110,47 +1729,98 @@ inline size_t FixedSizeArrayParamDesc::GetParamSize() const
 
 
 #define RS2_ADD_PARAM_BOOL_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::BoolParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::BoolParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_INT_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::IntParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::IntParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_UINT_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::UintParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::UintParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_FLOAT_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::FloatParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::FloatParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_STRING_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::StringParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::StringParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_GAMETIME_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::GameTimeParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::GameTimeParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_VEC2_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::Vec2ParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::Vec2ParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_VEC3_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::Vec3ParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::Vec3ParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
 #define RS2_ADD_PARAM_VEC4_FUNCTION(paramName, getFunc, setFunc, ...) \
-	(structDesc->AddParam( \
-		L#paramName, \
+	(structDesc->EmplaceParam<rs2::Vec4ParamDesc>( \
+		RS2_TEXT(#paramName), \
 		0, \
-		new rs2::Vec4ParamDesc(RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__)))
+		RegScript2::storageFunction, getFunc, setFunc, __VA_ARGS__))
+
+// accessor is FunctionAccessor, e.g. created with RS2_MEMBER_ACCESSOR.
+#define RS2_ADD_PARAM_BOOL_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::BoolParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_INT_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::IntParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_UINT_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::UintParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_FLOAT_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::FloatParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_STRING_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::StringParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_GAMETIME_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::GameTimeParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_VEC2_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::Vec2ParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_VEC3_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::Vec3ParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+#define RS2_ADD_PARAM_VEC4_ACCESSOR(paramName, accessor, ...) \
+	(structDesc->EmplaceParam<rs2::Vec4ParamDesc>( \
+		RS2_TEXT(#paramName), \
+		0, \
+		RegScript2::storageFunction, accessor, __VA_ARGS__))
+
+// Pointers to const getter returning value and setter taking value, e.g. &Light::GetRange, &Light::SetRange.
+#define RS2_MEMBER_ACCESSOR(getter, setter) \
+	(rs2::MakeMemberAccessor<decltype(getter), getter, decltype(setter), setter>())
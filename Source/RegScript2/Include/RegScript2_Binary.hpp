@@ -0,0 +1,396 @@
+#pragma once
+
+#include "RegScript2_TokDoc.hpp"
+#include <cstring>
+
+namespace RegScript2
+{
+
+/*
+Compact binary serialization, alternative to TokDoc for fast loading.
+
+Data contains only values of parameters, in order of entries of
+StructDesc::GetLayoutPlan() - no names, no types, no padding. It must be loaded
+with the same StructDesc it was saved with. Adjacent POD parameters are written
+and read with single memcpy.
+
+Encoding of values, in host byte order (little endian on all supported platforms):
+
+- bool: 1 byte, 0 or 1.
+- int, uint, enum, float: 4 bytes. Enum is saved as its value, not name.
+- GameTime: 8 bytes, raw value of common::GameTime.
+- VEC2, VEC3, VEC4: 2, 3, 4 floats.
+- string: uint32_t length in UTF-16 code units, then the code units without terminating zero.
+  Characters outside of BMP are surrogate pairs, also where wchar_t has 4 bytes.
+- struct, fixed size array: values of their parameters or elements, one after another.
+
+Parameters that cannot be read are not saved. Parameters that cannot be
+written are read and discarded, like in LoadObjFromTokDoc. Both apply to whole
+structures and arrays.
+*/
+
+class BinaryWriter
+{
+public:
+	const std::vector<char>& GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Data.size(); }
+	void Clear() { m_Data.clear(); }
+	void Reserve(size_t size) { m_Data.reserve(size); }
+	// Discards data written after first size bytes.
+	void Truncate(size_t size) { assert(size <= m_Data.size()); m_Data.resize(size); }
+
+	void WriteBytes(const void* src, size_t size)
+	{
+		const size_t oldSize = m_Data.size();
+		m_Data.resize(oldSize + size);
+		memcpy(m_Data.data() + oldSize, src, size);
+	}
+	// Value_t must be trivially copyable.
+	template<typename Value_t>
+	void Write(const Value_t& value) { WriteBytes(&value, sizeof(Value_t)); }
+	void WriteZeros(size_t size) { m_Data.resize(m_Data.size() + size); }
+	// Overwrites data already written at given position, e.g. to fill in size reserved earlier.
+	void WriteBytesAt(size_t position, const void* src, size_t size)
+	{
+		assert(position + size <= m_Data.size());
+		memcpy(m_Data.data() + position, src, size);
+	}
+	template<typename Value_t>
+	void WriteAt(size_t position, const Value_t& value) { WriteBytesAt(position, &value, sizeof(Value_t)); }
+	// Length followed by characters.
+	void WriteString(const Char_t* str, size_t len);
+	// Just characters as UTF-16 code units. Returns number of code units written.
+	size_t WriteChars(const Char_t* str, size_t len);
+
+private:
+	std::vector<char> m_Data;
+	std::u16string m_Utf16Buffer;
+};
+
+// Does not copy data - it must exist during lifetime of this object.
+class BinaryReader
+{
+public:
+	BinaryReader(const void* data, size_t size) : m_Data((const char*)data), m_Size(size), m_Position(0) { }
+
+	const char* GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Size; }
+	size_t GetPosition() const { return m_Position; }
+	size_t GetRemainingSize() const { return m_Size - m_Position; }
+	bool IsEnd() const { return m_Position == m_Size; }
+
+	// If there is not enough data, throws common::Error.
+	void ReadBytes(void* dst, size_t size)
+	{
+		CheckRemainingSize(size);
+		memcpy(dst, m_Data + m_Position, size);
+		m_Position += size;
+	}
+	// Value_t must be trivially copyable. If there is not enough data, throws common::Error.
+	template<typename Value_t>
+	void Read(Value_t& out) { ReadBytes(&out, sizeof(Value_t)); }
+	// If there is not enough data, throws common::Error.
+	void ReadString(String_t& out);
+	// If there is not enough data, throws common::Error.
+	void Skip(size_t size)
+	{
+		CheckRemainingSize(size);
+		m_Position += size;
+	}
+
+private:
+	const char* m_Data;
+	size_t m_Size;
+	size_t m_Position;
+
+	void CheckRemainingSize(size_t size) const;
+};
+
+// Size of value of simple parameter type, or 0 for strings, structures and arrays.
+size_t GetBinaryValueSize(PARAM_TYPE type);
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const BoolParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const IntParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const UintParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const EnumParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const FloatParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const StringParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const GameTimeParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const Vec2ParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const Vec3ParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const Vec4ParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const StructParamDesc& paramDesc);
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const FixedSizeArrayParamDesc& paramDesc);
+// ADD NEW PARAMETER TYPES HERE.
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const ParamDesc& paramDesc);
+
+void SaveObjToBinary(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc);
+
+void LoadParamFromBinary(void* dstParam, const BoolParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const IntParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const UintParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const EnumParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const FloatParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const StringParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const GameTimeParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const Vec2ParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const Vec3ParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const Vec4ParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const StructParamDesc& paramDesc, BinaryReader& src);
+void LoadParamFromBinary(void* dstParam, const FixedSizeArrayParamDesc& paramDesc, BinaryReader& src);
+// ADD NEW PARAMETER TYPES HERE.
+
+void LoadParamFromBinary(void* dstParam, const ParamDesc& paramDesc, BinaryReader& src);
+
+// If data is incomplete, throws common::Error and leaves object partially loaded.
+void LoadObjFromBinary(void* dstObj, const StructDesc& structDesc, BinaryReader& src);
+
+/*
+Chunked binary format - slower and bigger than the one above, but data stays
+loadable after parameters are added, removed, reordered or change type, like in
+TokDoc.
+
+Each object, parameter and array element is a chunk: uint32_t name hash (see
+HashName; 0 for array elements), uint8_t PARAM_TYPE, uint32_t size of contents,
+then contents. Contents of parameters of simple types are encoded like in the
+format above. Contents of structures are chunks of their parameters, including
+parameters of base structures. Contents of arrays are chunks of their elements.
+
+Loader looks up parameters by name hash and skips unknown chunks without
+parsing them. Parameters that cannot be read are not saved. Missing and
+incorrect parameters, including ones saved with different type, are handled
+according to STokDocLoadConfig::Flags, same as in LoadObjFromTokDoc, so data
+saved with SaveObjToChunkedBinaryDelta can be loaded with TOKDOC_FLAG_PATCH.
+
+Structures whose parameter names collide in HashName (see
+StructDesc::HasNameHashCollision) cannot use this format - save and load throw
+common::Error.
+
+File can start with a header written by WriteChunkedBinaryHeader, followed by
+any number of objects.
+*/
+
+static const uint32_t CHUNKED_BINARY_VERSION = 2;
+
+// Writes magic number and CHUNKED_BINARY_VERSION.
+void WriteChunkedBinaryHeader(BinaryWriter& dst);
+// If magic number is invalid or version is other than CHUNKED_BINARY_VERSION, throws common::Error. Returns version.
+uint32_t ReadChunkedBinaryHeader(BinaryReader& src);
+
+void SaveObjToChunkedBinary(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc);
+/*
+Saves only chunks of parameters that differ from baseObj, or from their default
+values if baseObj is null, same as SaveObjToTokDocDelta. Load with
+TOKDOC_FLAG_PATCH.
+*/
+void SaveObjToChunkedBinaryDelta(BinaryWriter& dst, const void* srcObj, const void* baseObj, const StructDesc& structDesc);
+// Loads single object saved with SaveObjToChunkedBinary. Returns false if any parameter failed to load, like LoadObjFromTokDoc.
+bool LoadObjFromChunkedBinary(void* dstObj, const StructDesc& structDesc, BinaryReader& src, const STokDocLoadConfig& config);
+
+/*
+Quantized binary format - opt-in alternative to SaveObjToBinary for save files
+and network packets, where size matters more than speed and exact values.
+
+Values are bit-packed in order of entries of StructDesc::GetLayoutPlan(), like
+in SaveObjToBinary. Float parameters and components of vector parameters that
+have finite MinValue, MaxValue and positive Step are stored as index of the
+nearest step above MinValue, in GetQuantizedBitCount bits - e.g. 7 bits for
+range 0..1 with Step 0.01. Such values are clamped to MinValue..MaxValue and
+loaded with error not greater than GetQuantizationMaxError. Other floats are
+stored exactly, in 32 bits.
+
+Other types also take only as many bits as their descriptor allows:
+
+- bool: 1 bit.
+- int, uint with MinValue or MaxValue set: value - MinValue in GetBitCount(MaxValue - MinValue)
+  bits. Values outside the range are clamped.
+- int, uint without range: zigzag (int only) varint - see BitWriter::WriteVarUint.
+- enum: index of the item in GetBitCount(ItemCount) bits. Index ItemCount means value
+  not found among items, followed by the value as zigzag varint.
+- string: length as varint, then 16-bit UTF-16 code units, like in SaveObjToBinary.
+- GameTime: 64 bits.
+
+Parameters that cannot be read are not saved. Parameters that cannot be
+written are read and discarded, like in LoadObjFromTokDoc. Both apply to whole
+structures and arrays.
+
+Each object is padded to whole bytes.
+*/
+
+// Number of bits needed to store values 0..maxValue. 0 for maxValue = 0.
+uint32_t GetBitCount(uint32_t maxValue);
+
+// Writes bits to BinaryWriter, lowest bits first.
+class BitWriter
+{
+public:
+	BitWriter(BinaryWriter& dst) : m_Dst(dst), m_Bits(0), m_BitCount(0) { }
+
+	// Writes bitCount lowest bits of value. bitCount <= 32.
+	void WriteBits(uint32_t value, uint32_t bitCount);
+	// 7 bits of value at a time, lowest first, each followed by 1 bit telling whether more follow.
+	void WriteVarUint(uint32_t value);
+	// Zigzag encoding, so values close to 0 take few bits, then WriteVarUint.
+	void WriteVarInt(int32_t value) { WriteVarUint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31)); }
+	// Writes bits remaining after last whole byte, padded with zeros. Must be called after last WriteBits.
+	void Flush();
+
+private:
+	BinaryWriter& m_Dst;
+	uint64_t m_Bits;
+	uint32_t m_BitCount;
+};
+
+// Reads bits written by BitWriter.
+class BitReader
+{
+public:
+	BitReader(BinaryReader& src) : m_Src(src), m_Bits(0), m_BitCount(0) { }
+
+	// bitCount <= 32. If there is not enough data, throws common::Error.
+	uint32_t ReadBits(uint32_t bitCount);
+	// If there is not enough data or value is too long, throws common::Error.
+	uint32_t ReadVarUint();
+	int32_t ReadVarInt() { const uint32_t value = ReadVarUint(); return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+	// Skips padding bits up to the end of current byte.
+	void AlignToByte() { m_Bits = 0; m_BitCount = 0; }
+
+private:
+	BinaryReader& m_Src;
+	uint64_t m_Bits;
+	uint32_t m_BitCount;
+};
+
+// Returns 0 if value with such range is not quantized, but stored as 32-bit float.
+uint32_t GetQuantizedBitCount(float minValue, float maxValue, float step);
+// Half of step for quantized values, 0 for values stored exactly. Rounding of the float result can add one ulp.
+float GetQuantizationMaxError(float minValue, float maxValue, float step);
+
+inline uint32_t GetQuantizedBitCount(const FloatParamDesc& paramDesc) { return GetQuantizedBitCount(paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step); }
+inline float GetQuantizationMaxError(const FloatParamDesc& paramDesc) { return GetQuantizationMaxError(paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step); }
+// For single component of the vector.
+template<typename Vec_t>
+uint32_t GetQuantizedBitCount(const VecParamDesc<Vec_t>& paramDesc) { return GetQuantizedBitCount(paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step); }
+template<typename Vec_t>
+float GetQuantizationMaxError(const VecParamDesc<Vec_t>& paramDesc) { return GetQuantizationMaxError(paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step); }
+
+void SaveObjToQuantizedBinary(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc);
+// If data is incomplete, throws common::Error and leaves object partially loaded.
+void LoadObjFromQuantizedBinary(void* dstObj, const StructDesc& structDesc, BinaryReader& src);
+
+/*
+Image of an object that can be read in place, without loading it into the
+object, e.g. from a memory-mapped file. Startup time of a big read-only database
+in this format doesn't depend on its size.
+
+Image starts with values of all parameters in order of entries of
+StructDesc::GetLayoutPlan(), packed without padding, at offsets given by
+ViewLayout. Values are encoded like in SaveObjToBinary, except strings, which
+are uint32_t offset of characters from the beginning of the image and uint32_t
+length. Their UTF-16 characters follow the values, so the image can be placed
+anywhere. Parameters that cannot be read are left zero, including contents of
+structures and arrays that cannot be read.
+*/
+
+/*
+Offsets of parameters in the image, computed once from the layout plan of the
+structure. Create one per structure and share it between all images and views
+of that structure. Like ParamPath, stays valid as long as the StructDesc is not
+modified.
+*/
+class ViewLayout
+{
+public:
+	explicit ViewLayout(const StructDesc& structDesc);
+
+	const StructDesc& GetStructDesc() const { return *m_StructDesc; }
+	// Size of the image without characters of strings.
+	size_t GetSize() const { return m_Size; }
+	/*
+	Offset in the image of parameter at given offset in the object. Not found: returns SIZE_MAX.
+	outCanRead, if not null, receives false if the parameter or any enclosing structure or array cannot be read.
+	*/
+	size_t FindViewOffset(size_t objOffset, const ParamDesc* paramDesc, bool* outCanRead = nullptr) const;
+
+private:
+	struct Entry
+	{
+		size_t ObjOffset;
+		size_t ViewOffset;
+		const ParamDesc* Desc;
+		// False if this entry or any enclosing structure or array cannot be read.
+		bool CanRead;
+	};
+
+	const StructDesc* m_StructDesc;
+	size_t m_Size;
+	// Parameters, structures and arrays, sorted by ObjOffset.
+	std::vector<Entry> m_Entries;
+};
+
+void SaveObjToView(BinaryWriter& dst, const void* srcObj, const ViewLayout& layout);
+
+// Single parameter inside ConstObjView.
+class ConstParamView
+{
+public:
+	ConstParamView() : m_ObjData(nullptr), m_ObjSize(0), m_ViewOffset(0), m_ParamDesc(nullptr), m_CanRead(false) { }
+	// canRead: false if any structure or array enclosing the parameter cannot be read.
+	ConstParamView(const char* objData, size_t objSize, size_t viewOffset, const ParamDesc* paramDesc, bool canRead = true) :
+		m_ObjData(objData), m_ObjSize(objSize), m_ViewOffset(viewOffset), m_ParamDesc(paramDesc), m_CanRead(canRead) { }
+
+	bool IsValid() const { return m_ParamDesc != nullptr; }
+	const ParamDesc* GetParamDesc() const { return m_ParamDesc; }
+
+	// If parameter has different type or cannot be read, also because of enclosing structure or array, returns false. Int32_t can also be read from enum parameter.
+	bool TryGetConst(bool& outValue) const;
+	bool TryGetConst(int32_t& outValue) const;
+	bool TryGetConst(uint32_t& outValue) const;
+	bool TryGetConst(float& outValue) const;
+	bool TryGetConst(common::GameTime& outValue) const;
+	bool TryGetConst(common::VEC2& outValue) const;
+	bool TryGetConst(common::VEC3& outValue) const;
+	bool TryGetConst(common::VEC4& outValue) const;
+	// If parameter has different type or its characters are outside of the image, returns false.
+	bool TryGetConst(String_t& outValue) const;
+
+private:
+	const char* m_ObjData;
+	size_t m_ObjSize;
+	size_t m_ViewOffset;
+	const ParamDesc* m_ParamDesc;
+	bool m_CanRead;
+
+	template<typename Value_t>
+	bool TryGetValue(Value_t& outValue, PARAM_TYPE type) const;
+};
+
+/*
+Read-only object saved with SaveObjToView, accessed in place. Does not copy data
+or layout - they must exist during lifetime of this object and views of its
+parameters.
+*/
+class ConstObjView
+{
+public:
+	ConstObjView() : m_Data(nullptr), m_Size(0), m_Layout(nullptr) { }
+	// If size is too small for the image of the structure, throws common::Error.
+	ConstObjView(const void* data, size_t size, const ViewLayout& layout);
+
+	bool IsValid() const { return m_Layout != nullptr; }
+	const void* GetData() const { return m_Data; }
+	size_t GetSize() const { return m_Size; }
+	const ViewLayout* GetLayout() const { return m_Layout; }
+	const StructDesc* GetStructDesc() const { return m_Layout ? &m_Layout->GetStructDesc() : nullptr; }
+
+	// Syntax of path is same as in FindObjParamByPath. If not found, returns invalid view.
+	ConstParamView FindParamByPath(const Char_t* path, bool caseSensitive = true) const;
+
+private:
+	const char* m_Data;
+	size_t m_Size;
+	const ViewLayout* m_Layout;
+};
+
+} // namespace RegScript2
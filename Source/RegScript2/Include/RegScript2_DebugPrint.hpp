@@ -8,7 +8,7 @@ namespace RegScript2
 void DebugPrintParam(
 	IPrinter& printer,
 	const void* srcParam,
-	const wchar_t* paramName,
+	const Char_t* paramName,
 	const ParamDesc& paramDesc,
 	uint32_t indentLevel);
 
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "RegScript2_TokDoc.hpp"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace RegScript2
+{
+
+/*
+Compile-time description of a structure, alternative to StructDesc for hot code.
+
+Parameters are described with pointers to members, so all operations below are
+templates instantiated for the specific structure and inlined, without void*,
+virtual calls or std::function. Only plain members (like STORAGE::RAW) of
+following types are supported: bool, int32_t, uint32_t, float, String_t,
+common::GameTime, common::VEC2, VEC3, VEC4.
+
+CreateStructDesc builds ordinary StructDesc describing the same parameters, so
+the same structure can be used with FindObjParamByPath, DebugPrint, editors etc.
+
+Example:
+
+	static const auto lightDesc = rs2::MakeStaticStructDesc<Light>(RS2_TEXT("Light"),
+		RS2_STATIC_PARAM(Light, ID, 0u),
+		RS2_STATIC_PARAM(Light, Range, 10.f));
+	lightDesc.CopyObj(dstLight, srcLight);
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+// Support for parameter types
+// ADD NEW PARAMETER TYPES HERE.
+
+inline ParamDesc* CreateStaticParamDesc(bool defaultValue) { return new BoolParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(int32_t defaultValue) { return new IntParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(uint32_t defaultValue) { return new UintParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(float defaultValue) { return new FloatParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(const String_t& defaultValue) { return new StringParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(common::GameTime defaultValue) { return new GameTimeParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(const common::VEC2& defaultValue) { return new Vec2ParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(const common::VEC3& defaultValue) { return new Vec3ParamDesc(STORAGE::RAW, defaultValue); }
+inline ParamDesc* CreateStaticParamDesc(const common::VEC4& defaultValue) { return new Vec4ParamDesc(STORAGE::RAW, defaultValue); }
+
+// Same format as SaveParamToTokDoc.
+template<typename Value_t>
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, const Value_t& value)
+{
+	common::tokdoc::NodeFrom(dstNode, value);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, float value)
+{
+	SaveFloatsToTokDoc(dstNode, &value, 1);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, const common::VEC2& value)
+{
+	SaveFloatsToTokDoc(dstNode, &value.x, 2);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, const common::VEC3& value)
+{
+	SaveFloatsToTokDoc(dstNode, &value.x, 3);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, const common::VEC4& value)
+{
+	SaveFloatsToTokDoc(dstNode, &value.x, 4);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, bool value)
+{
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, value);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, int32_t value)
+{
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, value);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, uint32_t value)
+{
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, value);
+}
+inline void SaveStaticParamToTokDoc(common::tokdoc::Node& dstNode, common::GameTime value)
+{
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, value);
+}
+
+template<typename Value_t>
+inline void LoadStaticParamFromTokDoc(Value_t& outValue, const common::tokdoc::Node& srcNode)
+{
+	common::tokdoc::NodeTo(outValue, srcNode, true);
+}
+inline void LoadStaticFloatsFromTokDoc(float* outValues, size_t count, const common::tokdoc::Node& srcNode)
+{
+	if(!LoadFloatsFromTokDoc(outValues, count, srcNode))
+		throw common::Error(RS2_TEXT("Invalid float value."), __TFILE__, __LINE__);
+}
+inline void LoadStaticParamFromTokDoc(float& outValue, const common::tokdoc::Node& srcNode)
+{
+	LoadStaticFloatsFromTokDoc(&outValue, 1, srcNode);
+}
+inline void LoadStaticParamFromTokDoc(common::VEC2& outValue, const common::tokdoc::Node& srcNode)
+{
+	LoadStaticFloatsFromTokDoc(&outValue.x, 2, srcNode);
+}
+inline void LoadStaticParamFromTokDoc(common::VEC3& outValue, const common::tokdoc::Node& srcNode)
+{
+	LoadStaticFloatsFromTokDoc(&outValue.x, 3, srcNode);
+}
+inline void LoadStaticParamFromTokDoc(common::VEC4& outValue, const common::tokdoc::Node& srcNode)
+{
+	LoadStaticFloatsFromTokDoc(&outValue.x, 4, srcNode);
+}
+inline void LoadStaticParamFromTokDoc(common::GameTime& outValue, const common::tokdoc::Node& srcNode)
+{
+	double seconds = 0.;
+	common::tokdoc::NodeTo(seconds, srcNode, true);
+	outValue = common::SecondsToGameTime(seconds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Descriptors
+
+// Single parameter of StaticStructDesc. Create with MakeStaticParam or RS2_STATIC_PARAM.
+template<typename Struct_t, typename Value_t>
+struct StaticParam
+{
+	typedef Value_t Struct_t::*Member_t;
+
+	const Char_t* Name;
+	Member_t Member;
+	Value_t DefaultValue;
+
+	Value_t& Access(Struct_t& obj) const { return obj.*Member; }
+	const Value_t& Access(const Struct_t& obj) const { return obj.*Member; }
+
+	size_t GetOffset() const
+	{
+		// Address of the member is taken from uninitialized storage, object is never constructed.
+		static typename std::aligned_storage<sizeof(Struct_t), alignof(Struct_t)>::type storage;
+		const Struct_t* obj = reinterpret_cast<const Struct_t*>(&storage);
+		return (size_t)((const char*)&(obj->*Member) - (const char*)obj);
+	}
+};
+
+template<typename Struct_t, typename Value_t>
+constexpr StaticParam<Struct_t, Value_t> MakeStaticParam(const Char_t* name, Value_t Struct_t::*member, const Value_t& defaultValue)
+{
+	return StaticParam<Struct_t, Value_t>{ name, member, defaultValue };
+}
+
+template<typename Struct_t, typename... Params_t>
+class StaticStructDesc
+{
+public:
+	static const size_t PARAM_COUNT = sizeof...(Params_t);
+
+	constexpr StaticStructDesc(const Char_t* name, const Params_t&... params) :
+		m_Name(name),
+		m_Params(params...)
+	{
+	}
+
+	const Char_t* GetName() const { return m_Name; }
+	const std::tuple<Params_t...>& GetParams() const { return m_Params; }
+
+	/*
+	Calls visitor(const StaticParam<Struct_t, Value_t>&) for each parameter, in
+	order. Use it to implement additional statically typed operations.
+	*/
+	template<typename Visitor_t>
+	void ForEachParam(Visitor_t&& visitor) const
+	{
+		ForEachParamImpl(visitor, std::index_sequence_for<Params_t...>());
+	}
+
+	void SetObjToDefault(Struct_t& obj) const
+	{
+		ForEachParam([&obj](const auto& param) { param.Access(obj) = param.DefaultValue; });
+	}
+	void CopyObj(Struct_t& dstObj, const Struct_t& srcObj) const
+	{
+		ForEachParam([&dstObj, &srcObj](const auto& param) { param.Access(dstObj) = param.Access(srcObj); });
+	}
+	// Compares all parameters with operator==.
+	bool ObjEquals(const Struct_t& lhs, const Struct_t& rhs) const
+	{
+		return ObjEqualsImpl(lhs, rhs, std::index_sequence_for<Params_t...>());
+	}
+
+	// Output is the same as from SaveObjToTokDoc with StructDesc returned by CreateStructDesc.
+	void SaveObjToTokDoc(common::tokdoc::Node& dstNode, const Struct_t& srcObj) const
+	{
+		ForEachParam([&dstNode, &srcObj](const auto& param) {
+			common::tokdoc::Node* paramNode = new common::tokdoc::Node();
+			dstNode.LinkChildAtEnd(paramNode);
+			paramNode->Name = param.Name;
+			SaveStaticParamToTokDoc(*paramNode, param.Access(srcObj));
+		});
+	}
+	// All parameters are required. If any is missing or incorrect, throws common::Error.
+	void LoadObjFromTokDoc(Struct_t& dstObj, const common::tokdoc::Node& srcNode) const
+	{
+		ForEachParam([&dstObj, &srcNode](const auto& param) {
+			const common::tokdoc::Node* paramNode = srcNode.FindFirstChild(param.Name);
+			if(paramNode == nullptr)
+				throw common::Error(String_t(RS2_TEXT("RegScript2 TokDoc parameter not found: ")) + param.Name, __TFILE__, __LINE__);
+			LoadStaticParamFromTokDoc(param.Access(dstObj), *paramNode);
+		});
+	}
+
+	// Creates equivalent dynamic descriptor, with all parameters of STORAGE::RAW.
+	std::unique_ptr<StructDesc> CreateStructDesc() const
+	{
+		std::unique_ptr<StructDesc> structDesc = std::make_unique<StructDesc>(m_Name, sizeof(Struct_t));
+		ForEachParam([&structDesc](const auto& param) {
+			structDesc->AddParam(param.Name, param.GetOffset(), CreateStaticParamDesc(param.DefaultValue));
+		});
+		return structDesc;
+	}
+
+private:
+	const Char_t* m_Name;
+	std::tuple<Params_t...> m_Params;
+
+	template<typename Visitor_t, size_t... Indices>
+	void ForEachParamImpl(Visitor_t& visitor, std::index_sequence<Indices...>) const
+	{
+		// Expands to visitor(std::get<0>(m_Params)), visitor(std::get<1>(m_Params)), ...
+		int dummy[] = { 0, (visitor(std::get<Indices>(m_Params)), 0)... };
+		(void)dummy;
+	}
+
+	template<size_t... Indices>
+	bool ObjEqualsImpl(const Struct_t& lhs, const Struct_t& rhs, std::index_sequence<Indices...>) const
+	{
+		bool equal = true;
+		int dummy[] = { 0, (equal = equal && std::get<Indices>(m_Params).Access(lhs) == std::get<Indices>(m_Params).Access(rhs), 0)... };
+		(void)dummy;
+		return equal;
+	}
+};
+
+template<typename Struct_t, typename... Params_t>
+const size_t StaticStructDesc<Struct_t, Params_t...>::PARAM_COUNT;
+
+template<typename Struct_t, typename... Params_t>
+constexpr StaticStructDesc<Struct_t, Params_t...> MakeStaticStructDesc(const Char_t* name, const Params_t&... params)
+{
+	return StaticStructDesc<Struct_t, Params_t...>(name, params...);
+}
+
+} // namespace RegScript2
+
+#define RS2_STATIC_PARAM(structName, paramName, defaultValue) \
+	(rs2::MakeStaticParam<structName, decltype(structName::paramName)>( \
+		RS2_TEXT(#paramName), &structName::paramName, defaultValue))
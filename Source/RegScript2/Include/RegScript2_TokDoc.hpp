@@ -17,6 +17,9 @@ enum TOKDOC_FLAGS
 	// If parameter doesn't exist or is incorrect but continuing, initialize it with default value.
 	// Without this flag, its value is undefined.
 	TOKDOC_FLAG_DEFAULT = 0x04,
+	// If parameter doesn't exist, leave it unchanged without warning and don't count it as failure.
+	// Use to apply data saved with SaveObjToTokDocDelta or SaveObjToChunkedBinaryDelta on top of an object.
+	TOKDOC_FLAG_PATCH = 0x08,
 };
 
 struct STokDocLoadConfig
@@ -30,6 +33,37 @@ struct STokDocLoadConfig
 		Flags(flags), WarningPrinter(warningPrinter) { }
 };
 
+// Helpers for STokDocLoadConfig::Flags, shared by TokDoc and chunked binary loaders.
+inline bool IsFlagOptional(uint32_t flags)
+{
+	return (flags & (TOKDOC_FLAG_OPTIONAL | TOKDOC_FLAG_OPTIONAL_CORRECT)) != 0;
+}
+inline bool IsFlagRequired(uint32_t flags)
+{
+	return !IsFlagOptional(flags);
+}
+
+/*
+Float and vector values in TokDoc, written with FloatToChars and read with
+CharsToFloat, so they load back bit-exact without temporary strings. Single
+value is the value of the node, vector is a node with one child per component,
+same syntax as common::tokdoc::NodeFrom. Load returns false if the node has
+wrong shape or invalid number, leaving outValues partially written.
+*/
+void SaveFloatsToTokDoc(common::tokdoc::Node& dstNode, const float* values, size_t count);
+bool LoadFloatsFromTokDoc(float* outValues, size_t count, const common::tokdoc::Node& srcNode);
+
+/*
+Other simple values in TokDoc, formatted by RegScript2 itself, so that
+SaveObjToTokDoc and SaveObjToTokDocStream write exactly the same syntax. GameTime
+is written as seconds, with only as many digits as needed to load back exactly
+the same value.
+*/
+void AppendTokDocValue(String_t& out, bool value);
+void AppendTokDocValue(String_t& out, int32_t value);
+void AppendTokDocValue(String_t& out, uint32_t value);
+void AppendTokDocValue(String_t& out, common::GameTime value);
+
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const BoolParamDesc& paramDesc);
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const IntParamDesc& paramDesc);
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const UintParamDesc& paramDesc);
@@ -46,6 +80,21 @@ void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, cons
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const ParamDesc& paramDesc);
 
 void SaveObjToTokDoc(common::tokdoc::Node& dstNode, const void* srcObj, const StructDesc& structDesc);
+/*
+Writes parameters of the object directly to dst, in the same syntax as
+SaveObjToTokDoc followed by common::tokdoc::Node::SaveChildren, but without
+building the tree of nodes. Values are formatted into one buffer reused for
+all parameters, so memory usage doesn't depend on size of the object.
+*/
+void SaveObjToTokDocStream(common::TokenWriter& dst, const void* srcObj, const StructDesc& structDesc);
+/*
+Saves only parameters that differ from baseObj, or from their default values if
+baseObj is null. Structures are saved with only their differing parameters and
+omitted if there are none. Arrays are saved whole if any element differs,
+because elements are identified by position. Load with TOKDOC_FLAG_PATCH into
+an object equal to baseObj or set to default.
+*/
+void SaveObjToTokDocDelta(common::tokdoc::Node& dstNode, const void* srcObj, const void* baseObj, const StructDesc& structDesc);
 
 bool LoadParamFromTokDoc(void* dstParam, const BoolParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config);
 bool LoadParamFromTokDoc(void* dstParam, const IntParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config);
@@ -63,5 +112,51 @@ bool LoadParamFromTokDoc(void* dstParam, const FixedSizeArrayParamDesc& paramDes
 bool LoadParamFromTokDoc(void* dstParam, const ParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config);
 
 bool LoadObjFromTokDoc(void* dstObj, const StructDesc& structDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config);
+/*
+Loads the object directly from tokens, without building the tree of nodes.
+Parameters are looked up by name with StructDesc::FindTopLevel and
+values are parsed from tokens straight into dstObj, so the order of parameters
+in the document doesn't matter. Unknown parameters are skipped. If parameter
+appears more than once, first occurrence is used. Parameters that share a name
+with parameter of a base structure are all loaded from the same value. Flags and
+warnings are same as in LoadObjFromTokDoc. Except for values of string parameters,
+memory is not allocated per parameter.
+
+Like common::tokdoc::Node::LoadChildren, reads until end of document or '}',
+which is not consumed. Call src.Next() before first use.
+*/
+bool LoadObjFromTokDocStream(void* dstObj, const StructDesc& structDesc, common::Tokenizer& src, const STokDocLoadConfig& config);
+
+// Single document for LoadObjsFromTokDocParallel.
+struct STokDocLoadJob
+{
+	// Used only in messages.
+	String_t FileName;
+	// Text of the document. Must stay alive until LoadObjsFromTokDocParallel returns.
+	const String_t* Doc;
+	void* DstObj;
+	const StructDesc* DstStructDesc;
+	// Config.WarningPrinter is called on the calling thread, after all jobs are finished.
+	STokDocLoadConfig Config;
+
+	// Filled by LoadObjsFromTokDocParallel: result of LoadObjFromTokDoc, false if error was thrown.
+	bool Ok;
+	// Filled by LoadObjsFromTokDocParallel: message of the error thrown, empty if none.
+	String_t ErrorMessage;
+
+	STokDocLoadJob() : Doc(nullptr), DstObj(nullptr), DstStructDesc(nullptr), Ok(false) { }
+};
+
+/*
+Tokenizes, parses and loads documents of all jobs with LoadObjFromTokDoc, on
+threadCount threads including the calling one. 0 means one per hardware thread.
+Jobs are independent - error thrown in one is stored in its ErrorMessage and
+doesn't stop the others. Warnings are collected per job and passed to its
+Config.WarningPrinter in order of jobs, prefixed with FileName, so output
+doesn't depend on scheduling.
+
+Destination objects must be distinct. Returns true if all jobs succeeded.
+*/
+bool LoadObjsFromTokDocParallel(STokDocLoadJob* jobs, size_t jobCount, uint32_t threadCount = 0);
 
 } // namespace RegScript2
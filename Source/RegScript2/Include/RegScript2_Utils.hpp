@@ -5,16 +5,282 @@
 #include <Common/DateTime.hpp>
 
 #include <string>
+#include <vector>
+#include <mutex>
+#include <memory>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <cwctype>
 
 namespace RegScript2
 {
 
+/*
+Character type of all names, values and paths. By default it is wchar_t.
+
+Define RS2_UTF8 for the whole project to use char strings in UTF-8 instead.
+They take less memory and need no conversion when exchanged with UTF-8 files
+and APIs. CommonLib must then be built without _UNICODE, so its tstring is
+std::string as well.
+*/
+#ifdef RS2_UTF8
+	typedef char Char_t;
+	#define RS2_TEXT(s) s
+#else
+	typedef wchar_t Char_t;
+	#define RS2_TEXT(s) L##s
+#endif
+
+typedef std::basic_string<Char_t> String_t;
+
+// Overloads of C string functions, so the same code compiles for both character types.
+inline size_t StrLen(const char* str) { return strlen(str); }
+inline size_t StrLen(const wchar_t* str) { return wcslen(str); }
+inline int StrNCmp(const char* lhs, const char* rhs, size_t count) { return strncmp(lhs, rhs, count); }
+inline int StrNCmp(const wchar_t* lhs, const wchar_t* rhs, size_t count) { return wcsncmp(lhs, rhs, count); }
+inline int StrNICmp(const char* lhs, const char* rhs, size_t count) { return _strnicmp(lhs, rhs, count); }
+inline int StrNICmp(const wchar_t* lhs, const wchar_t* rhs, size_t count) { return _wcsnicmp(lhs, rhs, count); }
+inline int MemCmp(const char* lhs, const char* rhs, size_t count) { return memcmp(lhs, rhs, count); }
+inline int MemCmp(const wchar_t* lhs, const wchar_t* rhs, size_t count) { return wmemcmp(lhs, rhs, count); }
+inline void MemCpy(char* dst, const char* src, size_t count) { memcpy(dst, src, count); }
+inline void MemCpy(wchar_t* dst, const wchar_t* src, size_t count) { wmemcpy(dst, src, count); }
+inline const char* MemChr(const char* str, char ch, size_t count) { return (const char*)memchr(str, ch, count); }
+inline const wchar_t* MemChr(const wchar_t* str, wchar_t ch, size_t count) { return wmemchr(str, ch, count); }
+// For char only ASCII letters are converted, as UTF-8 sequences cannot be converted byte by byte.
+inline char CharToLower(char ch) { return ch >= 'A' && ch <= 'Z' ? (char)(ch - 'A' + 'a') : ch; }
+inline wchar_t CharToLower(wchar_t ch) { return (wchar_t)towlower(ch); }
+
 class IPrinter
 {
 public:
 	virtual ~IPrinter() { }
-	virtual void printf(const wchar_t* format, ...) = 0;
+	virtual void printf(const Char_t* format, ...) = 0;
+	// Prints single line of strLen characters, not null-terminated. Default implementation calls printf.
+	virtual void PrintLine(const Char_t* str, size_t strLen);
+};
+
+/*
+Printer that collects lines, each ended with '\n', in a big buffer and passes
+them to Flush in large blocks. Buffer is reused, so after it grows to its
+capacity, printing doesn't allocate memory.
+
+Derived class implements Flush. Its destructor should call FlushBuffer, as
+this class cannot do it.
+*/
+class BufferedPrinter : public IPrinter
+{
+public:
+	// Buffer is flushed when it reaches bufferCapacity characters.
+	explicit BufferedPrinter(size_t bufferCapacity = 256 * 1024);
+
+	virtual void printf(const Char_t* format, ...);
+	virtual void PrintLine(const Char_t* str, size_t strLen);
+	// Passes all buffered lines to Flush.
+	void FlushBuffer();
+
+protected:
+	virtual void Flush(const Char_t* data, size_t dataLen) = 0;
+
+private:
+	size_t m_BufferCapacity;
+	String_t m_Buffer;
+
+	void LineEnded();
+};
+
+// Writes lines to a file as UTF-8.
+class FilePrinter : public BufferedPrinter
+{
+public:
+	// file is not closed.
+	explicit FilePrinter(FILE* file, size_t bufferCapacity = 256 * 1024) : BufferedPrinter(bufferCapacity), m_File(file) { }
+	~FilePrinter() { FlushBuffer(); }
+
+protected:
+	virtual void Flush(const Char_t* data, size_t dataLen);
+
+private:
+	FILE* m_File;
+#ifndef RS2_UTF8
+	std::string m_Utf8Buffer;
+#endif
+};
+
+// Appends srcLen characters converted to UTF-8. Invalid characters are replaced with U+FFFD.
+void AppendUtf8(std::string& out, const wchar_t* src, size_t srcLen);
+void AppendUtf8(std::string& out, const char16_t* src, size_t srcLen);
+// Appends srcLen bytes of UTF-8 converted to UTF-16. Invalid sequences are replaced with U+FFFD.
+void AppendUtf16(std::u16string& out, const char* src, size_t srcLen);
+// Where wchar_t has 4 bytes, characters outside of BMP become surrogate pairs. Otherwise just copies.
+void AppendUtf16(std::u16string& out, const wchar_t* src, size_t srcLen);
+// Reverse of the above. Where wchar_t has 4 bytes, unpaired surrogates are replaced with U+FFFD.
+void AppendWide(std::wstring& out, const char16_t* src, size_t srcLen);
+
+/*
+FNV-1a hash of name. Stored in binary files, so it must never change. Computed
+from name converted to UTF-16, so UTF-8 and wchar_t strings with the same text
+have the same hash and files are compatible between RS2_UTF8 and default builds.
+*/
+uint32_t HashName(const char* name, size_t nameLen, bool caseSensitive = true);
+uint32_t HashName(const wchar_t* name, size_t nameLen, bool caseSensitive = true);
+
+/*
+Flat open-addressing hash table mapping names to values, built once and then
+used for lookups. Case-insensitive lookups use separate table with hashes of
+names folded to lower case, so both kinds of lookup need single probe sequence.
+
+Names are not copied - they must stay alive and unchanged as long as the index
+is used. If the same name is added more than once, first one wins.
+*/
+class NameIndex
+{
+public:
+	static const size_t INVALID_VALUE = SIZE_MAX;
+
+	// Removes all names and reserves space for nameCount names.
+	void Reset(size_t nameCount);
+	void Add(const Char_t* name, size_t nameLen, size_t value);
+	void Add(const Char_t* name, size_t value) { Add(name, StrLen(name), value); }
+
+	// Not found: returns INVALID_VALUE.
+	size_t Find(const Char_t* name, size_t nameLen, bool caseSensitive) const;
+	size_t Find(const Char_t* name, bool caseSensitive) const { return Find(name, StrLen(name), caseSensitive); }
+
+	bool IsEmpty() const { return m_Count == 0; }
+	// Bytes of memory allocated by the index.
+	size_t GetFootprint() const { return (m_Slots.capacity() + m_FoldedSlots.capacity()) * sizeof(Slot); }
+
+private:
+	struct Slot
+	{
+		const Char_t* Name; // null means empty slot.
+		size_t NameLen;
+		size_t Value;
+		uint32_t Hash;
+	};
+
+	std::vector<Slot> m_Slots;
+	std::vector<Slot> m_FoldedSlots;
+	size_t m_Count = 0;
+
+	static void Insert(std::vector<Slot>& slots, const Char_t* name, size_t nameLen, size_t value, uint32_t hash, bool caseSensitive);
+	static size_t Lookup(const std::vector<Slot>& slots, const Char_t* name, size_t nameLen, uint32_t hash, bool caseSensitive);
+};
+
+/*
+Memory for descriptors and their strings. Allocates from large blocks, so
+descriptors registered together end up next to each other in memory. Individual
+allocations are never freed - all memory is released when the arena is
+destroyed, without calling destructors.
+
+Strings are interned: each distinct string is stored once and Intern returns
+the same pointer for equal strings, valid for the lifetime of the arena.
+
+Thread-safe.
+*/
+class DescArena
+{
+public:
+	explicit DescArena(size_t blockSize = 64 * 1024);
+	~DescArena();
+
+	void* Allocate(size_t size, size_t alignment);
+	const Char_t* Intern(const Char_t* str, size_t len);
+	const Char_t* Intern(const Char_t* str) { return Intern(str, StrLen(str)); }
+	// Returns true if ptr points to memory allocated from this arena.
+	bool Contains(const void* ptr) const;
+
+	// Bytes of memory allocated by the arena, including unused space at the end of blocks.
+	size_t GetFootprint() const;
+	// Bytes actually allocated from the arena.
+	size_t GetUsedSize() const;
+
+private:
+	struct Block
+	{
+		char* Data;
+		size_t Size;
+	};
+
+	const size_t m_BlockSize;
+	mutable std::mutex m_Mutex;
+	std::vector<Block> m_Blocks;
+	char* m_CurrPtr;
+	char* m_CurrEnd;
+	size_t m_AllocatedSize;
+	size_t m_UsedSize;
+	// Values are indices into m_InternedStrings.
+	NameIndex m_InternIndex;
+	std::vector<const Char_t*> m_InternedStrings;
+
+	void* AllocateUnlocked(size_t size, size_t alignment);
+
+	DescArena(const DescArena&) = delete;
+	DescArena& operator=(const DescArena&) = delete;
+};
+
+// Global arena for interned names. Created on first use and never destroyed, so descriptors in static variables can use it until the end.
+DescArena& GetDescArena();
+
+/*
+String interned in GetDescArena() - just a pointer, valid until the end of the
+program. Assigning a string interns it. Has read-only part of the interface of
+String_t, so it can be used where names used to be stored as String_t.
+*/
+class InternedString
+{
+public:
+	InternedString() : m_Str(RS2_TEXT("")) { }
+	InternedString(const Char_t* str) : m_Str(GetDescArena().Intern(str)) { }
+	InternedString(const String_t& str) : m_Str(GetDescArena().Intern(str.c_str(), str.length())) { }
+
+	const Char_t* c_str() const { return m_Str; }
+	size_t length() const { return StrLen(m_Str); }
+	bool empty() const { return *m_Str == 0; }
+	operator String_t() const { return String_t(m_Str); }
+
+	// Equal interned strings have equal pointers. Only empty ones may differ.
+	friend bool operator==(const InternedString& lhs, const InternedString& rhs) { return lhs.m_Str == rhs.m_Str || (lhs.empty() && rhs.empty()); }
+	friend bool operator==(const InternedString& lhs, const Char_t* rhs) { return StrNCmp(lhs.m_Str, rhs, lhs.length() + 1) == 0; }
+	friend bool operator==(const Char_t* lhs, const InternedString& rhs) { return rhs == lhs; }
+	friend bool operator==(const InternedString& lhs, const String_t& rhs) { return lhs.length() == rhs.length() && MemCmp(lhs.m_Str, rhs.data(), rhs.length()) == 0; }
+	friend bool operator==(const String_t& lhs, const InternedString& rhs) { return rhs == lhs; }
+	template<typename Rhs_t>
+	friend bool operator!=(const InternedString& lhs, const Rhs_t& rhs) { return !(lhs == rhs); }
+
+private:
+	const Char_t* m_Str;
+};
+
+/*
+Allocator for std::allocate_shared placing objects together with their control
+block in DescArena. Every copy, including the one kept in the control block,
+holds a reference to the arena, so it is freed after the last object is.
+*/
+template<typename T>
+class DescArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit DescArenaAllocator(const std::shared_ptr<DescArena>& arena) : m_Arena(arena) { }
+	template<typename U>
+	DescArenaAllocator(const DescArenaAllocator<U>& other) : m_Arena(other.GetArena()) { }
+
+	const std::shared_ptr<DescArena>& GetArena() const { return m_Arena; }
+	T* allocate(size_t n) { return (T*)m_Arena->Allocate(n * sizeof(T), alignof(T)); }
+	// Memory is released together with the whole arena.
+	void deallocate(T* p, size_t n) { }
+
+	template<typename U>
+	bool operator==(const DescArenaAllocator<U>& rhs) const { return m_Arena == rhs.GetArena(); }
+	template<typename U>
+	bool operator!=(const DescArenaAllocator<U>& rhs) const { return m_Arena != rhs.GetArena(); }
+
+private:
+	std::shared_ptr<DescArena> m_Arena;
 };
 
 } // namespace RegScript2
@@ -24,25 +290,33 @@ void Format(std::wstring& str, const wchar_t* format, ...);
 void VFormat(std::string& str, const char* format, va_list argList);
 void VFormat(std::wstring& str, const wchar_t* format, va_list argList);
 string Format_r(const char* format, ...);
-wstring Format_r(const wchar_t* format, ...);
+std::wstring Format_r(const wchar_t* format, ...);
 
+// Formats directly at the end of str, so arguments must not point into str.
 void AppendFormat(std::string& str, const char* format, ...);
 void AppendFormat(std::wstring& str, const wchar_t* format, ...);
 void AppendVFormat(std::string& str, const char* format, va_list argList);
 void AppendVFormat(std::wstring& str, const wchar_t* format, va_list argList);
 
 // Returns textual representation of time duration, e.g. "12.5 ms" or "1:05:02".
-void SecondsToFriendlyStr(std::wstring& out, double seconds);
-bool FriendlyStrToSeconds(double& outSeconds, const wchar_t *str);
+void SecondsToFriendlyStr(RegScript2::String_t& out, double seconds);
+void AppendSecondsToFriendlyStr(RegScript2::String_t& out, double seconds);
+bool FriendlyStrToSeconds(double& outSeconds, const RegScript2::Char_t *str);
+// str doesn't need to be null-terminated.
+bool FriendlyStrToSeconds(double& outSeconds, const RegScript2::Char_t *str, size_t strLen);
 
-inline void GameTimeToFriendlyStr(wstring& out, common::GameTime time)
+inline void GameTimeToFriendlyStr(RegScript2::String_t& out, common::GameTime time)
 {
 	SecondsToFriendlyStr(out, time.ToSeconds_d());
 }
-inline bool FriendlyStrToGameTime(common::GameTime& outTime, const wchar_t* str)
+inline void AppendGameTimeToFriendlyStr(RegScript2::String_t& out, common::GameTime time)
+{
+	AppendSecondsToFriendlyStr(out, time.ToSeconds_d());
+}
+inline bool FriendlyStrToGameTime(common::GameTime& outTime, const RegScript2::Char_t* str, size_t strLen)
 {
 	double seconds = 0.;
-	if(FriendlyStrToSeconds(seconds, str))
+	if(FriendlyStrToSeconds(seconds, str, strLen))
 	{
 		outTime = common::SecondsToGameTime(seconds);
 		return true;
@@ -50,11 +324,43 @@ inline bool FriendlyStrToGameTime(common::GameTime& outTime, const wchar_t* str)
 	else
 		return false;
 }
+inline bool FriendlyStrToGameTime(common::GameTime& outTime, const RegScript2::Char_t* str)
+{
+	return FriendlyStrToGameTime(outTime, str, RegScript2::StrLen(str));
+}
+
+// Maximum number of characters written by FloatToChars.
+const size_t FLOAT_TO_CHARS_MAX_LEN = 16;
+
+/*
+Writes shortest decimal representation of value that parses back to exactly the
+same float, using Ryu algorithm. dst must have space for FLOAT_TO_CHARS_MAX_LEN
+characters. Terminating null is not written. Returns number of characters.
+Doesn't allocate memory.
+*/
+size_t FloatToChars(RegScript2::Char_t* dst, float value);
+void AppendFloat(RegScript2::String_t& out, float value);
+
+/*
+Parse number from characters [begin, end), which must all belong to the number.
+Result is correctly rounded, so float written by FloatToChars is read back
+exactly. Doesn't allocate memory.
+*/
+bool CharsToFloat(float& outValue, const RegScript2::Char_t* begin, const RegScript2::Char_t* end);
+bool CharsToDouble(double& outValue, const RegScript2::Char_t* begin, const RegScript2::Char_t* end);
+
+void AppendInt(RegScript2::String_t& out, int32_t value);
+// base can be 10 or 16. Hexadecimal digits are upper case.
+void AppendUint(RegScript2::String_t& out, uint32_t value, uint32_t base = 10);
+// Like CharsToFloat. Integer has optional sign and decimal digits only.
+bool CharsToInt(int32_t& outValue, const RegScript2::Char_t* begin, const RegScript2::Char_t* end);
+// Digits only, without "0x" prefix.
+bool CharsToUint(uint32_t& outValue, const RegScript2::Char_t* begin, const RegScript2::Char_t* end, uint32_t base = 10);
 
 template<typename UintType>
-bool StrToUint_AutoBase(UintType& outValue, const wchar_t* str)
+bool StrToUint_AutoBase(UintType& outValue, const RegScript2::Char_t* str)
 {
-	if(common::StrBegins(str, L"0x", false))
+	if(common::StrBegins(str, RS2_TEXT("0x"), false))
 		return common::StrToUint<UintType>(&outValue, str + 2, 16) == 0;
 	else
 		return common::StrToUint<UintType>(&outValue, str, 10) == 0;
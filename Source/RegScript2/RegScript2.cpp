@@ -1,23 +1,193 @@
 #include "Include/RegScript2.hpp"
+#include <cstring>
+#include <type_traits>
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define RS2_SSE2 1
+#else
+	#define RS2_SSE2 0
+#endif
 
 namespace RegScript2
 {
 
-const wchar_t* const ERR_MSG_VALUE_NOT_CONST = L"Value is not constant.";
-static const wchar_t* const ERR_MSG_PARAM_READ_ONLY = L"Parameter is read-only.";
-static const wchar_t* const ERR_MSG_PARAM_WRITE_ONLY = L"Paramter is write-only.";
-static const wchar_t* const ERR_MSG_CANNOT_SET_VALUE = L"Cannot set parameter value.";
+const Char_t* const ERR_MSG_VALUE_NOT_CONST = RS2_TEXT("Value is not constant.");
+static const Char_t* const ERR_MSG_PARAM_READ_ONLY = RS2_TEXT("Parameter is read-only.");
+static const Char_t* const ERR_MSG_PARAM_WRITE_ONLY = RS2_TEXT("Paramter is write-only.");
+static const Char_t* const ERR_MSG_CANNOT_SET_VALUE = RS2_TEXT("Cannot set parameter value.");
 
 struct StorageFunction { };
 StorageFunction storageFunction;
 
+////////////////////////////////////////////////////////////////////////////////
+// Batch access
+
+template<typename Value_t>
+static void GatherBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count)
+{
+	if(stride == sizeof(Value_t))
+	{
+		memcpy(outValues, firstParam, count * sizeof(Value_t));
+		return;
+	}
+	const char* src = (const char*)firstParam;
+	for(size_t i = 0; i < count; ++i, src += stride)
+		outValues[i] = *(const Value_t*)src;
+}
+
+template<typename Value_t>
+static void ScatterBatch(void* firstParam, size_t stride, const Value_t* values, size_t count)
+{
+	if(stride == sizeof(Value_t))
+	{
+		memcpy(firstParam, values, count * sizeof(Value_t));
+		return;
+	}
+	char* dst = (char*)firstParam;
+	for(size_t i = 0; i < count; ++i, dst += stride)
+		*(Value_t*)dst = values[i];
+}
+
+// Same result as FloatParamDesc::ClampValueToMinMax, including NaN becoming minValue.
+static void ClampBatchToMinMax(float* values, size_t count, float minValue, float maxValue)
+{
+	size_t i = 0;
+#if RS2_SSE2
+	const __m128 minV = _mm_set1_ps(minValue);
+	const __m128 maxV = _mm_set1_ps(maxValue);
+	for(; i + 4 <= count; i += 4)
+	{
+		// maxps returns second operand if any of them is NaN.
+		__m128 v = _mm_max_ps(_mm_loadu_ps(values + i), minV);
+		_mm_storeu_ps(values + i, _mm_min_ps(v, maxV));
+	}
+#endif
+	for(; i < count; ++i)
+	{
+		if(!(values[i] >= minValue))
+			values[i] = minValue;
+		else if(!(values[i] <= maxValue))
+			values[i] = maxValue;
+	}
+}
+
+// For int32_t and uint32_t. SSE2 has only signed comparison, so unsigned values are biased to signed range.
+template<typename Value_t>
+static void ClampBatchToMinMax(Value_t* values, size_t count, Value_t minValue, Value_t maxValue)
+{
+	size_t i = 0;
+#if RS2_SSE2
+	const int32_t bias = std::is_signed<Value_t>::value ? 0 : INT32_MIN;
+	const __m128i biasV = _mm_set1_epi32(bias);
+	const __m128i minV = _mm_set1_epi32((int32_t)minValue);
+	const __m128i maxV = _mm_set1_epi32((int32_t)maxValue);
+	const __m128i minBiasedV = _mm_xor_si128(minV, biasV);
+	const __m128i maxBiasedV = _mm_xor_si128(maxV, biasV);
+	for(; i + 4 <= count; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(values + i));
+		__m128i vBiased = _mm_xor_si128(v, biasV);
+		__m128i mask = _mm_cmplt_epi32(vBiased, minBiasedV);
+		v = _mm_or_si128(_mm_and_si128(mask, minV), _mm_andnot_si128(mask, v));
+		mask = _mm_cmpgt_epi32(vBiased, maxBiasedV);
+		v = _mm_or_si128(_mm_and_si128(mask, maxV), _mm_andnot_si128(mask, v));
+		_mm_storeu_si128((__m128i*)(values + i), v);
+	}
+#endif
+	for(; i < count; ++i)
+	{
+		if(values[i] < minValue)
+			values[i] = minValue;
+		else if(values[i] > maxValue)
+			values[i] = maxValue;
+	}
+}
+
+template<typename ParamDesc_t>
+static bool BatchInMinMax(const ParamDesc_t& paramDesc, const typename ParamDesc_t::Value_t* values, size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(!paramDesc.ValueInMinMax(values[i]))
+			return false;
+	}
+	return true;
+}
+
+/*
+Common part of GetBatch of scalar parameter types. Access rights must be
+checked by the caller.
+*/
+template<typename ParamDesc_t>
+static void GetBatchImpl(
+	const ParamDesc_t& paramDesc,
+	typename ParamDesc_t::Value_t* outValues, const void* firstParam, size_t stride, size_t count)
+{
+	if(paramDesc.GetStorage() == STORAGE::RAW)
+	{
+		GatherBatch(outValues, firstParam, stride, count);
+		if(paramDesc.Flags & ParamDesc::FLAG_MINMAX_CLAMP_ON_GET)
+			ClampBatchToMinMax(outValues, count, paramDesc.MinValue, paramDesc.MaxValue);
+	}
+	else
+	{
+		const char* src = (const char*)firstParam;
+		for(size_t i = 0; i < count; ++i, src += stride)
+			outValues[i] = paramDesc.GetConst(src);
+	}
+}
+
+/*
+Common part of SetBatch of scalar parameter types. Access rights must be
+checked by the caller.
+*/
+template<typename ParamDesc_t>
+static void SetBatchImpl(
+	const ParamDesc_t& paramDesc,
+	void* firstParam, size_t stride, const typename ParamDesc_t::Value_t* values, size_t count)
+{
+	typedef typename ParamDesc_t::Value_t Value_t;
+	const uint32_t flags = paramDesc.Flags;
+	if(flags & ParamDesc::FLAG_MINMAX_FAIL_ON_SET)
+	{
+		if(!BatchInMinMax(paramDesc, values, count))
+			throw common::Error(ERR_MSG_CANNOT_SET_VALUE, __TFILE__, __LINE__);
+	}
+	if(paramDesc.GetStorage() != STORAGE::RAW)
+	{
+		char* dst = (char*)firstParam;
+		for(size_t i = 0; i < count; ++i, dst += stride)
+			paramDesc.SetConst(dst, values[i]);
+	}
+	// Same as in TrySetConst: clamping is not done when failing on out of range values.
+	else if((flags & ParamDesc::FLAG_MINMAX_CLAMP_ON_SET) && !(flags & ParamDesc::FLAG_MINMAX_FAIL_ON_SET))
+	{
+		// Clamp in blocks on the stack, because values can't be modified.
+		const size_t BLOCK_SIZE = 256;
+		Value_t block[BLOCK_SIZE];
+		char* dst = (char*)firstParam;
+		for(size_t i = 0; i < count; i += BLOCK_SIZE)
+		{
+			const size_t blockCount = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+			memcpy(block, values + i, blockCount * sizeof(Value_t));
+			ClampBatchToMinMax(block, blockCount, paramDesc.MinValue, paramDesc.MaxValue);
+			ScatterBatch(dst, stride, block, blockCount);
+			dst += blockCount * stride;
+		}
+	}
+	else
+		ScatterBatch(firstParam, stride, values, count);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // class EnumDesc
 
 EnumDesc::EnumDesc(
-	const wchar_t* name,
+	const Char_t* name,
 	size_t itemCount,
-	const wchar_t* const* itemNames,
+	const Char_t* const* itemNames,
 	const int32_t* itemValues) :
 	Name(name),
 	ItemCount(itemCount),
@@ -33,26 +203,34 @@ EnumDesc::EnumDesc(
 	}
 }
 
-size_t EnumDesc::FindItemByName(const wchar_t* name, bool caseSensitive) const
+size_t EnumDesc::FindItemByName(const Char_t* name, bool caseSensitive) const
 {
-	for(size_t i = 0; i < ItemCount; ++i)
-	{
-		if((caseSensitive && wcscmp(name, ItemNames[i]) == 0) ||
-			(!caseSensitive && _wcsicmp(name, ItemNames[i]) == 0))
-		{
-			return i;
-		}
-	}
-	return INVALID_INDEX;
+	return FindItemByName(name, StrLen(name), caseSensitive);
+}
+
+size_t EnumDesc::FindItemByName(const Char_t* name, size_t nameLen, bool caseSensitive) const
+{
+	std::call_once(m_IndexBuilt, [this]() { BuildIndex(); });
+	const size_t index = m_NameIndex.Find(name, nameLen, caseSensitive);
+	return index != NameIndex::INVALID_VALUE ? index : INVALID_INDEX;
 }
 
 size_t EnumDesc::FindItemByValue(int32_t value) const
 {
 	if(ItemValues)
 	{
-		for(size_t i = 0; i < ItemCount; ++i)
-			if(value == ItemValues[i])
-				return i;
+		std::call_once(m_IndexBuilt, [this]() { BuildIndex(); });
+		if(!m_DenseValues.empty())
+		{
+			const int64_t offset = (int64_t)value - m_MinValue;
+			if(offset < 0 || offset >= (int64_t)m_DenseValues.size() || m_DenseValues[(size_t)offset] == UINT32_MAX)
+				return INVALID_INDEX;
+			return m_DenseValues[(size_t)offset];
+		}
+		auto it = std::lower_bound(m_SortedValues.begin(), m_SortedValues.end(), value,
+			[](const ValueEntry& entry, int32_t value) { return entry.Value < value; });
+		if(it != m_SortedValues.end() && it->Value == value)
+			return it->Index;
 		return INVALID_INDEX;
 	}
 	else
@@ -67,18 +245,63 @@ size_t EnumDesc::FindItemByValue(int32_t value) const
 	}
 }
 
-void EnumDesc::ValueToStr(std::wstring& out, int32_t value) const
+void EnumDesc::BuildIndex() const
+{
+	// If names or values repeat, first item wins, same as in linear search.
+	m_NameIndex.Reset(ItemCount);
+	for(size_t i = 0; i < ItemCount; ++i)
+		m_NameIndex.Add(ItemNames[i], i);
+
+	if(ItemValues == nullptr || ItemCount == 0)
+		return;
+	int32_t minValue = ItemValues[0], maxValue = ItemValues[0];
+	for(size_t i = 1; i < ItemCount; ++i)
+	{
+		minValue = std::min(minValue, ItemValues[i]);
+		maxValue = std::max(maxValue, ItemValues[i]);
+	}
+	// Dense table is used if it takes at most 4 elements per item.
+	const int64_t valueRange = (int64_t)maxValue - minValue + 1;
+	if(valueRange <= (int64_t)ItemCount * 4)
+	{
+		m_MinValue = minValue;
+		m_DenseValues.assign((size_t)valueRange, UINT32_MAX);
+		for(size_t i = ItemCount; i--; )
+			m_DenseValues[(size_t)((int64_t)ItemValues[i] - minValue)] = (uint32_t)i;
+	}
+	else
+	{
+		m_SortedValues.resize(ItemCount);
+		for(size_t i = 0; i < ItemCount; ++i)
+			m_SortedValues[i] = ValueEntry{ItemValues[i], (uint32_t)i};
+		std::stable_sort(m_SortedValues.begin(), m_SortedValues.end(),
+			[](const ValueEntry& lhs, const ValueEntry& rhs) { return lhs.Value < rhs.Value; });
+	}
+}
+
+void EnumDesc::ValueToStr(String_t& out, int32_t value) const
+{
+	out.clear();
+	AppendValueToStr(out, value);
+}
+
+void EnumDesc::AppendValueToStr(String_t& out, int32_t value) const
 {
 	size_t index = FindItemByValue(value);
 	if(index != INVALID_INDEX)
-		out = ItemNames[index];
+		out += ItemNames[index];
 	else
-		common::IntToStr(&out, value);
+		AppendInt(out, value);
 }
 
-bool EnumDesc::StrToValue(int32_t& out, const wchar_t* str, bool caseSensitive, bool allowInteger) const
+bool EnumDesc::StrToValue(int32_t& out, const Char_t* str, bool caseSensitive, bool allowInteger) const
 {
-	size_t index = FindItemByName(str, caseSensitive);
+	return StrToValue(out, str, StrLen(str), caseSensitive, allowInteger);
+}
+
+bool EnumDesc::StrToValue(int32_t& out, const Char_t* str, size_t strLen, bool caseSensitive, bool allowInteger) const
+{
+	size_t index = FindItemByName(str, strLen, caseSensitive);
 	if(index != INVALID_INDEX)
 	{
 		out = GetValue(index);
@@ -87,7 +310,7 @@ bool EnumDesc::StrToValue(int32_t& out, const wchar_t* str, bool caseSensitive,
 	else
 	{
 		if(allowInteger)
-			return common::StrToInt(&out, str) == 0;
+			return CharsToInt(out, str, str + strLen);
 		else
 			return false;
 	}
@@ -191,26 +414,26 @@ void FloatParam::SetConst(float value)
 ////////////////////////////////////////////////////////////////////////////////
 // class StringParam
 
-void StringParam::GetConst(std::wstring& outValue) const
+void StringParam::GetConst(String_t& outValue) const
 {
 	if(!TryGetConst(outValue))
 		throw common::Error(ERR_MSG_VALUE_NOT_CONST, __TFILE__, __LINE__);
 }
 
-const std::wstring* StringParam::AccessConst() const
+const String_t* StringParam::AccessConst() const
 {
     assert(IsConst());
     return &m_Value;
 }
 
-void StringParam::SetConst(const wchar_t* value, size_t valueLen)
+void StringParam::SetConst(const Char_t* value, size_t valueLen)
 {
 	// TODO
 	m_ValueType = VALUE_TYPE::CONSTANT;
 	m_Value.assign(value, value + valueLen);
 }
 
-void StringParam::SetConst(const wchar_t* value)
+void StringParam::SetConst(const Char_t* value)
 {
 	// TODO
 	m_ValueType = VALUE_TYPE::CONSTANT;
@@ -274,36 +497,438 @@ void StructDesc::CopyParam(void* dstObj, const void* srcObj, size_t paramIndex)
 
 void StructDesc::SetObjToDefault(void* obj) const
 {
-	if(m_BaseStructDesc)
-		m_BaseStructDesc->SetObjToDefault(obj);
-	for(size_t i = 0, count = Params.size(); i < count; ++i)
-    {
-        if(Params[i]->CanWrite())
-		    SetParamToDefault(obj, i);
-    }
+	const LayoutPlan& plan = GetLayoutPlan();
+	char* const objBytes = (char*)obj;
+	for(const LayoutPlan::Op& op : plan.ResetOps)
+	{
+		if(op.Size)
+			memcpy(objBytes + op.Offset, &plan.DefaultImage[op.Offset], op.Size);
+		else
+		{
+			const LayoutEntry& entry = plan.Entries[op.EntryIndex];
+			if(entry.Kind == LayoutEntry::KIND::PARAM)
+				entry.Desc->SetToDefault(objBytes + entry.Offset);
+			else
+				// Struct or array element that cannot be written.
+				throw common::Error(ERR_MSG_PARAM_READ_ONLY, __TFILE__, __LINE__);
+		}
+	}
 }
 
 void StructDesc::CopyObj(void* dstObj, const void* srcObj) const
 {
-	if(m_BaseStructDesc)
-		m_BaseStructDesc->CopyObj(dstObj, srcObj);
-	for(size_t i = 0, count = Params.size(); i < count; ++i)
-		CopyParam(dstObj, srcObj, i);
+	const LayoutPlan& plan = GetLayoutPlan();
+	char* const dstBytes = (char*)dstObj;
+	const char* const srcBytes = (const char*)srcObj;
+	for(const LayoutPlan::Op& op : plan.CopyOps)
+	{
+		if(op.Size)
+			memcpy(dstBytes + op.Offset, srcBytes + op.Offset, op.Size);
+		else
+		{
+			const LayoutEntry& entry = plan.Entries[op.EntryIndex];
+			if(entry.Kind == LayoutEntry::KIND::PARAM)
+				entry.Desc->Copy(dstBytes + entry.Offset, srcBytes + entry.Offset);
+			else
+			{
+				// Struct or array that cannot be read or written.
+				if(!entry.CanRead())
+					throw common::Error(ERR_MSG_PARAM_WRITE_ONLY, __TFILE__, __LINE__);
+				throw common::Error(ERR_MSG_PARAM_READ_ONLY, __TFILE__, __LINE__);
+			}
+		}
+	}
+}
+
+// Flags that require accessing parameter through its ParamDesc.
+static const uint32_t NON_POD_PARAM_FLAGS =
+	ParamDesc::FLAG_READ_ONLY | ParamDesc::FLAG_WRITE_ONLY |
+	ParamDesc::FLAG_MINMAX_CLAMP_ON_GET | ParamDesc::FLAG_MINMAX_CLAMP_ON_SET | ParamDesc::FLAG_MINMAX_FAIL_ON_SET;
+
+static bool IsPodParamDesc(const ParamDesc& paramDesc)
+{
+	if(paramDesc.GetStorage() != STORAGE::RAW || (paramDesc.Flags & NON_POD_PARAM_FLAGS) != 0)
+		return false;
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::BOOL:
+	case PARAM_TYPE::INT:
+	case PARAM_TYPE::UINT:
+	case PARAM_TYPE::ENUM:
+	case PARAM_TYPE::FLOAT:
+	case PARAM_TYPE::GAMETIME:
+	case PARAM_TYPE::VEC2:
+	case PARAM_TYPE::VEC3:
+	case PARAM_TYPE::VEC4:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Appends memcpy of POD entry to ops, merging it with previous op if they are adjacent.
+static void AppendPodOp(std::vector<LayoutPlan::Op>& ops, const LayoutEntry& entry)
+{
+	const size_t size = entry.Desc->GetParamSize();
+	if(!ops.empty())
+	{
+		LayoutPlan::Op& lastOp = ops.back();
+		if(lastOp.Size && lastOp.Offset + lastOp.Size == entry.Offset)
+		{
+			lastOp.Size += size;
+			return;
+		}
+	}
+	ops.push_back({ entry.Offset, size, SIZE_MAX });
+}
+
+static void BuildLayoutOps(LayoutPlan& plan, size_t structSize)
+{
+	const std::vector<LayoutEntry>& entries = plan.Entries;
+	const size_t entryCount = entries.size();
+
+	for(size_t i = 0; i < entryCount; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(entry.Kind == LayoutEntry::KIND::PARAM)
+		{
+			if(entry.IsPod())
+				AppendPodOp(plan.CopyOps, entry);
+			else
+				plan.CopyOps.push_back({ entry.Offset, 0, i });
+		}
+		else if(entry.Kind == LayoutEntry::KIND::STRUCT_BEGIN || entry.Kind == LayoutEntry::KIND::ARRAY_BEGIN)
+		{
+			// CopyObj fails on it anyway, so its contents get no ops.
+			if(!entry.CanRead() || !entry.CanWrite())
+			{
+				plan.CopyOps.push_back({ entry.Offset, 0, i });
+				i = entry.EndIndex;
+			}
+		}
+	}
+
+	plan.DefaultImage.resize(structSize);
+	char* const image = plan.DefaultImage.data();
+	for(size_t i = 0; i < entryCount; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		// Parameters of a structure that cannot be written are skipped, while elements of an array are not.
+		if(entry.Kind == LayoutEntry::KIND::PARAM)
+		{
+			if(entry.IsPod())
+			{
+				AppendPodOp(plan.ResetOps, entry);
+				entry.Desc->SetToDefault(image + entry.Offset);
+			}
+			else if(entry.CanWrite() || entry.IsArrayElement())
+				plan.ResetOps.push_back({ entry.Offset, 0, i });
+		}
+		else if(entry.Kind == LayoutEntry::KIND::STRUCT_BEGIN || entry.Kind == LayoutEntry::KIND::ARRAY_BEGIN)
+		{
+			if(!entry.CanWrite())
+			{
+				if(entry.IsArrayElement())
+					plan.ResetOps.push_back({ entry.Offset, 0, i });
+				else
+					i = entry.EndIndex;
+			}
+		}
+	}
+
+	plan.Pod =
+		plan.CopyOps.size() == 1 && plan.CopyOps[0].Size == structSize &&
+		plan.ResetOps.size() == 1 && plan.ResetOps[0].Size == structSize;
+}
+
+static void AppendStructToLayout(
+	std::vector<LayoutEntry>& entries,
+	const StructDesc& structDesc,
+	size_t offset,
+	uint32_t depth);
+
+static void AppendParamToLayout(
+	std::vector<LayoutEntry>& entries,
+	const ParamDesc& paramDesc,
+	const Char_t* name,
+	size_t offset,
+	size_t elementIndex,
+	uint32_t depth)
+{
+	LayoutEntry entry;
+	entry.Storage = paramDesc.GetStorage();
+	entry.ParamFlags = paramDesc.Flags;
+	entry.LayoutFlags = 0;
+	if(name == nullptr)
+		entry.LayoutFlags |= LayoutEntry::FLAG_ARRAY_ELEMENT;
+	if(paramDesc.CanRead())
+		entry.LayoutFlags |= LayoutEntry::FLAG_CAN_READ;
+	if(paramDesc.CanWrite())
+		entry.LayoutFlags |= LayoutEntry::FLAG_CAN_WRITE;
+	if(IsPodParamDesc(paramDesc))
+		entry.LayoutFlags |= LayoutEntry::FLAG_POD;
+	entry.Depth = depth;
+	entry.Offset = offset;
+	entry.ElementIndex = elementIndex;
+	entry.Desc = &paramDesc;
+	entry.Name = name;
+
+	const size_t beginIndex = entries.size();
+	if(paramDesc.GetType() == PARAM_TYPE::STRUCT)
+	{
+		entry.Kind = LayoutEntry::KIND::STRUCT_BEGIN;
+		entries.push_back(entry);
+		AppendStructToLayout(entries, *((const StructParamDesc&)paramDesc).GetStructDesc(), offset, depth + 1);
+		entry.Kind = LayoutEntry::KIND::STRUCT_END;
+	}
+	else if(paramDesc.GetType() == PARAM_TYPE::FIXED_SIZE_ARRAY)
+	{
+		const FixedSizeArrayParamDesc& arrayParamDesc = (const FixedSizeArrayParamDesc&)paramDesc;
+		const ParamDesc* elementParamDesc = arrayParamDesc.GetElementParamDesc();
+		const size_t elementSize = elementParamDesc->GetParamSize();
+		entry.Kind = LayoutEntry::KIND::ARRAY_BEGIN;
+		entries.push_back(entry);
+		for(size_t i = 0, count = arrayParamDesc.GetCount(); i < count; ++i)
+			AppendParamToLayout(entries, *elementParamDesc, nullptr, offset + i * elementSize, i, depth);
+		entry.Kind = LayoutEntry::KIND::ARRAY_END;
+	}
+	else
+		entry.Kind = LayoutEntry::KIND::PARAM;
+
+	entry.EndIndex = entries.size();
+	entries.push_back(entry);
+	entries[beginIndex].EndIndex = entry.EndIndex;
 }
 
-size_t StructDesc::Find(const wchar_t* name, bool caseSensitive) const
+static void AppendStructToLayout(
+	std::vector<LayoutEntry>& entries,
+	const StructDesc& structDesc,
+	size_t offset,
+	uint32_t depth)
 {
-	for(size_t i = 0, count = Names.size(); i < count; ++i)
+	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
+	if(baseStructDesc)
+		AppendStructToLayout(entries, *baseStructDesc, offset, depth);
+
+	for(size_t i = 0, count = structDesc.Params.size(); i < count; ++i)
 	{
-		if((caseSensitive && Names[i] == name) ||
-			(!caseSensitive && _wcsicmp(Names[i].c_str(), name) == 0))
+		AppendParamToLayout(
+			entries,
+			*structDesc.Params[i],
+			structDesc.GetInternedName(i),
+			offset + structDesc.Offsets[i],
+			SIZE_MAX,
+			depth);
+	}
+}
+
+static void BuildTopLevelEntries(LayoutPlan& plan)
+{
+	const std::vector<LayoutEntry>& entries = plan.Entries;
+	std::vector<size_t>& sameName = plan.SameNameTopLevelEntries;
+	// Names are interned, so equal names have equal pointers. Values are indices into TopLevelEntries.
+	std::unordered_map<const Char_t*, size_t> lastIndexOfName;
+	for(size_t i = 0, count = entries.size(); i < count; i = entries[i].EndIndex + 1)
+	{
+		const size_t topLevelIndex = plan.TopLevelEntries.size();
+		plan.TopLevelEntries.push_back(i);
+		auto insertResult = lastIndexOfName.insert(std::make_pair(entries[i].Name, topLevelIndex));
+		if(insertResult.second)
+			sameName.push_back(topLevelIndex);
+		else
 		{
-			return i;
+			const size_t prevIndex = insertResult.first->second;
+			sameName.push_back(sameName[prevIndex]);
+			sameName[prevIndex] = topLevelIndex;
+			insertResult.first->second = topLevelIndex;
 		}
 	}
+}
+
+const LayoutPlan& StructDesc::GetLayoutPlan() const
+{
+	if(m_LayoutPlanReady.load(std::memory_order_acquire))
+		return *m_LayoutPlan;
+	std::lock_guard<std::mutex> lock(m_LayoutPlanMutex);
+	if(!m_LayoutPlanReady.load(std::memory_order_relaxed))
+	{
+		std::unique_ptr<LayoutPlan> plan = std::make_unique<LayoutPlan>();
+		AppendStructToLayout(plan->Entries, *this, 0, 0);
+		BuildLayoutOps(*plan, m_StructSize);
+		BuildTopLevelEntries(*plan);
+		m_LayoutPlan = std::move(plan);
+		m_LayoutPlanReady.store(true, std::memory_order_release);
+	}
+	return *m_LayoutPlan;
+}
+
+void StructDesc::InvalidateLayoutPlan()
+{
+	m_LayoutPlanReady.store(false, std::memory_order_relaxed);
+	m_LayoutPlan.reset();
+}
+
+StructDesc::StructDesc(const StructDesc& src) :
+	Names(src.Names),
+	Offsets(src.Offsets),
+	Params(src.Params),
+	m_Name(src.m_Name),
+	m_StructSize(src.m_StructSize),
+	m_BaseStructDesc(src.m_BaseStructDesc),
+	m_ParamArena(src.m_ParamArena)
+{
+}
+
+StructDesc& StructDesc::operator=(const StructDesc& src)
+{
+	if(this != &src)
+	{
+		Names = src.Names;
+		Offsets = src.Offsets;
+		Params = src.Params;
+		m_Name = src.m_Name;
+		m_StructSize = src.m_StructSize;
+		m_BaseStructDesc = src.m_BaseStructDesc;
+		m_ParamArena = src.m_ParamArena;
+		InvalidateLayoutPlan();
+		m_NameIndexVersion.store(SIZE_MAX, std::memory_order_relaxed);
+	}
+	return *this;
+}
+
+size_t StructDesc::Find(const Char_t* name, bool caseSensitive) const
+{
+	return Find(name, StrLen(name), caseSensitive);
+}
+
+size_t StructDesc::Find(const Char_t* name, size_t nameLen, bool caseSensitive) const
+{
+	const StructDesc* structDesc = nullptr;
+	size_t index = 0;
+	// Own parameters are added to the index first, so they win over inherited ones with same name.
+	if(FindInherited(structDesc, index, name, nameLen, caseSensitive) && structDesc == this)
+		return index;
 	return (size_t)-1;
 }
 
+bool StructDesc::FindInherited(const StructDesc*& outStructDesc, size_t& outIndex, const Char_t* name, size_t nameLen, bool caseSensitive) const
+{
+	EnsureNameIndex();
+	size_t inheritedIndex = m_NameIndex.Find(name, nameLen, caseSensitive);
+	if(inheritedIndex == NameIndex::INVALID_VALUE)
+		return false;
+	outStructDesc = m_InheritedParams[inheritedIndex].Owner;
+	outIndex = m_InheritedParams[inheritedIndex].Index;
+	return true;
+}
+
+size_t StructDesc::FindTopLevel(const Char_t* name, size_t nameLen, bool caseSensitive) const
+{
+	EnsureNameIndex();
+	size_t inheritedIndex = m_NameIndex.Find(name, nameLen, caseSensitive);
+	if(inheritedIndex == NameIndex::INVALID_VALUE)
+		return SIZE_MAX;
+	return m_InheritedParams[inheritedIndex].TopLevelIndex;
+}
+
+void StructDesc::AddParamDesc(const Char_t* name, size_t offset, std::shared_ptr<ParamDesc>&& param)
+{
+	Names.push_back(name);
+	Offsets.push_back(offset);
+	Params.push_back(std::move(param));
+	InvalidateLayoutPlan();
+	InvalidateNameIndex();
+}
+
+const std::shared_ptr<DescArena>& StructDesc::AccessParamArena()
+{
+	// Descriptors of single structure are small, so blocks are smaller than in the global arena.
+	if(!m_ParamArena)
+		m_ParamArena = std::make_shared<DescArena>(4096);
+	return m_ParamArena;
+}
+
+size_t StructDesc::GetFootprint() const
+{
+	size_t result = sizeof(StructDesc) +
+		Names.capacity() * sizeof(InternedString) +
+		Offsets.capacity() * sizeof(size_t) +
+		Params.capacity() * sizeof(std::shared_ptr<ParamDesc>) +
+		m_NameIndex.GetFootprint() +
+		m_InheritedParams.capacity() * sizeof(InheritedParam);
+	if(m_LayoutPlan)
+	{
+		result += sizeof(LayoutPlan) +
+			m_LayoutPlan->Entries.capacity() * sizeof(LayoutEntry) +
+			(m_LayoutPlan->CopyOps.capacity() + m_LayoutPlan->ResetOps.capacity()) * sizeof(LayoutPlan::Op) +
+			(m_LayoutPlan->TopLevelEntries.capacity() + m_LayoutPlan->SameNameTopLevelEntries.capacity()) * sizeof(size_t);
+	}
+	if(m_ParamArena)
+		result += m_ParamArena->GetFootprint();
+	for(size_t i = 0, count = Params.size(); i < count; ++i)
+	{
+		if(!m_ParamArena || !m_ParamArena->Contains(Params[i].get()))
+			result += VisitParamDesc(*Params[i], [](const auto& paramDesc) { return sizeof(paramDesc); });
+	}
+	return result;
+}
+
+size_t StructDesc::GetParamsVersionWithBases() const
+{
+	size_t result = 0;
+	for(const StructDesc* structDesc = this; structDesc != nullptr; structDesc = structDesc->m_BaseStructDesc)
+		result += structDesc->m_ParamsVersion;
+	return result;
+}
+
+void StructDesc::EnsureNameIndex() const
+{
+	// Versions only grow, so their sum changes whenever any of them does.
+	const size_t version = GetParamsVersionWithBases();
+	if(m_NameIndexVersion.load(std::memory_order_acquire) == version)
+		return;
+	std::lock_guard<std::mutex> lock(m_NameIndexMutex);
+	if(m_NameIndexVersion.load(std::memory_order_relaxed) == version)
+		return;
+	BuildNameIndex();
+	m_NameIndexVersion.store(version, std::memory_order_release);
+}
+
+void StructDesc::BuildNameIndex() const
+{
+	m_InheritedParams.clear();
+	for(const StructDesc* structDesc = this; structDesc != nullptr; structDesc = structDesc->m_BaseStructDesc)
+	{
+		for(size_t i = 0, count = structDesc->Names.size(); i < count; ++i)
+			m_InheritedParams.push_back(InheritedParam{structDesc, i, 0});
+	}
+	// Top-level entries of the layout plan list parameters of base structures first.
+	const size_t inheritedCount = m_InheritedParams.size();
+	for(size_t i = 0; i < inheritedCount; )
+	{
+		const size_t ownerEnd = i + m_InheritedParams[i].Owner->Names.size();
+		for(; i < ownerEnd; ++i)
+			m_InheritedParams[i].TopLevelIndex = inheritedCount - ownerEnd + m_InheritedParams[i].Index;
+	}
+	m_NameIndex.Reset(m_InheritedParams.size());
+	std::vector<uint32_t> hashes(m_InheritedParams.size());
+	for(size_t i = 0, count = m_InheritedParams.size(); i < count; ++i)
+	{
+		const Char_t* name = m_InheritedParams[i].Owner->GetInternedName(m_InheritedParams[i].Index);
+		const size_t nameLen = StrLen(name);
+		m_NameIndex.Add(name, nameLen, i);
+		hashes[i] = HashName(name, nameLen);
+	}
+	std::sort(hashes.begin(), hashes.end());
+	m_NameHashCollision = std::adjacent_find(hashes.begin(), hashes.end()) != hashes.end();
+}
+
+bool StructDesc::HasNameHashCollision() const
+{
+	EnsureNameIndex();
+	return m_NameHashCollision;
+}
+
 ParamDesc* StructDesc::GetParamDesc(size_t index)
 {
 	assert(index < Params.size());
@@ -331,6 +956,20 @@ void ParamDesc::CheckCanRead() const
 		throw common::Error(ERR_MSG_PARAM_WRITE_ONLY, __TFILE__, __LINE__);
 }
 
+bool ParamDesc::AppendToString(String_t& out, const void* srcParam) const
+{
+	String_t str;
+	if(!ToString(str, srcParam))
+		return false;
+	out += str;
+	return true;
+}
+
+bool ParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
+{
+	return Parse(dstParam, String_t(src, srcLen).c_str());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // class FixedSizeArrayParamDesc
 
@@ -441,7 +1080,7 @@ bool BoolParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 	case STORAGE::PARAM:
 		return AccessAsParam(param)->TryGetConst(outValue);
 	case STORAGE::FUNCTION:
-		return GetFunc(outValue, param);
+		return Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 	default:
 		assert(0);
 		return false;
@@ -470,7 +1109,7 @@ bool BoolParamDesc::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -504,25 +1143,34 @@ void BoolParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool BoolParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool BoolParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
 	{
-		SthToStr<bool>(&out, value);
+		out += value ? RS2_TEXT("true") : RS2_TEXT("false");
 		return true;
 	}
 	else
 		return false;
 }
 
-bool BoolParamDesc::Parse(void* dstParam, const wchar_t* src) const
+static bool CharsEqual(const Char_t* src, size_t srcLen, const Char_t* str)
+{
+	const size_t strLen = StrLen(str);
+	return srcLen == strLen && MemCmp(src, str, strLen) == 0;
+}
+
+bool BoolParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
 	Value_t value;
-	if(StrToSth<bool>(&value, src))
-		return TrySetConst(dstParam, value);
+	if(CharsEqual(src, srcLen, RS2_TEXT("true")) || CharsEqual(src, srcLen, RS2_TEXT("1")))
+		value = true;
+	else if(CharsEqual(src, srcLen, RS2_TEXT("false")) || CharsEqual(src, srcLen, RS2_TEXT("0")))
+		value = false;
 	else
 		return false;
+	return TrySetConst(dstParam, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -572,7 +1220,7 @@ bool IntParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 		ok = AccessAsParam(param)->TryGetConst(outValue);
 		break;
 	case STORAGE::FUNCTION:
-		ok = GetFunc(outValue, param);
+		ok = Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 		break;
 	default:
 		assert(0);
@@ -608,7 +1256,7 @@ bool IntParamDesc::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -622,6 +1270,18 @@ void IntParamDesc::SetConst(void* param, Value_t value) const
 		throw common::Error(ERR_MSG_CANNOT_SET_VALUE, __TFILE__, __LINE__);
 }
 
+void IntParamDesc::GetBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count) const
+{
+	CheckCanRead();
+	GetBatchImpl(*this, outValues, firstParam, stride, count);
+}
+
+void IntParamDesc::SetBatch(void* firstParam, size_t stride, const Value_t* values, size_t count) const
+{
+	CheckCanWrite();
+	SetBatchImpl(*this, firstParam, stride, values, count);
+}
+
 void IntParamDesc::Copy(void* dstParam, const void* srcParam) const
 {
 	CheckCanRead();
@@ -643,22 +1303,22 @@ void IntParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool IntParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool IntParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
 	{
-		common::IntToStr(&out, value);
+		AppendInt(out, value);
 		return true;
 	}
 	else
 		return false;
 }
 
-bool IntParamDesc::Parse(void* dstParam, const wchar_t* src) const
+bool IntParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
 	Value_t value;
-	if(common::StrToInt(&value, src) == 0)
+	if(CharsToInt(value, src, src + srcLen))
 		return TrySetConst(dstParam, value);
 	else
 		return false;
@@ -711,7 +1371,7 @@ bool UintParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 		ok = AccessAsParam(param)->TryGetConst(outValue);
 		break;
 	case STORAGE::FUNCTION:
-		ok = GetFunc(outValue, param);
+		ok = Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 		break;
 	default:
 		assert(0);
@@ -747,7 +1407,7 @@ bool UintParamDesc::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -761,6 +1421,18 @@ void UintParamDesc::SetConst(void* param, Value_t value) const
 		throw common::Error(ERR_MSG_CANNOT_SET_VALUE, __TFILE__, __LINE__);
 }
 
+void UintParamDesc::GetBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count) const
+{
+	CheckCanRead();
+	GetBatchImpl(*this, outValues, firstParam, stride, count);
+}
+
+void UintParamDesc::SetBatch(void* firstParam, size_t stride, const Value_t* values, size_t count) const
+{
+	CheckCanWrite();
+	SetBatchImpl(*this, firstParam, stride, values, count);
+}
+
 void UintParamDesc::Copy(void* dstParam, const void* srcParam) const
 {
 	CheckCanRead();
@@ -782,28 +1454,33 @@ void UintParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool UintParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool UintParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
 	{
 		if(Flags & FLAG_FORMAT_HEX)
 		{
-			common::UintToStr(&out, value, 16);
-			out.insert(0, L"0x");
+			out += RS2_TEXT("0x");
+			AppendUint(out, value, 16);
 		}
 		else
-			common::UintToStr(&out, value, 10);
+			AppendUint(out, value, 10);
 		return true;
 	}
 	else
 		return false;
 }
 
-bool UintParamDesc::Parse(void* dstParam, const wchar_t* src) const
+bool UintParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
 	Value_t value;
-	if(StrToUint_AutoBase<Value_t>(value, src))
+	bool ok;
+	if(srcLen >= 2 && src[0] == RS2_TEXT('0') && (src[1] == RS2_TEXT('x') || src[1] == RS2_TEXT('X')))
+		ok = CharsToUint(value, src + 2, src + srcLen, 16);
+	else
+		ok = CharsToUint(value, src, src + srcLen, 10);
+	if(ok)
 		return TrySetConst(dstParam, value);
 	else
 		return false;
@@ -856,7 +1533,7 @@ bool EnumParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 		ok = AccessAsParam(param)->TryGetConst(outValue);
 		break;
 	case STORAGE::FUNCTION:
-		ok = GetFunc(outValue, param);
+		ok = Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 		break;
 	default:
 		assert(0);
@@ -888,7 +1565,7 @@ bool EnumParamDesc::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -923,22 +1600,22 @@ void EnumParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool EnumParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool EnumParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
 	{
-		m_EnumDesc->ValueToStr(out, value);
+		m_EnumDesc->AppendValueToStr(out, value);
 		return true;
 	}
 	else
 		return false;
 }
 
-bool EnumParamDesc::Parse(void* dstParam, const wchar_t* src) const
+bool EnumParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
 	Value_t value;
-	if(m_EnumDesc->StrToValue(value, src, true, !(Flags & FLAG_MINMAX_FAIL_ON_SET)))
+	if(m_EnumDesc->StrToValue(value, src, srcLen, true, !(Flags & FLAG_MINMAX_FAIL_ON_SET)))
 		return TrySetConst(dstParam, value);
 	else
 		return false;
@@ -991,7 +1668,7 @@ bool FloatParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 		ok = AccessAsParam(param)->TryGetConst(outValue);
 		break;
 	case STORAGE::FUNCTION:
-		ok = GetFunc(outValue, param);
+		ok = Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 		break;
 	default:
 		assert(0);
@@ -1027,7 +1704,7 @@ bool FloatParamDesc::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -1041,6 +1718,18 @@ void FloatParamDesc::SetConst(void* param, Value_t value) const
 		throw common::Error(ERR_MSG_CANNOT_SET_VALUE, __TFILE__, __LINE__);
 }
 
+void FloatParamDesc::GetBatch(Value_t* outValues, const void* firstParam, size_t stride, size_t count) const
+{
+	CheckCanRead();
+	GetBatchImpl(*this, outValues, firstParam, stride, count);
+}
+
+void FloatParamDesc::SetBatch(void* firstParam, size_t stride, const Value_t* values, size_t count) const
+{
+	CheckCanWrite();
+	SetBatchImpl(*this, firstParam, stride, values, count);
+}
+
 void FloatParamDesc::Copy(void* dstParam, const void* srcParam) const
 {
 	CheckCanRead();
@@ -1062,7 +1751,7 @@ void FloatParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool FloatParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool FloatParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
@@ -1071,72 +1760,70 @@ bool FloatParamDesc::ToString(std::wstring& out, const void* srcParam) const
 		{
 			if(Flags & FLAG_FORMAT_PERCENT)
 			{
-				ValueToStr(out, value * 100.f);
-				out += L'%';
+				AppendValueToStr(out, value * 100.f);
+				out += RS2_TEXT('%');
 				return true;
 			}
 			else if (Flags & FLAG_FORMAT_DB && value > 0.f)
 			{
-				ValueToStr(out, PowerToDB(value));
-				out += L"dB";
+				AppendValueToStr(out, PowerToDB(value));
+				out += RS2_TEXT("dB");
 				return true;
 			}
             else if(Flags & FLAG_FORMAT_DEG)
             {
-                ValueToStr(out, common::RadToDeg(value));
-                out += L"deg";
+                AppendValueToStr(out, common::RadToDeg(value));
+                out += RS2_TEXT("deg");
                 return true;
             }
 		}
-		ValueToStr(out, value);
+		AppendValueToStr(out, value);
 		return true;
 	}
 	else
 		return false;
 }
 
-bool FloatParamDesc::Parse(void* dstParam, const wchar_t* src) const
+bool FloatParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
 	Value_t value;
-	if(common::StrEnds(src, L"%", true))
+	const Char_t* const srcEnd = src + srcLen;
+	if(srcLen >= 1 && srcEnd[-1] == RS2_TEXT('%'))
 	{
-		wstring newStr { src, src + wcslen(src) - 1 };
-		if(StrToSth<float>(&value, newStr))
+		if(CharsToFloat(value, src, srcEnd - 1))
 			return TrySetConst(dstParam, value * 0.01f);
 		else
 			return false;
 	}
-	else if(common::StrEnds(src, L"dB", false))
+	else if(srcLen >= 2 && StrNICmp(srcEnd - 2, RS2_TEXT("dB"), 2) == 0)
 	{
-		wstring newStr(src, src + wcslen(src) - 2);
-		if(StrToSth<float>(&value, newStr))
+		if(CharsToFloat(value, src, srcEnd - 2))
 			return TrySetConst(dstParam, DBToPower(value));
 		else
 			return false;
 	}
-    else if(common::StrEnds(src, L"deg", false))
+    else if(srcLen >= 3 && StrNICmp(srcEnd - 3, RS2_TEXT("deg"), 3) == 0)
     {
-        wstring newStr(src, src + wcslen(src) - 3);
-        if(StrToSth<float>(&value, newStr))
+        if(CharsToFloat(value, src, srcEnd - 3))
             return TrySetConst(dstParam, common::DegToRad(value));
         else
             return false;
     }
 	else
 	{
-		if(StrToSth<float>(&value, src))
+		if(CharsToFloat(value, src, srcEnd))
 			return TrySetConst(dstParam, value);
 		else
 			return false;
 	}
 }
 
-void FloatParamDesc::ValueToStr(std::wstring& out, float value) const
+void FloatParamDesc::AppendValueToStr(String_t& out, float value) const
 {
 	if(Precision == UINT_MAX)
-		common::FloatToStr(&out, value, 'g');
+		AppendFloat(out, value);
 	else
-		common::FloatToStr(&out, value, 'f', (int)Precision);
+		AppendFormat(out, RS2_TEXT("%.*f"), (int)Precision, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1183,7 +1870,7 @@ bool StringParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 	case STORAGE::PARAM:
 		return AccessAsParam(param)->TryGetConst(outValue);
 	case STORAGE::FUNCTION:
-		return GetFunc(outValue, param);
+		return Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 	default:
 		assert(0);
 		return false;
@@ -1211,7 +1898,7 @@ const StringParamDesc::Value_t* StringParamDesc::AccessConst(const void* param)
 	}
 }
 
-bool StringParamDesc::TrySetConst(void* param, const wchar_t* value, size_t valueLen) const
+bool StringParamDesc::TrySetConst(void* param, const Char_t* value, size_t valueLen) const
 {
 	if(!CanWrite())
 		return false;
@@ -1224,7 +1911,10 @@ bool StringParamDesc::TrySetConst(void* param, const wchar_t* value, size_t valu
 		AccessAsParam(param)->SetConst(value, valueLen);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, std::wstring(value, value + valueLen));
+		{
+			String_t str(value, value + valueLen);
+			return Accessor.SetFunc ? Accessor.Set(param, str) : SetFunc(param, str);
+		}
 		break;
 	default:
 		assert(0);
@@ -1232,20 +1922,20 @@ bool StringParamDesc::TrySetConst(void* param, const wchar_t* value, size_t valu
 	return true;
 }
 
-void StringParamDesc::SetConst(void* param, const wchar_t* value, size_t valueLen) const
+void StringParamDesc::SetConst(void* param, const Char_t* value, size_t valueLen) const
 {
 	if(!TrySetConst(param, value, valueLen))
 		throw common::Error(ERR_MSG_CANNOT_SET_VALUE, __TFILE__, __LINE__);
 }
 
-bool StringParamDesc::TrySetConst(void* param, const wchar_t* value) const
+bool StringParamDesc::TrySetConst(void* param, const Char_t* value) const
 {
-    return TrySetConst(param, value, wcslen(value));
+    return TrySetConst(param, value, StrLen(value));
 }
 
-void StringParamDesc::SetConst(void* param, const wchar_t* value) const
+void StringParamDesc::SetConst(void* param, const Char_t* value) const
 {
-    SetConst(param, value, wcslen(value));
+    SetConst(param, value, StrLen(value));
 }
 
 void StringParamDesc::Copy(void* dstParam, const void* srcParam) const
@@ -1273,14 +1963,27 @@ void StringParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool StringParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool StringParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
-	return TryGetConst(out, srcParam);
+	// Stored value is appended directly, without temporary copy.
+	if(GetStorage() != STORAGE::FUNCTION && IsConst(srcParam))
+	{
+		out += *AccessConst(srcParam);
+		return true;
+	}
+	Value_t value;
+	if(TryGetConst(value, srcParam))
+	{
+		out += value;
+		return true;
+	}
+	else
+		return false;
 }
 
-bool StringParamDesc::Parse(void* dstParam, const wchar_t* src) const
+bool StringParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
-	return TrySetConst(dstParam, src);
+	return TrySetConst(dstParam, src, srcLen);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1330,7 +2033,7 @@ bool GameTimeParamDesc::TryGetConst(Value_t& outValue, const void* param) const
 		ok = AccessAsParam(param)->TryGetConst(outValue);
 		break;
 	case STORAGE::FUNCTION:
-		ok = GetFunc(outValue, param);
+		ok = Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 		break;
 	default:
 		assert(0);
@@ -1366,7 +2069,7 @@ bool GameTimeParamDesc::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -1400,22 +2103,22 @@ void GameTimeParamDesc::Copy(void* dstParam, const void* srcParam) const
 	}
 }
 
-bool GameTimeParamDesc::ToString(std::wstring& out, const void* srcParam) const
+bool GameTimeParamDesc::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
 	{
-		GameTimeToFriendlyStr(out, value);
+		AppendGameTimeToFriendlyStr(out, value);
 		return true;
 	}
 	else
 		return false;
 }
 
-bool GameTimeParamDesc::Parse(void* dstParam, const wchar_t* src) const
+bool GameTimeParamDesc::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
 	Value_t value;
-	if(FriendlyStrToGameTime(value, src))
+	if(FriendlyStrToGameTime(value, src, srcLen))
 		return TrySetConst(dstParam, value);
 	else
 		return false;
@@ -1498,7 +2201,7 @@ bool VecParamDesc<Vec_t>::TryGetConst(Value_t& outValue, const void* param) cons
 		ok = AccessAsParam(param)->TryGetConst(outValue);
 		break;
 	case STORAGE::FUNCTION:
-		ok = GetFunc(outValue, param);
+		ok = Accessor.GetFunc ? Accessor.Get(outValue, param) : GetFunc(outValue, param);
 		break;
 	default:
 		assert(0);
@@ -1533,7 +2236,7 @@ bool VecParamDesc<Vec_t>::TrySetConst(void* param, Value_t value) const
 		AccessAsParam(param)->SetConst(value);
 		break;
 	case STORAGE::FUNCTION:
-		return SetFunc(param, value);
+		return Accessor.SetFunc ? Accessor.Set(param, value) : SetFunc(param, value);
 		break;
 	default:
 		assert(0);
@@ -1575,12 +2278,19 @@ void VecParamDesc<Vec_t>::Copy(void* dstParam, const void* srcParam) const
 }
 
 template<typename Vec_t>
-bool VecParamDesc<Vec_t>::ToString(std::wstring& out, const void* srcParam) const
+bool VecParamDesc<Vec_t>::AppendToString(String_t& out, const void* srcParam) const
 {
 	Value_t value;
 	if(TryGetConst(value, srcParam))
 	{
-		SthToStr<Value_t>(&out, value);
+		// Same syntax as SthToStr: components separated with ','.
+		const float* components = &value.x;
+		for(size_t i = 0; i < sizeof(Value_t) / sizeof(float); ++i)
+		{
+			if(i > 0)
+				out += RS2_TEXT(',');
+			AppendFloat(out, components[i]);
+		}
 		return true;
 	}
 	else
@@ -1588,13 +2298,26 @@ bool VecParamDesc<Vec_t>::ToString(std::wstring& out, const void* srcParam) cons
 }
 
 template<typename Vec_t>
-bool VecParamDesc<Vec_t>::Parse(void* dstParam, const wchar_t* src) const
+bool VecParamDesc<Vec_t>::Parse(void* dstParam, const Char_t* src, size_t srcLen) const
 {
+	const size_t componentCount = sizeof(Value_t) / sizeof(float);
+	const Char_t* const srcEnd = src + srcLen;
 	Value_t value;
-	if(StrToSth<Value_t>(&value, src))
-		return TrySetConst(dstParam, value);
-	else
-		return false;
+	float* components = &value.x;
+	const Char_t* componentBeg = src;
+	for(size_t i = 0; i < componentCount; ++i)
+	{
+		const Char_t* componentEnd = componentBeg;
+		while(componentEnd < srcEnd && *componentEnd != RS2_TEXT(','))
+			++componentEnd;
+		// Separator is required between components and not allowed after the last one.
+		if((componentEnd < srcEnd) != (i + 1 < componentCount))
+			return false;
+		if(!CharsToFloat(components[i], componentBeg, componentEnd))
+			return false;
+		componentBeg = componentEnd + 1;
+	}
+	return TrySetConst(dstParam, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1609,90 +2332,243 @@ This function parses following syntax (and combinations):
 
 It uses following smart algorithm:
 
-In any moment we are either pointing at object (currObj and currStructDesc !=
-null) or at parameter (outParam and outParamDesc != null).
+In any moment we are either pointing at object (currStructDesc != null) or at
+parameter (paramDesc != null). Offset of either of them from the beginning of
+the root object is accumulated in offset.
 
 ParamName - Enters parameter of current object.
 \ - Enters object of current parameter.
 [ElementIndex] - Enters element parameter of current parameter.
 */
-bool FindObjParamByPath(
-	void*& outParam, const ParamDesc*& outParamDesc,
-	void* obj, const StructDesc& structDesc,
-	const wchar_t* path, bool caseSensitive)
+ParamPath CompilePath(const StructDesc& structDesc, const Char_t* path, bool caseSensitive)
 {
-	void* currObj = obj;
 	const StructDesc* currStructDesc = &structDesc;
-	outParam = nullptr;
-	outParamDesc = nullptr;
-	wstring pathStr{path};
-	size_t pathIndex = 0;
-	while(pathIndex < pathStr.length())
+	const ParamDesc* paramDesc = nullptr;
+	size_t offset = 0;
+	const Char_t* p = path;
+	while(*p != RS2_TEXT('\0'))
 	{
 		// [ElementIndex]
-		if(pathStr[pathIndex] == L'[')
+		if(*p == RS2_TEXT('['))
 		{
-			if(outParam == nullptr)
-				return false;
-			if(typeid(FixedSizeArrayParamDesc) != typeid(*outParamDesc))
-				return false;
-			const FixedSizeArrayParamDesc* fixedSizeArrayParamDesc = (const FixedSizeArrayParamDesc*)outParamDesc;
-			size_t closingBracketIndex = pathStr.find(L']', pathIndex + 1);
-			if(closingBracketIndex == wstring::npos)
-				return false;
-			wstring indexStr{pathStr, pathIndex + 1, closingBracketIndex - pathIndex - 1};
+			if(paramDesc == nullptr || paramDesc->GetType() != PARAM_TYPE::FIXED_SIZE_ARRAY)
+				return ParamPath();
+			const FixedSizeArrayParamDesc* fixedSizeArrayParamDesc = (const FixedSizeArrayParamDesc*)paramDesc;
+			++p;
+			if(*p < RS2_TEXT('0') || *p > RS2_TEXT('9'))
+				return ParamPath();
 			size_t elementIndex = 0;
-			if(common::StrToUint(&elementIndex, indexStr) != 0)
-				return false;
-			if(elementIndex >= fixedSizeArrayParamDesc->GetCount())
-				return false;
-			outParam = fixedSizeArrayParamDesc->AccessElement(outParam, elementIndex);
-			outParamDesc = fixedSizeArrayParamDesc->GetElementParamDesc();
-			pathIndex = closingBracketIndex + 1;
+			const size_t elementCount = fixedSizeArrayParamDesc->GetCount();
+			for(; *p >= RS2_TEXT('0') && *p <= RS2_TEXT('9'); ++p)
+			{
+				elementIndex = elementIndex * 10 + (size_t)(*p - RS2_TEXT('0'));
+				if(elementIndex >= elementCount)
+					return ParamPath();
+			}
+			if(*p != RS2_TEXT(']'))
+				return ParamPath();
+			++p;
+			paramDesc = fixedSizeArrayParamDesc->GetElementParamDesc();
+			offset += elementIndex * paramDesc->GetParamSize();
 		}
-		else if(pathStr[pathIndex] == L'\\')
+		else if(*p == RS2_TEXT('\\'))
 		{
-			if(outParam == nullptr)
-				return false;
-			if(typeid(StructParamDesc) != typeid(*outParamDesc))
-				return false;
-			const StructParamDesc* structParamDesc = (const StructParamDesc*)outParamDesc;
-			currObj = outParam;
-			currStructDesc = structParamDesc->GetStructDesc();
-			outParam = nullptr;
-			outParamDesc = nullptr;
-			++pathIndex;
+			if(paramDesc == nullptr || paramDesc->GetType() != PARAM_TYPE::STRUCT)
+				return ParamPath();
+			currStructDesc = ((const StructParamDesc*)paramDesc)->GetStructDesc();
+			paramDesc = nullptr;
+			++p;
 		}
 		// ParamName
 		else
 		{
-			if(currObj == nullptr)
-				return false;
-			size_t endIndex = pathStr.find_first_of(L"\\[", pathIndex);
-			wstring paramName = endIndex == wstring::npos ?
-				pathStr.substr(pathIndex) :
-				pathStr.substr(pathIndex, endIndex);
-            size_t paramIndex;
-            for(;;)
-            {
-			    paramIndex = currStructDesc->Find(paramName.c_str(), caseSensitive);
-			    if(paramIndex != (size_t)-1)
-                    break;
-                else
-                {
-                    currStructDesc = currStructDesc->GetBaseStructDesc();
-                    if(currStructDesc == nullptr)
-				        return false;
-                }
-            }
-			outParamDesc = currStructDesc->GetParamDesc(paramIndex);
-			outParam = currStructDesc->AccessRawParam(currObj, paramIndex);
-			currObj = nullptr;
+			if(currStructDesc == nullptr)
+				return ParamPath();
+			const Char_t* nameEnd = p;
+			while(*nameEnd != RS2_TEXT('\0') && *nameEnd != RS2_TEXT('\\') && *nameEnd != RS2_TEXT('['))
+				++nameEnd;
+			size_t paramIndex;
+			if(!currStructDesc->FindInherited(currStructDesc, paramIndex, p, nameEnd - p, caseSensitive))
+				return ParamPath();
+			paramDesc = currStructDesc->GetParamDesc(paramIndex);
+			offset += currStructDesc->Offsets[paramIndex];
 			currStructDesc = nullptr;
-			pathIndex = endIndex;
+			p = nameEnd;
+		}
+	}
+	if(paramDesc == nullptr)
+		return ParamPath();
+	return ParamPath(&structDesc, paramDesc, offset);
+}
+
+bool FindObjParamByPath(
+	void*& outParam, const ParamDesc*& outParamDesc,
+	void* obj, const StructDesc& structDesc,
+	const Char_t* path, bool caseSensitive)
+{
+	ParamPath paramPath = CompilePath(structDesc, path, caseSensitive);
+	if(!paramPath.IsValid())
+	{
+		outParam = nullptr;
+		outParamDesc = nullptr;
+		return false;
+	}
+	outParam = paramPath.Access(obj);
+	outParamDesc = paramPath.GetParamDesc();
+	return true;
+}
+
+// If baseParam is null, compares with default value.
+class ParamEqualsVisitor
+{
+public:
+	ParamEqualsVisitor(const void* param, const void* baseParam) : m_Param(param), m_BaseParam(baseParam) { }
+
+	bool operator()(const StructParamDesc& paramDesc) const
+	{
+		const LayoutPlan& plan = paramDesc.GetStructDesc()->GetLayoutPlan();
+		for(size_t i = 0, count = plan.TopLevelEntries.size(); i < count; ++i)
+		{
+			const LayoutEntry& entry = plan.Entries[plan.TopLevelEntries[i]];
+			if(!VisitParamDesc(*entry.Desc, ParamEqualsVisitor(Offset(m_Param, entry.Offset), Offset(m_BaseParam, entry.Offset))))
+				return false;
+		}
+		return true;
+	}
+	bool operator()(const FixedSizeArrayParamDesc& paramDesc) const
+	{
+		const ParamDesc& elementParamDesc = *paramDesc.GetElementParamDesc();
+		const size_t elementSize = elementParamDesc.GetParamSize();
+		for(size_t i = 0, count = paramDesc.GetCount(); i < count; ++i)
+		{
+			if(!VisitParamDesc(elementParamDesc, ParamEqualsVisitor(Offset(m_Param, i * elementSize), Offset(m_BaseParam, i * elementSize))))
+				return false;
 		}
+		return true;
+	}
+	template<typename ParamDesc_t>
+	bool operator()(const ParamDesc_t& paramDesc) const
+	{
+		typename ParamDesc_t::Value_t value;
+		if(!paramDesc.TryGetConst(value, m_Param))
+			return true;
+		if(m_BaseParam == nullptr)
+			return value == paramDesc.DefaultValue;
+		typename ParamDesc_t::Value_t baseValue;
+		if(!paramDesc.TryGetConst(baseValue, m_BaseParam))
+			return true;
+		return value == baseValue;
 	}
-	return outParam != nullptr;
+
+private:
+	const void* m_Param;
+	const void* m_BaseParam;
+
+	static const void* Offset(const void* p, size_t offset) { return p ? (const char*)p + offset : nullptr; }
+};
+
+bool ParamEquals(const void* lhsParam, const void* rhsParam, const ParamDesc& paramDesc)
+{
+	assert(lhsParam && rhsParam);
+	return VisitParamDesc(paramDesc, ParamEqualsVisitor(lhsParam, rhsParam));
+}
+
+bool ParamIsDefault(const void* param, const ParamDesc& paramDesc)
+{
+	return VisitParamDesc(paramDesc, ParamEqualsVisitor(param, nullptr));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class TypeRegistry
+
+void TypeRegistry::RegisterStruct(const StructDesc& structDesc)
+{
+	const Char_t* name = structDesc.GetName();
+	const size_t nameLen = StrLen(name);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if(m_StructIndex.Find(name, nameLen, true) != NameIndex::INVALID_VALUE)
+		throw common::Error(String_t(RS2_TEXT("RegScript2 structure already registered: ")) + name, __TFILE__, __LINE__);
+	m_StructIndex.Add(name, nameLen, m_Structs.size());
+	m_Structs.push_back(&structDesc);
+}
+
+void TypeRegistry::RegisterStruct(const StructDesc& structDesc, const std::type_info& type)
+{
+	const Char_t* name = structDesc.GetName();
+	const size_t nameLen = StrLen(name);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if(!m_StructTypeIndex.emplace(std::type_index(type), m_Structs.size()).second)
+		throw common::Error(String_t(RS2_TEXT("RegScript2 structure type already registered: ")) + name, __TFILE__, __LINE__);
+	if(m_StructIndex.Find(name, nameLen, true) == NameIndex::INVALID_VALUE)
+		m_StructIndex.Add(name, nameLen, m_Structs.size());
+	m_Structs.push_back(&structDesc);
+}
+
+void TypeRegistry::RegisterEnum(const EnumDesc& enumDesc)
+{
+	const size_t nameLen = StrLen(enumDesc.Name);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if(m_EnumIndex.Find(enumDesc.Name, nameLen, true) != NameIndex::INVALID_VALUE)
+		throw common::Error(String_t(RS2_TEXT("RegScript2 enum already registered: ")) + enumDesc.Name, __TFILE__, __LINE__);
+	m_EnumIndex.Add(enumDesc.Name, nameLen, m_Enums.size());
+	m_Enums.push_back(&enumDesc);
+}
+
+void TypeRegistry::RegisterEnum(const EnumDesc& enumDesc, const std::type_info& type)
+{
+	const size_t nameLen = StrLen(enumDesc.Name);
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if(!m_EnumTypeIndex.emplace(std::type_index(type), m_Enums.size()).second)
+		throw common::Error(String_t(RS2_TEXT("RegScript2 enum type already registered: ")) + enumDesc.Name, __TFILE__, __LINE__);
+	if(m_EnumIndex.Find(enumDesc.Name, nameLen, true) == NameIndex::INVALID_VALUE)
+		m_EnumIndex.Add(enumDesc.Name, nameLen, m_Enums.size());
+	m_Enums.push_back(&enumDesc);
+}
+
+const StructDesc* TypeRegistry::FindStruct(const Char_t* name, bool caseSensitive) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const size_t index = m_StructIndex.Find(name, caseSensitive);
+	return index != NameIndex::INVALID_VALUE ? m_Structs[index] : nullptr;
+}
+
+const StructDesc* TypeRegistry::FindStruct(const std::type_info& type) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const auto it = m_StructTypeIndex.find(std::type_index(type));
+	return it != m_StructTypeIndex.end() ? m_Structs[it->second] : nullptr;
+}
+
+const EnumDesc* TypeRegistry::FindEnum(const Char_t* name, bool caseSensitive) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const size_t index = m_EnumIndex.Find(name, caseSensitive);
+	return index != NameIndex::INVALID_VALUE ? m_Enums[index] : nullptr;
+}
+
+const EnumDesc* TypeRegistry::FindEnum(const std::type_info& type) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const auto it = m_EnumTypeIndex.find(std::type_index(type));
+	return it != m_EnumTypeIndex.end() ? m_Enums[it->second] : nullptr;
+}
+
+size_t TypeRegistry::GetStructCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Structs.size();
+}
+
+size_t TypeRegistry::GetEnumCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Enums.size();
+}
+
+TypeRegistry& GetTypeRegistry()
+{
+	static TypeRegistry* registry = new TypeRegistry();
+	return *registry;
 }
 
 } // namespace RegScript2
@@ -0,0 +1,1309 @@
+#include "Include/RegScript2_Binary.hpp"
+#include <algorithm>
+
+namespace RegScript2
+{
+
+////////////////////////////////////////////////////////////////////////////////
+// class BinaryWriter
+
+void BinaryWriter::WriteString(const Char_t* str, size_t len)
+{
+	const size_t lenPosition = m_Data.size();
+	Write((uint32_t)len);
+	const size_t charCount = WriteChars(str, len);
+	// UTF-8 string may have different length in UTF-16 code units.
+	if(charCount != len)
+		WriteAt(lenPosition, (uint32_t)charCount);
+}
+
+size_t BinaryWriter::WriteChars(const Char_t* str, size_t len)
+{
+	// wchar_t on Windows is already UTF-16.
+	if(sizeof(Char_t) == sizeof(char16_t))
+	{
+		WriteBytes(str, len * sizeof(Char_t));
+		return len;
+	}
+	m_Utf16Buffer.clear();
+	AppendUtf16(m_Utf16Buffer, str, len);
+	WriteBytes(m_Utf16Buffer.data(), m_Utf16Buffer.length() * sizeof(char16_t));
+	return m_Utf16Buffer.length();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class BinaryReader
+
+// src points to len UTF-16 code units, not necessarily aligned.
+static void CharsToString(String_t& out, const char* src, size_t len)
+{
+	if(sizeof(Char_t) == sizeof(char16_t))
+	{
+		out.resize(len);
+		memcpy(&out[0], src, len * sizeof(Char_t));
+		return;
+	}
+	std::u16string utf16(len, u'\0');
+	memcpy(&utf16[0], src, len * sizeof(char16_t));
+	out.clear();
+#ifdef RS2_UTF8
+	AppendUtf8(out, utf16.data(), len);
+#else
+	AppendWide(out, utf16.data(), len);
+#endif
+}
+
+void BinaryReader::ReadString(String_t& out)
+{
+	uint32_t len = 0;
+	Read(len);
+	CheckRemainingSize((size_t)len * sizeof(uint16_t));
+	CharsToString(out, m_Data + m_Position, len);
+	m_Position += len * sizeof(uint16_t);
+}
+
+void BinaryReader::CheckRemainingSize(size_t size) const
+{
+	if(size > m_Size - m_Position)
+		throw common::Error(RS2_TEXT("RegScript2 binary data is incomplete."), __TFILE__, __LINE__);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Saving
+
+size_t GetBinaryValueSize(PARAM_TYPE type)
+{
+	switch(type)
+	{
+	case PARAM_TYPE::BOOL: return sizeof(uint8_t);
+	case PARAM_TYPE::INT: return sizeof(int32_t);
+	case PARAM_TYPE::UINT: return sizeof(uint32_t);
+	case PARAM_TYPE::ENUM: return sizeof(int32_t);
+	case PARAM_TYPE::FLOAT: return sizeof(float);
+	case PARAM_TYPE::GAMETIME: return sizeof(common::GameTime);
+	case PARAM_TYPE::VEC2: return sizeof(common::VEC2);
+	case PARAM_TYPE::VEC3: return sizeof(common::VEC3);
+	case PARAM_TYPE::VEC4: return sizeof(common::VEC4);
+	default: return 0;
+	}
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const BoolParamDesc& paramDesc)
+{
+	dst.Write((uint8_t)(paramDesc.GetConst(srcParam) ? 1 : 0));
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const IntParamDesc& paramDesc)
+{
+	dst.Write(paramDesc.GetConst(srcParam));
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const UintParamDesc& paramDesc)
+{
+	dst.Write(paramDesc.GetConst(srcParam));
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const EnumParamDesc& paramDesc)
+{
+	dst.Write(paramDesc.GetConst(srcParam));
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const FloatParamDesc& paramDesc)
+{
+	dst.Write(paramDesc.GetConst(srcParam));
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const StringParamDesc& paramDesc)
+{
+	String_t value;
+	paramDesc.GetConst(value, srcParam);
+	dst.WriteString(value.data(), value.length());
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const GameTimeParamDesc& paramDesc)
+{
+	dst.Write(paramDesc.GetConst(srcParam));
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const Vec2ParamDesc& paramDesc)
+{
+	common::VEC2 value;
+	paramDesc.GetConst(value, srcParam);
+	dst.Write(value);
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const Vec3ParamDesc& paramDesc)
+{
+	common::VEC3 value;
+	paramDesc.GetConst(value, srcParam);
+	dst.Write(value);
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const Vec4ParamDesc& paramDesc)
+{
+	common::VEC4 value;
+	paramDesc.GetConst(value, srcParam);
+	dst.Write(value);
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const StructParamDesc& paramDesc)
+{
+	SaveObjToBinary(dst, srcParam, *paramDesc.GetStructDesc());
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const FixedSizeArrayParamDesc& paramDesc)
+{
+	const char* srcElement = (const char*)srcParam;
+	const ParamDesc* elementParamDesc = paramDesc.GetElementParamDesc();
+	const size_t elementSize = elementParamDesc->GetParamSize();
+	for(size_t i = 0, count = paramDesc.GetCount(); i < count; ++i)
+	{
+		SaveParamToBinary(dst, srcElement, *elementParamDesc);
+		srcElement += elementSize;
+	}
+}
+
+void SaveParamToBinary(BinaryWriter& dst, const void* srcParam, const ParamDesc& paramDesc)
+{
+	VisitParamDesc(paramDesc, [&](const auto& typedParamDesc) {
+		SaveParamToBinary(dst, srcParam, typedParamDesc);
+	});
+}
+
+// Saves readable parameters of entries beginIndex..endIndex, including contents of readable structures and arrays.
+static void SaveLayoutEntriesToBinary(BinaryWriter& dst, const char* srcBytes, const std::vector<LayoutEntry>& entries, size_t beginIndex, size_t endIndex)
+{
+	for(size_t i = beginIndex; i <= endIndex; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(!entry.CanRead())
+			i = entry.EndIndex;
+		else if(entry.Kind == LayoutEntry::KIND::PARAM)
+			SaveParamToBinary(dst, srcBytes + entry.Offset, *entry.Desc);
+	}
+}
+
+/*
+Ops of the layout plan used by CopyObj visit all parameters in order, with
+adjacent POD ones merged into ranges, so they are used for serialization as
+well. Structures and arrays that cannot be read or written have single op
+without ops of their contents.
+*/
+void SaveObjToBinary(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc)
+{
+	const LayoutPlan& plan = structDesc.GetLayoutPlan();
+	const char* const srcBytes = (const char*)srcObj;
+	for(const LayoutPlan::Op& op : plan.CopyOps)
+	{
+		if(op.Size)
+			dst.WriteBytes(srcBytes + op.Offset, op.Size);
+		else
+		{
+			const LayoutEntry& entry = plan.Entries[op.EntryIndex];
+			if(!entry.CanRead())
+				continue;
+			if(entry.Kind == LayoutEntry::KIND::PARAM)
+				SaveParamToBinary(dst, srcBytes + entry.Offset, *entry.Desc);
+			else
+				SaveLayoutEntriesToBinary(dst, srcBytes, plan.Entries, op.EntryIndex + 1, entry.EndIndex);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Loading
+
+void LoadParamFromBinary(void* dstParam, const BoolParamDesc& paramDesc, BinaryReader& src)
+{
+	uint8_t value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value != 0);
+}
+
+void LoadParamFromBinary(void* dstParam, const IntParamDesc& paramDesc, BinaryReader& src)
+{
+	int32_t value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const UintParamDesc& paramDesc, BinaryReader& src)
+{
+	uint32_t value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const EnumParamDesc& paramDesc, BinaryReader& src)
+{
+	int32_t value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const FloatParamDesc& paramDesc, BinaryReader& src)
+{
+	float value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const StringParamDesc& paramDesc, BinaryReader& src)
+{
+	String_t value;
+	src.ReadString(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const GameTimeParamDesc& paramDesc, BinaryReader& src)
+{
+	common::GameTime value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const Vec2ParamDesc& paramDesc, BinaryReader& src)
+{
+	common::VEC2 value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const Vec3ParamDesc& paramDesc, BinaryReader& src)
+{
+	common::VEC3 value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const Vec4ParamDesc& paramDesc, BinaryReader& src)
+{
+	common::VEC4 value;
+	src.Read(value);
+	paramDesc.SetConst(dstParam, value);
+}
+
+void LoadParamFromBinary(void* dstParam, const StructParamDesc& paramDesc, BinaryReader& src)
+{
+	LoadObjFromBinary(dstParam, *paramDesc.GetStructDesc(), src);
+}
+
+void LoadParamFromBinary(void* dstParam, const FixedSizeArrayParamDesc& paramDesc, BinaryReader& src)
+{
+	char* dstElement = (char*)dstParam;
+	const ParamDesc* elementParamDesc = paramDesc.GetElementParamDesc();
+	const size_t elementSize = elementParamDesc->GetParamSize();
+	for(size_t i = 0, count = paramDesc.GetCount(); i < count; ++i)
+	{
+		LoadParamFromBinary(dstElement, *elementParamDesc, src);
+		dstElement += elementSize;
+	}
+}
+
+void LoadParamFromBinary(void* dstParam, const ParamDesc& paramDesc, BinaryReader& src)
+{
+	VisitParamDesc(paramDesc, [&](const auto& typedParamDesc) {
+		LoadParamFromBinary(dstParam, typedParamDesc, src);
+	});
+}
+
+static void SkipBinaryValue(BinaryReader& src, const ParamDesc& paramDesc)
+{
+	if(paramDesc.GetType() == PARAM_TYPE::STRING)
+	{
+		uint32_t len = 0;
+		src.Read(len);
+		src.Skip((size_t)len * sizeof(uint16_t));
+	}
+	else
+		src.Skip(GetBinaryValueSize(paramDesc.GetType()));
+}
+
+// Skips values saved by SaveLayoutEntriesToBinary.
+static void SkipLayoutEntriesInBinary(BinaryReader& src, const std::vector<LayoutEntry>& entries, size_t beginIndex, size_t endIndex)
+{
+	for(size_t i = beginIndex; i <= endIndex; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(!entry.CanRead())
+			i = entry.EndIndex;
+		else if(entry.Kind == LayoutEntry::KIND::PARAM)
+			SkipBinaryValue(src, *entry.Desc);
+	}
+}
+
+// Mirror of SaveObjToBinary.
+void LoadObjFromBinary(void* dstObj, const StructDesc& structDesc, BinaryReader& src)
+{
+	const LayoutPlan& plan = structDesc.GetLayoutPlan();
+	char* const dstBytes = (char*)dstObj;
+	for(const LayoutPlan::Op& op : plan.CopyOps)
+	{
+		if(op.Size)
+			src.ReadBytes(dstBytes + op.Offset, op.Size);
+		else
+		{
+			const LayoutEntry& entry = plan.Entries[op.EntryIndex];
+			if(!entry.CanRead())
+				continue;
+			if(!entry.CanWrite())
+				SkipLayoutEntriesInBinary(src, plan.Entries, op.EntryIndex, entry.EndIndex);
+			else
+				LoadParamFromBinary(dstBytes + entry.Offset, *entry.Desc, src);
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Chunked format
+
+// "RS2C"
+static const uint32_t CHUNKED_BINARY_MAGIC = 0x43325352;
+
+// Writes chunk header with size to be filled by EndChunk. Returns position of the size.
+static size_t BeginChunk(BinaryWriter& dst, uint32_t nameHash, PARAM_TYPE type)
+{
+	dst.Write(nameHash);
+	dst.Write((uint8_t)type);
+	const size_t sizePosition = dst.GetSize();
+	dst.Write((uint32_t)0);
+	return sizePosition;
+}
+
+static void EndChunk(BinaryWriter& dst, size_t sizePosition)
+{
+	dst.WriteAt(sizePosition, (uint32_t)(dst.GetSize() - sizePosition - sizeof(uint32_t)));
+}
+
+// Name hashes are chunk IDs, so two parameters with equal hash would be loaded from the same chunk.
+static void CheckChunkedStructDesc(const StructDesc& structDesc)
+{
+	if(structDesc.HasNameHashCollision())
+	{
+		throw common::Error(
+			String_t(RS2_TEXT("RegScript2 structure has parameters with colliding name hashes, so it cannot use chunked binary format: ")) + structDesc.GetName(),
+			__TFILE__, __LINE__);
+	}
+}
+
+static void SaveChunkedStruct(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc);
+
+static void SaveChunkedParam(BinaryWriter& dst, const void* srcParam, const ParamDesc& paramDesc)
+{
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::STRUCT:
+		{
+			const StructDesc& structDesc = *((const StructParamDesc&)paramDesc).GetStructDesc();
+			CheckChunkedStructDesc(structDesc);
+			SaveChunkedStruct(dst, srcParam, structDesc);
+		}
+		break;
+	case PARAM_TYPE::FIXED_SIZE_ARRAY:
+		{
+			const FixedSizeArrayParamDesc& arrayParamDesc = (const FixedSizeArrayParamDesc&)paramDesc;
+			const ParamDesc* elementParamDesc = arrayParamDesc.GetElementParamDesc();
+			const size_t elementSize = elementParamDesc->GetParamSize();
+			const char* srcElement = (const char*)srcParam;
+			for(size_t i = 0, count = arrayParamDesc.GetCount(); i < count; ++i)
+			{
+				const size_t sizePosition = BeginChunk(dst, 0, elementParamDesc->GetType());
+				SaveChunkedParam(dst, srcElement, *elementParamDesc);
+				EndChunk(dst, sizePosition);
+				srcElement += elementSize;
+			}
+		}
+		break;
+	default:
+		SaveParamToBinary(dst, srcParam, paramDesc);
+	}
+}
+
+static void SaveChunkedStruct(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc)
+{
+	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
+	if(baseStructDesc)
+		SaveChunkedStruct(dst, srcObj, *baseStructDesc);
+
+	for(size_t i = 0, count = structDesc.Params.size(); i < count; ++i)
+	{
+		const ParamDesc& paramDesc = *structDesc.Params[i];
+		if(!paramDesc.CanRead())
+			continue;
+		const Char_t* name = structDesc.GetInternedName(i);
+		const size_t sizePosition = BeginChunk(dst, HashName(name, StrLen(name)), paramDesc.GetType());
+		SaveChunkedParam(dst, structDesc.AccessRawParam(srcObj, i), paramDesc);
+		EndChunk(dst, sizePosition);
+	}
+}
+
+// Returns true if anything was saved. baseObj can be null.
+static bool SaveChunkedStructDelta(BinaryWriter& dst, const void* srcObj, const void* baseObj, const StructDesc& structDesc)
+{
+	bool anySaved = false;
+	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
+	if(baseStructDesc)
+		anySaved = SaveChunkedStructDelta(dst, srcObj, baseObj, *baseStructDesc);
+
+	for(size_t i = 0, count = structDesc.Params.size(); i < count; ++i)
+	{
+		const ParamDesc& paramDesc = *structDesc.Params[i];
+		if(!paramDesc.CanRead())
+			continue;
+		const void* const srcParam = structDesc.AccessRawParam(srcObj, i);
+		const void* const baseParam = baseObj ? structDesc.AccessRawParam(baseObj, i) : nullptr;
+		const Char_t* name = structDesc.GetInternedName(i);
+		if(paramDesc.GetType() == PARAM_TYPE::STRUCT)
+		{
+			const StructDesc& subStructDesc = *((const StructParamDesc&)paramDesc).GetStructDesc();
+			CheckChunkedStructDesc(subStructDesc);
+			const size_t chunkPosition = dst.GetSize();
+			const size_t sizePosition = BeginChunk(dst, HashName(name, StrLen(name)), PARAM_TYPE::STRUCT);
+			if(SaveChunkedStructDelta(dst, srcParam, baseParam, subStructDesc))
+			{
+				EndChunk(dst, sizePosition);
+				anySaved = true;
+			}
+			else
+				dst.Truncate(chunkPosition);
+			continue;
+		}
+		if(baseParam ? ParamEquals(srcParam, baseParam, paramDesc) : ParamIsDefault(srcParam, paramDesc))
+			continue;
+		const size_t sizePosition = BeginChunk(dst, HashName(name, StrLen(name)), paramDesc.GetType());
+		SaveChunkedParam(dst, srcParam, paramDesc);
+		EndChunk(dst, sizePosition);
+		anySaved = true;
+	}
+	return anySaved;
+}
+
+void WriteChunkedBinaryHeader(BinaryWriter& dst)
+{
+	dst.Write(CHUNKED_BINARY_MAGIC);
+	dst.Write(CHUNKED_BINARY_VERSION);
+}
+
+uint32_t ReadChunkedBinaryHeader(BinaryReader& src)
+{
+	uint32_t magic = 0, version = 0;
+	src.Read(magic);
+	src.Read(version);
+	if(magic != CHUNKED_BINARY_MAGIC)
+		throw common::Error(RS2_TEXT("RegScript2 chunked binary data has invalid header."), __TFILE__, __LINE__);
+	// Version 1 had no type tags in chunk headers.
+	if(version != CHUNKED_BINARY_VERSION)
+		throw common::Error(RS2_TEXT("RegScript2 chunked binary data has unsupported version."), __TFILE__, __LINE__);
+	return version;
+}
+
+void SaveObjToChunkedBinary(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc)
+{
+	CheckChunkedStructDesc(structDesc);
+	const Char_t* name = structDesc.GetName();
+	const size_t sizePosition = BeginChunk(dst, HashName(name, StrLen(name)), PARAM_TYPE::STRUCT);
+	SaveChunkedStruct(dst, srcObj, structDesc);
+	EndChunk(dst, sizePosition);
+}
+
+void SaveObjToChunkedBinaryDelta(BinaryWriter& dst, const void* srcObj, const void* baseObj, const StructDesc& structDesc)
+{
+	CheckChunkedStructDesc(structDesc);
+	const Char_t* name = structDesc.GetName();
+	const size_t sizePosition = BeginChunk(dst, HashName(name, StrLen(name)), PARAM_TYPE::STRUCT);
+	SaveChunkedStructDelta(dst, srcObj, baseObj, structDesc);
+	EndChunk(dst, sizePosition);
+}
+
+// Chunk found in data, with position of its contents.
+struct ChunkRef
+{
+	uint32_t NameHash;
+	PARAM_TYPE Type;
+	size_t Position;
+	size_t Size;
+};
+
+// Reads header of single chunk and skips its contents.
+static ChunkRef ReadChunk(BinaryReader& src)
+{
+	ChunkRef chunk;
+	uint8_t type = 0;
+	uint32_t size = 0;
+	src.Read(chunk.NameHash);
+	src.Read(type);
+	src.Read(size);
+	chunk.Type = (PARAM_TYPE)type;
+	chunk.Position = src.GetPosition();
+	chunk.Size = size;
+	src.Skip(size);
+	return chunk;
+}
+
+// Reads headers of all chunks until the end of src, skipping their contents.
+static void ReadChunkList(std::vector<ChunkRef>& out, BinaryReader& src)
+{
+	while(!src.IsEnd())
+		out.push_back(ReadChunk(src));
+}
+
+static BinaryReader GetChunkReader(const BinaryReader& src, const ChunkRef& chunk)
+{
+	return BinaryReader(src.GetData() + chunk.Position, chunk.Size);
+}
+
+// Size of contents of chunk of simple type is checked, so damaged data is not loaded.
+static bool ChunkedValueIsValid(const ParamDesc& paramDesc, const BinaryReader& src)
+{
+	if(paramDesc.GetType() == PARAM_TYPE::STRING)
+	{
+		uint32_t len = 0;
+		if(src.GetSize() < sizeof(len))
+			return false;
+		memcpy(&len, src.GetData(), sizeof(len));
+		return src.GetSize() == sizeof(len) + (size_t)len * sizeof(uint16_t);
+	}
+	return src.GetSize() == GetBinaryValueSize(paramDesc.GetType());
+}
+
+static bool LoadChunkedStruct(void* dstObj, const StructDesc& structDesc, BinaryReader& src, const STokDocLoadConfig& config);
+
+static bool LoadChunkedParam(void* dstParam, const ParamDesc& paramDesc, const BinaryReader& src, const ChunkRef& chunk, const STokDocLoadConfig& config)
+{
+	BinaryReader chunkReader = GetChunkReader(src, chunk);
+	// Parameter changed type since the data was saved.
+	if(chunk.Type != paramDesc.GetType())
+	{
+		if(IsFlagRequired(config.Flags))
+			throw common::Error(RS2_TEXT("Binary parameter has different type."), __TFILE__, __LINE__);
+		if((config.Flags & TOKDOC_FLAG_DEFAULT))
+			paramDesc.SetToDefault(dstParam);
+		if(config.WarningPrinter)
+			config.WarningPrinter->printf(RS2_TEXT("Binary parameter has different type."));
+		return false;
+	}
+
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::STRUCT:
+		{
+			const StructDesc& structDesc = *((const StructParamDesc&)paramDesc).GetStructDesc();
+			CheckChunkedStructDesc(structDesc);
+			return LoadChunkedStruct(dstParam, structDesc, chunkReader, config);
+		}
+	case PARAM_TYPE::FIXED_SIZE_ARRAY:
+		{
+			const FixedSizeArrayParamDesc& arrayParamDesc = (const FixedSizeArrayParamDesc&)paramDesc;
+			const ParamDesc* elementParamDesc = arrayParamDesc.GetElementParamDesc();
+			const size_t elementSize = elementParamDesc->GetParamSize();
+			const size_t elementCount = arrayParamDesc.GetCount();
+			std::vector<ChunkRef> chunks;
+			ReadChunkList(chunks, chunkReader);
+			bool allOk = true;
+			char* dstElement = (char*)dstParam;
+			size_t index = 0;
+			for(; index < elementCount && index < chunks.size(); ++index)
+			{
+				if(!LoadChunkedParam(dstElement, *elementParamDesc, chunkReader, chunks[index], config))
+					allOk = false;
+				dstElement += elementSize;
+			}
+			if(chunks.size() != elementCount)
+			{
+				if(!IsFlagOptional(config.Flags))
+					throw common::Error(RS2_TEXT("Array parameter has invalid size."), __TFILE__, __LINE__);
+				if((config.Flags & TOKDOC_FLAG_DEFAULT))
+				{
+					for(; index < elementCount; ++index)
+						arrayParamDesc.SetElementToDefault(dstParam, index);
+				}
+				if(config.WarningPrinter)
+					config.WarningPrinter->printf(RS2_TEXT("Binary array has invalid size."));
+				allOk = false;
+			}
+			return allOk;
+		}
+	default:
+		if(ChunkedValueIsValid(paramDesc, chunkReader))
+		{
+			LoadParamFromBinary(dstParam, paramDesc, chunkReader);
+			return true;
+		}
+		if(IsFlagRequired(config.Flags))
+			throw common::Error(RS2_TEXT("Invalid binary parameter value."), __TFILE__, __LINE__);
+		if((config.Flags & TOKDOC_FLAG_DEFAULT))
+			paramDesc.SetToDefault(dstParam);
+		if(config.WarningPrinter)
+			config.WarningPrinter->printf(RS2_TEXT("Invalid binary parameter value."));
+		return false;
+	}
+}
+
+/*
+Loads parameters of structDesc and its base structures from chunks. They are
+searched starting from the one after last found, so when parameters are in the
+same order as when saved, each is found on first try.
+*/
+static bool LoadChunkedStructParams(
+	void* dstObj, const StructDesc& structDesc,
+	const BinaryReader& src, const std::vector<ChunkRef>& chunks, size_t& nextChunkIndex,
+	const STokDocLoadConfig& config)
+{
+	bool allOk = true;
+	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
+	if(baseStructDesc)
+		allOk = LoadChunkedStructParams(dstObj, *baseStructDesc, src, chunks, nextChunkIndex, config);
+
+	const size_t chunkCount = chunks.size();
+	for(size_t paramIndex = 0, paramCount = structDesc.Params.size(); paramIndex < paramCount; ++paramIndex)
+	{
+		const ParamDesc& paramDesc = *structDesc.Params[paramIndex];
+		if(!paramDesc.CanWrite())
+			continue;
+		const Char_t* name = structDesc.GetInternedName(paramIndex);
+		void* const dstParam = structDesc.AccessRawParam(dstObj, paramIndex);
+		const uint32_t nameHash = HashName(name, StrLen(name));
+		size_t chunkIndex = SIZE_MAX;
+		for(size_t i = 0; i < chunkCount; ++i)
+		{
+			const size_t candidateIndex = (nextChunkIndex + i) % chunkCount;
+			if(chunks[candidateIndex].NameHash == nameHash)
+			{
+				chunkIndex = candidateIndex;
+				break;
+			}
+		}
+
+		if(chunkIndex == SIZE_MAX)
+		{
+			if((config.Flags & TOKDOC_FLAG_PATCH))
+				continue;
+			if(!IsFlagOptional(config.Flags))
+				throw common::Error(String_t(RS2_TEXT("RegScript2 binary parameter not found: ")) + name, __TFILE__, __LINE__);
+			if((config.Flags & TOKDOC_FLAG_DEFAULT))
+				paramDesc.SetToDefault(dstParam);
+			if(config.WarningPrinter)
+				config.WarningPrinter->printf(RS2_TEXT("RegScript2 binary parameter \"%s\" not found."), name);
+			allOk = false;
+			continue;
+		}
+
+		nextChunkIndex = chunkIndex + 1;
+		bool ok;
+		ERR_TRY;
+		ok = LoadChunkedParam(dstParam, paramDesc, src, chunks[chunkIndex], config);
+		ERR_CATCH(String_t(RS2_TEXT("RegScript2 binary parameter: ")) + name);
+		if(!ok)
+		{
+			allOk = false;
+			if(config.WarningPrinter)
+				config.WarningPrinter->printf(RS2_TEXT("RegScript2 binary parameter \"%s\" loading failed."), name);
+		}
+	}
+	return allOk;
+}
+
+static bool LoadChunkedStruct(void* dstObj, const StructDesc& structDesc, BinaryReader& src, const STokDocLoadConfig& config)
+{
+	std::vector<ChunkRef> chunks;
+	ReadChunkList(chunks, src);
+	size_t nextChunkIndex = 0;
+	return LoadChunkedStructParams(dstObj, structDesc, src, chunks, nextChunkIndex, config);
+}
+
+bool LoadObjFromChunkedBinary(void* dstObj, const StructDesc& structDesc, BinaryReader& src, const STokDocLoadConfig& config)
+{
+	CheckChunkedStructDesc(structDesc);
+	// Name hash of the object is not checked, so structures can be renamed.
+	const ChunkRef chunk = ReadChunk(src);
+	if(chunk.Type != PARAM_TYPE::STRUCT)
+		throw common::Error(RS2_TEXT("RegScript2 chunked binary data doesn't contain an object."), __TFILE__, __LINE__);
+	BinaryReader objReader = GetChunkReader(src, chunk);
+	return LoadChunkedStruct(dstObj, structDesc, objReader, config);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Quantized format
+
+void BitWriter::WriteBits(uint32_t value, uint32_t bitCount)
+{
+	assert(bitCount <= 32);
+	m_Bits |= ((uint64_t)value & (((uint64_t)1 << bitCount) - 1)) << m_BitCount;
+	m_BitCount += bitCount;
+	while(m_BitCount >= 8)
+	{
+		m_Dst.Write((uint8_t)m_Bits);
+		m_Bits >>= 8;
+		m_BitCount -= 8;
+	}
+}
+
+void BitWriter::WriteVarUint(uint32_t value)
+{
+	while(value >= 0x80)
+	{
+		WriteBits((value & 0x7F) | 0x80, 8);
+		value >>= 7;
+	}
+	WriteBits(value, 8);
+}
+
+void BitWriter::Flush()
+{
+	if(m_BitCount > 0)
+	{
+		m_Dst.Write((uint8_t)m_Bits);
+		m_Bits = 0;
+		m_BitCount = 0;
+	}
+}
+
+uint32_t BitReader::ReadBits(uint32_t bitCount)
+{
+	assert(bitCount <= 32);
+	while(m_BitCount < bitCount)
+	{
+		uint8_t byte;
+		m_Src.Read(byte);
+		m_Bits |= (uint64_t)byte << m_BitCount;
+		m_BitCount += 8;
+	}
+	const uint32_t result = (uint32_t)(m_Bits & (((uint64_t)1 << bitCount) - 1));
+	m_Bits >>= bitCount;
+	m_BitCount -= bitCount;
+	return result;
+}
+
+uint32_t BitReader::ReadVarUint()
+{
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 35; shift += 7)
+	{
+		const uint32_t group = ReadBits(8);
+		result |= (group & 0x7F) << shift;
+		if((group & 0x80) == 0)
+			return result;
+	}
+	throw common::Error(RS2_TEXT("RegScript2 binary varint is too long."), __TFILE__, __LINE__);
+}
+
+uint32_t GetBitCount(uint32_t maxValue)
+{
+	uint32_t bitCount = 0;
+	while(bitCount < 32 && (maxValue >> bitCount) != 0)
+		++bitCount;
+	return bitCount;
+}
+
+// Beyond that, steps are finer than precision of float.
+static const double MAX_QUANTIZED_STEP_COUNT = (double)(1u << 24);
+
+/*
+Number of steps between minValue and maxValue, rounded up. Tolerance prevents
+steps like 0.01f, which is not exact in binary, from adding extra one.
+*/
+static double GetQuantizedStepCount(float minValue, float maxValue, float step)
+{
+	return ceil(((double)maxValue - (double)minValue) / (double)step - 1e-4);
+}
+
+uint32_t GetQuantizedBitCount(float minValue, float maxValue, float step)
+{
+	if(!(step > 0.f) || !(maxValue > minValue) || minValue == -FLT_MAX || maxValue == FLT_MAX ||
+		!std::isfinite(minValue) || !std::isfinite(maxValue))
+	{
+		return 0;
+	}
+	const double stepCount = GetQuantizedStepCount(minValue, maxValue, step);
+	if(stepCount >= MAX_QUANTIZED_STEP_COUNT)
+		return 0;
+	// Values are indices 0..stepCount.
+	uint32_t bitCount = 1;
+	while((double)((uint64_t)1 << bitCount) <= stepCount)
+		++bitCount;
+	return bitCount;
+}
+
+float GetQuantizationMaxError(float minValue, float maxValue, float step)
+{
+	return GetQuantizedBitCount(minValue, maxValue, step) ? step * 0.5f : 0.f;
+}
+
+static void SaveQuantizedFloat(BitWriter& dst, float value, float minValue, float maxValue, float step, uint32_t bitCount)
+{
+	if(bitCount == 0)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(float));
+		dst.WriteBits(bits, 32);
+		return;
+	}
+	// NaN becomes minValue.
+	if(!(value >= minValue))
+		value = minValue;
+	else if(value > maxValue)
+		value = maxValue;
+	double index = floor(((double)value - (double)minValue) / (double)step + 0.5);
+	const double stepCount = GetQuantizedStepCount(minValue, maxValue, step);
+	if(index > stepCount)
+		index = stepCount;
+	dst.WriteBits((uint32_t)index, bitCount);
+}
+
+static float LoadQuantizedFloat(BitReader& src, float minValue, float maxValue, float step, uint32_t bitCount)
+{
+	if(bitCount == 0)
+	{
+		const uint32_t bits = src.ReadBits(32);
+		float value;
+		memcpy(&value, &bits, sizeof(float));
+		return value;
+	}
+	// Last step can be shorter than the others.
+	const double value = (double)minValue + (double)src.ReadBits(bitCount) * (double)step;
+	return value < (double)maxValue ? (float)value : maxValue;
+}
+
+// Default range of IntParamDesc and UintParamDesc means it is not set.
+static inline bool IntHasRange(const IntParamDesc& paramDesc)
+{
+	return paramDesc.MinValue != INT_MIN || paramDesc.MaxValue != INT_MAX;
+}
+static inline bool UintHasRange(const UintParamDesc& paramDesc)
+{
+	return paramDesc.MinValue != 0 || paramDesc.MaxValue != UINT_MAX;
+}
+static inline uint32_t GetIntRangeBitCount(const IntParamDesc& paramDesc)
+{
+	return GetBitCount((uint32_t)paramDesc.MaxValue - (uint32_t)paramDesc.MinValue);
+}
+
+// Parameters of simple types, as kind PARAM of layout entries never refers to a structure or array.
+class QuantizedParamSaver
+{
+public:
+	QuantizedParamSaver(BitWriter& dst, const void* srcParam) : m_Dst(dst), m_SrcParam(srcParam) { }
+
+	void operator()(const BoolParamDesc& paramDesc) const { m_Dst.WriteBits(paramDesc.GetConst(m_SrcParam) ? 1 : 0, 1); }
+	void operator()(const IntParamDesc& paramDesc) const
+	{
+		int32_t value = paramDesc.GetConst(m_SrcParam);
+		if(IntHasRange(paramDesc))
+		{
+			paramDesc.ClampValueToMinMax(value);
+			m_Dst.WriteBits((uint32_t)value - (uint32_t)paramDesc.MinValue, GetIntRangeBitCount(paramDesc));
+		}
+		else
+			m_Dst.WriteVarInt(value);
+	}
+	void operator()(const UintParamDesc& paramDesc) const
+	{
+		uint32_t value = paramDesc.GetConst(m_SrcParam);
+		if(UintHasRange(paramDesc))
+		{
+			paramDesc.ClampValueToMinMax(value);
+			m_Dst.WriteBits(value - paramDesc.MinValue, GetBitCount(paramDesc.MaxValue - paramDesc.MinValue));
+		}
+		else
+			m_Dst.WriteVarUint(value);
+	}
+	void operator()(const EnumParamDesc& paramDesc) const
+	{
+		const int32_t value = paramDesc.GetConst(m_SrcParam);
+		const EnumDesc& enumDesc = *paramDesc.m_EnumDesc;
+		const size_t index = enumDesc.FindItemByValue(value);
+		const uint32_t bitCount = GetBitCount((uint32_t)enumDesc.ItemCount);
+		if(index != EnumDesc::INVALID_INDEX)
+			m_Dst.WriteBits((uint32_t)index, bitCount);
+		else
+		{
+			m_Dst.WriteBits((uint32_t)enumDesc.ItemCount, bitCount);
+			m_Dst.WriteVarInt(value);
+		}
+	}
+	void operator()(const FloatParamDesc& paramDesc) const
+	{
+		SaveQuantizedFloat(m_Dst, paramDesc.GetConst(m_SrcParam),
+			paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step, GetQuantizedBitCount(paramDesc));
+	}
+	void operator()(const StringParamDesc& paramDesc) const
+	{
+		String_t value;
+		paramDesc.GetConst(value, m_SrcParam);
+		std::u16string chars;
+		AppendUtf16(chars, value.data(), value.length());
+		m_Dst.WriteVarUint((uint32_t)chars.length());
+		for(size_t i = 0, count = chars.length(); i < count; ++i)
+			m_Dst.WriteBits((uint16_t)chars[i], 16);
+	}
+	void operator()(const GameTimeParamDesc& paramDesc) const
+	{
+		const common::GameTime value = paramDesc.GetConst(m_SrcParam);
+		static_assert(sizeof(common::GameTime) == sizeof(uint64_t), "Unexpected size of GameTime.");
+		uint64_t bits;
+		memcpy(&bits, &value, sizeof(uint64_t));
+		m_Dst.WriteBits((uint32_t)bits, 32);
+		m_Dst.WriteBits((uint32_t)(bits >> 32), 32);
+	}
+	template<typename Vec_t>
+	void operator()(const VecParamDesc<Vec_t>& paramDesc) const
+	{
+		Vec_t value;
+		paramDesc.GetConst(value, m_SrcParam);
+		const uint32_t bitCount = GetQuantizedBitCount(paramDesc);
+		for(size_t i = 0; i < sizeof(Vec_t) / sizeof(float); ++i)
+			SaveQuantizedFloat(m_Dst, (&value.x)[i], paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step, bitCount);
+	}
+	void operator()(const StructParamDesc& paramDesc) const { assert(0); }
+	void operator()(const FixedSizeArrayParamDesc& paramDesc) const { assert(0); }
+
+private:
+	BitWriter& m_Dst;
+	const void* m_SrcParam;
+};
+
+// If dstParam is null, value is read and discarded.
+class QuantizedParamLoader
+{
+public:
+	QuantizedParamLoader(void* dstParam, BitReader& src) : m_DstParam(dstParam), m_Src(src) { }
+
+	void operator()(const BoolParamDesc& paramDesc) const { Store(paramDesc, m_Src.ReadBits(1) != 0); }
+	void operator()(const IntParamDesc& paramDesc) const
+	{
+		if(IntHasRange(paramDesc))
+			Store(paramDesc, (int32_t)(m_Src.ReadBits(GetIntRangeBitCount(paramDesc)) + (uint32_t)paramDesc.MinValue));
+		else
+			Store(paramDesc, m_Src.ReadVarInt());
+	}
+	void operator()(const UintParamDesc& paramDesc) const
+	{
+		if(UintHasRange(paramDesc))
+			Store(paramDesc, m_Src.ReadBits(GetBitCount(paramDesc.MaxValue - paramDesc.MinValue)) + paramDesc.MinValue);
+		else
+			Store(paramDesc, m_Src.ReadVarUint());
+	}
+	void operator()(const EnumParamDesc& paramDesc) const
+	{
+		const EnumDesc& enumDesc = *paramDesc.m_EnumDesc;
+		const uint32_t index = m_Src.ReadBits(GetBitCount((uint32_t)enumDesc.ItemCount));
+		if(index < enumDesc.ItemCount)
+			Store(paramDesc, enumDesc.GetValue(index));
+		else
+			Store(paramDesc, m_Src.ReadVarInt());
+	}
+	void operator()(const FloatParamDesc& paramDesc) const
+	{
+		Store(paramDesc, LoadQuantizedFloat(m_Src,
+			paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step, GetQuantizedBitCount(paramDesc)));
+	}
+	void operator()(const StringParamDesc& paramDesc) const
+	{
+		std::u16string chars(m_Src.ReadVarUint(), u'\0');
+		for(size_t i = 0, count = chars.length(); i < count; ++i)
+			chars[i] = (char16_t)m_Src.ReadBits(16);
+		String_t value;
+#ifdef RS2_UTF8
+		AppendUtf8(value, chars.data(), chars.length());
+#else
+		AppendWide(value, chars.data(), chars.length());
+#endif
+		Store(paramDesc, value);
+	}
+	void operator()(const GameTimeParamDesc& paramDesc) const
+	{
+		uint64_t bits = m_Src.ReadBits(32);
+		bits |= (uint64_t)m_Src.ReadBits(32) << 32;
+		common::GameTime value;
+		memcpy(&value, &bits, sizeof(uint64_t));
+		Store(paramDesc, value);
+	}
+	template<typename Vec_t>
+	void operator()(const VecParamDesc<Vec_t>& paramDesc) const
+	{
+		Vec_t value;
+		const uint32_t bitCount = GetQuantizedBitCount(paramDesc);
+		for(size_t i = 0; i < sizeof(Vec_t) / sizeof(float); ++i)
+			(&value.x)[i] = LoadQuantizedFloat(m_Src, paramDesc.MinValue, paramDesc.MaxValue, paramDesc.Step, bitCount);
+		Store(paramDesc, value);
+	}
+	void operator()(const StructParamDesc& paramDesc) const { assert(0); }
+	void operator()(const FixedSizeArrayParamDesc& paramDesc) const { assert(0); }
+
+private:
+	void* m_DstParam;
+	BitReader& m_Src;
+
+	template<typename ParamDesc_t, typename Value_t>
+	void Store(const ParamDesc_t& paramDesc, const Value_t& value) const
+	{
+		if(m_DstParam)
+			paramDesc.SetConst(m_DstParam, value);
+	}
+};
+
+void SaveObjToQuantizedBinary(BinaryWriter& dst, const void* srcObj, const StructDesc& structDesc)
+{
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	const char* const srcBytes = (const char*)srcObj;
+	BitWriter bitWriter(dst);
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		// Parameters that cannot be read are not saved, including contents of such structures and arrays.
+		if(!entry.CanRead())
+			i = entry.EndIndex;
+		else if(entry.Kind == LayoutEntry::KIND::PARAM)
+			VisitParamDesc(*entry.Desc, QuantizedParamSaver(bitWriter, srcBytes + entry.Offset));
+	}
+	bitWriter.Flush();
+}
+
+void LoadObjFromQuantizedBinary(void* dstObj, const StructDesc& structDesc, BinaryReader& src)
+{
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	char* const dstBytes = (char*)dstObj;
+	BitReader bitReader(src);
+	// Entries before this index are inside a parameter that cannot be written, so their values are discarded.
+	size_t readOnlyEndIndex = 0;
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(!entry.CanRead())
+		{
+			i = entry.EndIndex;
+			continue;
+		}
+		if(!entry.CanWrite() && i >= readOnlyEndIndex)
+			readOnlyEndIndex = entry.EndIndex + 1;
+		if(entry.Kind == LayoutEntry::KIND::PARAM)
+			VisitParamDesc(*entry.Desc, QuantizedParamLoader(i < readOnlyEndIndex ? nullptr : dstBytes + entry.Offset, bitReader));
+	}
+	bitReader.AlignToByte();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Views
+
+template<typename Value_t>
+static inline void StoreViewValue(char* dst, const Value_t& value)
+{
+	memcpy(dst, &value, sizeof(Value_t));
+}
+
+// Writes value of simple parameter to dst, encoded like in SaveParamToBinary.
+static void SaveViewValue(char* dst, const void* srcParam, const ParamDesc& paramDesc)
+{
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::BOOL:
+		StoreViewValue(dst, (uint8_t)(((const BoolParamDesc&)paramDesc).GetConst(srcParam) ? 1 : 0));
+		break;
+	case PARAM_TYPE::INT:
+		StoreViewValue(dst, ((const IntParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::UINT:
+		StoreViewValue(dst, ((const UintParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::ENUM:
+		StoreViewValue(dst, ((const EnumParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::FLOAT:
+		StoreViewValue(dst, ((const FloatParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::GAMETIME:
+		StoreViewValue(dst, ((const GameTimeParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::VEC2:
+		{
+			common::VEC2 value;
+			((const Vec2ParamDesc&)paramDesc).GetConst(value, srcParam);
+			StoreViewValue(dst, value);
+		}
+		break;
+	case PARAM_TYPE::VEC3:
+		{
+			common::VEC3 value;
+			((const Vec3ParamDesc&)paramDesc).GetConst(value, srcParam);
+			StoreViewValue(dst, value);
+		}
+		break;
+	case PARAM_TYPE::VEC4:
+		{
+			common::VEC4 value;
+			((const Vec4ParamDesc&)paramDesc).GetConst(value, srcParam);
+			StoreViewValue(dst, value);
+		}
+		break;
+	default:
+		assert(0);
+	}
+}
+
+// Strings are stored as offset and length.
+static size_t GetViewValueSize(const ParamDesc& paramDesc)
+{
+	return paramDesc.GetType() == PARAM_TYPE::STRING ?
+		2 * sizeof(uint32_t) :
+		GetBinaryValueSize(paramDesc.GetType());
+}
+
+void SaveObjToView(BinaryWriter& dst, const void* srcObj, const ViewLayout& layout)
+{
+	const std::vector<LayoutEntry>& entries = layout.GetStructDesc().GetLayoutPlan().Entries;
+	const char* const srcBytes = (const char*)srcObj;
+	const size_t objPosition = dst.GetSize();
+	dst.WriteZeros(layout.GetSize());
+	String_t str;
+	// Values are packed in order of entries, same as in ViewLayout.
+	size_t valuePosition = objPosition;
+	// Entries before this index are inside a parameter that cannot be read, so their values are left zero.
+	size_t unreadableEndIndex = 0;
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(!entry.CanRead() && i >= unreadableEndIndex)
+			unreadableEndIndex = entry.EndIndex + 1;
+		if(entry.Kind != LayoutEntry::KIND::PARAM)
+			continue;
+		const size_t valueSize = GetViewValueSize(*entry.Desc);
+		if(i < unreadableEndIndex)
+		{
+			valuePosition += valueSize;
+			continue;
+		}
+		const void* const srcParam = srcBytes + entry.Offset;
+		if(entry.Desc->GetType() == PARAM_TYPE::STRING)
+		{
+			((const StringParamDesc*)entry.Desc)->GetConst(str, srcParam);
+			const uint32_t charsOffset = (uint32_t)(dst.GetSize() - objPosition);
+			const uint32_t strValue[] = { charsOffset, (uint32_t)dst.WriteChars(str.data(), str.length()) };
+			dst.WriteAt(valuePosition, strValue);
+		}
+		else
+		{
+			// Big enough for any simple value.
+			char value[sizeof(common::VEC4)];
+			SaveViewValue(value, srcParam, *entry.Desc);
+			dst.WriteBytesAt(valuePosition, value, valueSize);
+		}
+		valuePosition += valueSize;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class ViewLayout
+
+ViewLayout::ViewLayout(const StructDesc& structDesc) :
+	m_StructDesc(&structDesc),
+	m_Size(0)
+{
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	// Entries before this index are inside a parameter that cannot be read.
+	size_t unreadableEndIndex = 0;
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(entry.Kind == LayoutEntry::KIND::STRUCT_END || entry.Kind == LayoutEntry::KIND::ARRAY_END)
+			continue;
+		if(!entry.CanRead() && i >= unreadableEndIndex)
+			unreadableEndIndex = entry.EndIndex + 1;
+		m_Entries.push_back(Entry{ entry.Offset, m_Size, entry.Desc, i >= unreadableEndIndex });
+		if(entry.Kind == LayoutEntry::KIND::PARAM)
+			m_Size += GetViewValueSize(*entry.Desc);
+	}
+	// Stable, so structure or array comes before its first parameter or element at the same offset.
+	std::stable_sort(m_Entries.begin(), m_Entries.end(), [](const Entry& lhs, const Entry& rhs) {
+		return lhs.ObjOffset < rhs.ObjOffset;
+	});
+}
+
+size_t ViewLayout::FindViewOffset(size_t objOffset, const ParamDesc* paramDesc, bool* outCanRead) const
+{
+	auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), objOffset, [](const Entry& entry, size_t offset) {
+		return entry.ObjOffset < offset;
+	});
+	// Offset in the object and descriptor identify single entry. Only enclosing structures and arrays share the offset.
+	for(; it != m_Entries.end() && it->ObjOffset == objOffset; ++it)
+	{
+		if(it->Desc == paramDesc)
+		{
+			if(outCanRead)
+				*outCanRead = it->CanRead;
+			return it->ViewOffset;
+		}
+	}
+	return SIZE_MAX;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class ConstParamView
+
+template<typename Value_t>
+bool ConstParamView::TryGetValue(Value_t& outValue, PARAM_TYPE type) const
+{
+	if(m_ParamDesc == nullptr || m_ParamDesc->GetType() != type || !m_CanRead || !m_ParamDesc->CanRead())
+		return false;
+	memcpy(&outValue, m_ObjData + m_ViewOffset, sizeof(Value_t));
+	return true;
+}
+
+bool ConstParamView::TryGetConst(bool& outValue) const
+{
+	uint8_t value;
+	if(!TryGetValue(value, PARAM_TYPE::BOOL))
+		return false;
+	outValue = value != 0;
+	return true;
+}
+
+bool ConstParamView::TryGetConst(int32_t& outValue) const
+{
+	return TryGetValue(outValue, PARAM_TYPE::INT) || TryGetValue(outValue, PARAM_TYPE::ENUM);
+}
+
+bool ConstParamView::TryGetConst(uint32_t& outValue) const { return TryGetValue(outValue, PARAM_TYPE::UINT); }
+bool ConstParamView::TryGetConst(float& outValue) const { return TryGetValue(outValue, PARAM_TYPE::FLOAT); }
+bool ConstParamView::TryGetConst(common::GameTime& outValue) const { return TryGetValue(outValue, PARAM_TYPE::GAMETIME); }
+bool ConstParamView::TryGetConst(common::VEC2& outValue) const { return TryGetValue(outValue, PARAM_TYPE::VEC2); }
+bool ConstParamView::TryGetConst(common::VEC3& outValue) const { return TryGetValue(outValue, PARAM_TYPE::VEC3); }
+bool ConstParamView::TryGetConst(common::VEC4& outValue) const { return TryGetValue(outValue, PARAM_TYPE::VEC4); }
+
+bool ConstParamView::TryGetConst(String_t& outValue) const
+{
+	uint32_t strValue[2];
+	if(!TryGetValue(strValue, PARAM_TYPE::STRING))
+		return false;
+	const size_t charsOffset = strValue[0], len = strValue[1];
+	if(charsOffset > m_ObjSize || len > (m_ObjSize - charsOffset) / sizeof(uint16_t))
+		return false;
+	CharsToString(outValue, m_ObjData + charsOffset, len);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class ConstObjView
+
+ConstObjView::ConstObjView(const void* data, size_t size, const ViewLayout& layout) :
+	m_Data((const char*)data),
+	m_Size(size),
+	m_Layout(&layout)
+{
+	if(size < layout.GetSize())
+		throw common::Error(RS2_TEXT("RegScript2 object view data is incomplete."), __TFILE__, __LINE__);
+}
+
+ConstParamView ConstObjView::FindParamByPath(const Char_t* path, bool caseSensitive) const
+{
+	assert(IsValid());
+	// Parameters are found by name with the name index of each structure on the path.
+	const ParamPath paramPath = CompilePath(m_Layout->GetStructDesc(), path, caseSensitive);
+	if(!paramPath.IsValid())
+		return ConstParamView();
+	bool canRead = false;
+	const size_t viewOffset = m_Layout->FindViewOffset(paramPath.GetOffset(), paramPath.GetParamDesc(), &canRead);
+	assert(viewOffset != SIZE_MAX);
+	return ConstParamView(m_Data, m_Size, viewOffset, paramPath.GetParamDesc(), canRead);
+}
+
+} // namespace RegScript2
@@ -4,114 +4,149 @@
 namespace RegScript2
 {
 
-static const wchar_t* const INDENT =
-	L"\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+// Lines are built in a buffer reused between parameters and printed with IPrinter::PrintLine.
 
-static const wchar_t* GetIndent(uint32_t indentLevel)
+static void AppendUnitName(String_t& line, const InternedString& unitName)
 {
-	assert(indentLevel <= 64);
-	return INDENT + (64 - indentLevel);
-}
-	
-static void DebugPrintParamValue(
-	IPrinter& printer,
-	uint32_t indentLevel,
-	const wchar_t* paramName,
-	const wchar_t* valueStr,
-	const wchar_t* unitName)
-{
-	if(!common::StrIsEmpty(unitName))
-		printer.printf(L"%s%s = %s [%s]", GetIndent(indentLevel), paramName, valueStr, unitName);
-	else
-		printer.printf(L"%s%s = %s", GetIndent(indentLevel), paramName, valueStr);
+	if(!unitName.empty())
+	{
+		line += RS2_TEXT(" [");
+		line += unitName.c_str();
+		line += RS2_TEXT(']');
+	}
 }
 
-static void DebugPrintParamDefault(
+// line already contains indentation and parameter name.
+static void DebugPrintParamValue(
 	IPrinter& printer,
+	String_t& line,
 	const void* srcParam,
-	const wchar_t* paramName,
-	const ParamDesc& paramDesc,
-	uint32_t indentLevel)
+	const ParamDesc& paramDesc)
 {
-	wstring valueStr;
-	bool ok = paramDesc.ToString(valueStr, srcParam);
+	line += RS2_TEXT(" = ");
+	bool ok = paramDesc.AppendToString(line, srcParam);
 	assert(ok);
-	DebugPrintParamValue(printer, indentLevel, paramName, valueStr.c_str(), paramDesc.UnitName.c_str());
+	AppendUnitName(line, paramDesc.UnitName);
+	printer.PrintLine(line.data(), line.length());
 }
 
-static void DebugPrintStructParam(
+// line already contains indentation and parameter name.
+static void DebugPrintStructHeader(
 	IPrinter& printer,
-	const void* srcParam,
-	const wchar_t* paramName,
-	const StructParamDesc& paramDesc,
-	uint32_t indentLevel)
+	String_t& line,
+	const ParamDesc& paramDesc)
 {
-	if(!paramDesc.UnitName.empty())
-		printer.printf(L"%s%s: [%s]", GetIndent(indentLevel), paramName, paramDesc.UnitName.c_str());
-	else
-		printer.printf(L"%s%s:", GetIndent(indentLevel), paramName);
-
-	DebugPrintObj(printer, srcParam, *paramDesc.GetStructDesc(), indentLevel + 1);
+	line += RS2_TEXT(':');
+	AppendUnitName(line, paramDesc.UnitName);
+	printer.PrintLine(line.data(), line.length());
 }
 
-static void DebugPrintFixedSizeArrayParam(
-	IPrinter& printer,
-	const void* srcParam,
-	const wchar_t* paramName,
-	const FixedSizeArrayParamDesc& paramDesc,
-	uint32_t indentLevel)
+static void DebugPrintObj(IPrinter& printer, String_t& line, const void* srcObj, const StructDesc& structDesc, uint32_t indentLevel);
+
+// name holds the full name of the current parameter. Array elements append their index to it
+// and truncate it back, so nested arrays share one buffer.
+struct DebugPrintParamVisitor
 {
-	size_t index = 0;
-	const char* srcElement = (const char*)srcParam;
-	const size_t elementCount = paramDesc.GetCount();
-	const ParamDesc* elementParamDesc = paramDesc.GetElementParamDesc();
-	const size_t elementSize = elementParamDesc->GetParamSize();
-	wstring elementName;
-	for(size_t i = 0; i < elementCount; ++i)
+	IPrinter& Printer;
+	String_t& Line;
+	String_t& Name;
+	const void* SrcParam;
+	uint32_t IndentLevel;
+
+	template<typename ParamDesc_t>
+	void operator()(const ParamDesc_t& paramDesc) const
 	{
-		Format(elementName, L"%s[%u]", paramName, i);
-		DebugPrintParam(printer, srcElement, elementName.c_str(), *elementParamDesc, indentLevel);
-		srcElement += elementSize;
+		Line.assign(IndentLevel, RS2_TEXT('\t'));
+		Line += Name;
+		DebugPrintParamValue(Printer, Line, SrcParam, paramDesc);
 	}
-}
-
-// ADD NEW PARAMETER TYPES HERE.
+	void operator()(const StructParamDesc& paramDesc) const
+	{
+		Line.assign(IndentLevel, RS2_TEXT('\t'));
+		Line += Name;
+		DebugPrintStructHeader(Printer, Line, paramDesc);
+		DebugPrintObj(Printer, Line, SrcParam, *paramDesc.GetStructDesc(), IndentLevel + 1);
+	}
+	void operator()(const FixedSizeArrayParamDesc& paramDesc) const
+	{
+		const char* srcElement = (const char*)SrcParam;
+		const size_t elementCount = paramDesc.GetCount();
+		const ParamDesc* elementParamDesc = paramDesc.GetElementParamDesc();
+		const size_t elementSize = elementParamDesc->GetParamSize();
+		const size_t nameLen = Name.length();
+		for(size_t i = 0; i < elementCount; ++i)
+		{
+			Name.resize(nameLen);
+			Name += RS2_TEXT('[');
+			AppendUint(Name, (uint32_t)i);
+			Name += RS2_TEXT(']');
+			VisitParamDesc(*elementParamDesc, DebugPrintParamVisitor{Printer, Line, Name, srcElement, IndentLevel});
+			srcElement += elementSize;
+		}
+		Name.resize(nameLen);
+	}
+};
 
-void DebugPrintParam(IPrinter& printer, const void* srcParam, const wchar_t* paramName, const ParamDesc& paramDesc, uint32_t indentLevel)
+void DebugPrintParam(IPrinter& printer, const void* srcParam, const Char_t* paramName, const ParamDesc& paramDesc, uint32_t indentLevel)
 {
-	if(typeid(BoolParamDesc) == typeid(paramDesc) ||
-		typeid(IntParamDesc) == typeid(paramDesc) ||
-		typeid(UintParamDesc) == typeid(paramDesc) ||
-		typeid(FloatParamDesc) == typeid(paramDesc) ||
-		typeid(StringParamDesc) == typeid(paramDesc) ||
-		typeid(GameTimeParamDesc) == typeid(paramDesc) ||
-		typeid(Vec2ParamDesc) == typeid(paramDesc) ||
-		typeid(Vec3ParamDesc) == typeid(paramDesc) ||
-		typeid(Vec4ParamDesc) == typeid(paramDesc))
-		DebugPrintParamDefault(printer, srcParam, paramName, paramDesc, indentLevel);
-	else if(typeid(StructParamDesc) == typeid(paramDesc))
-		DebugPrintStructParam(printer, srcParam, paramName, (const StructParamDesc&)paramDesc, indentLevel);
-	else if(typeid(FixedSizeArrayParamDesc) == typeid(paramDesc))
-		DebugPrintFixedSizeArrayParam(printer, srcParam, paramName, (const FixedSizeArrayParamDesc&)paramDesc, indentLevel);
-	// ADD NEW PARAMETER TYPES HERE.
-	else
-		assert(!"Unsupported parameter type.");
+	String_t line;
+	String_t name = paramName;
+	VisitParamDesc(paramDesc, DebugPrintParamVisitor{printer, line, name, srcParam, indentLevel});
 }
 
 void DebugPrintObj(IPrinter& printer, const void* srcObj, const StructDesc& structDesc, uint32_t indentLevel)
 {
-	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
-	if(baseStructDesc)
-		DebugPrintObj(printer, srcObj, *baseStructDesc, indentLevel);
+	String_t line;
+	DebugPrintObj(printer, line, srcObj, structDesc, indentLevel);
+}
 
-	for(size_t i = 0, count = structDesc.Params.size(); i < count; ++i)
+static void DebugPrintObj(IPrinter& printer, String_t& line, const void* srcObj, const StructDesc& structDesc, uint32_t indentLevel)
+{
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	const char* const srcBytes = (const char*)srcObj;
+	// Names of struct and array parameters currently open, innermost at parentCount - 1.
+	// Strings are not removed, so their memory is reused.
+	std::vector<String_t> parentNames;
+	size_t parentCount = 0;
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
 	{
-		DebugPrintParam(
-			printer,
-			structDesc.AccessRawParam(srcObj, i),
-			structDesc.Names[i].c_str(),
-			*structDesc.Params[i],
-			indentLevel);
+		const LayoutEntry& entry = entries[i];
+		if(entry.Kind == LayoutEntry::KIND::STRUCT_END || entry.Kind == LayoutEntry::KIND::ARRAY_END)
+		{
+			--parentCount;
+			continue;
+		}
+
+		line.assign(indentLevel + entry.Depth, RS2_TEXT('\t'));
+		const size_t nameOffset = line.length();
+		if(entry.Name)
+			line += entry.Name;
+		else
+		{
+			line += parentNames[parentCount - 1];
+			line += RS2_TEXT('[');
+			AppendUint(line, (uint32_t)entry.ElementIndex);
+			line += RS2_TEXT(']');
+		}
+
+		if(entry.Kind != LayoutEntry::KIND::PARAM)
+		{
+			if(parentCount == parentNames.size())
+				parentNames.emplace_back();
+			parentNames[parentCount++].assign(line, nameOffset, String_t::npos);
+		}
+
+		switch(entry.Kind)
+		{
+		case LayoutEntry::KIND::PARAM:
+			DebugPrintParamValue(printer, line, srcBytes + entry.Offset, *entry.Desc);
+			break;
+		case LayoutEntry::KIND::STRUCT_BEGIN:
+			DebugPrintStructHeader(printer, line, *entry.Desc);
+			break;
+		default:
+			break;
+		}
 	}
 }
 
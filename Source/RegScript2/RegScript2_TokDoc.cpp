@@ -1,64 +1,145 @@
 #include "Include/RegScript2_TokDoc.hpp"
+#include <thread>
+#include <atomic>
 
 namespace RegScript2
 {
 
+void SaveFloatsToTokDoc(common::tokdoc::Node& dstNode, const float* values, size_t count)
+{
+	// Shortest representation that loads back to exactly the same value.
+	Char_t buf[FLOAT_TO_CHARS_MAX_LEN];
+	if(count == 1)
+	{
+		dstNode.Value.assign(buf, FloatToChars(buf, values[0]));
+		return;
+	}
+	dstNode.Clear();
+	for(size_t i = 0; i < count; ++i)
+	{
+		common::tokdoc::Node* componentNode = new common::tokdoc::Node();
+		dstNode.LinkChildAtEnd(componentNode);
+		componentNode->Value.assign(buf, FloatToChars(buf, values[i]));
+	}
+}
+
+static bool LoadFloatFromTokDocValue(float& outValue, const common::tokdoc::Node& srcNode)
+{
+	if(srcNode.HasChildren())
+		return false;
+	const Char_t* const value = srcNode.Value.c_str();
+	return CharsToFloat(outValue, value, value + srcNode.Value.length());
+}
+
+bool LoadFloatsFromTokDoc(float* outValues, size_t count, const common::tokdoc::Node& srcNode)
+{
+	if(count == 1)
+		return LoadFloatFromTokDocValue(outValues[0], srcNode);
+	size_t index = 0;
+	for(const common::tokdoc::Node* componentNode = srcNode.GetFirstChild(); componentNode != nullptr; componentNode = componentNode->GetNextSibling())
+	{
+		if(index == count || !LoadFloatFromTokDocValue(outValues[index], *componentNode))
+			return false;
+		++index;
+	}
+	return index == count;
+}
+
+void AppendTokDocValue(String_t& out, bool value)
+{
+	out += value ? RS2_TEXT("true") : RS2_TEXT("false");
+}
+
+void AppendTokDocValue(String_t& out, int32_t value)
+{
+	AppendInt(out, value);
+}
+
+void AppendTokDocValue(String_t& out, uint32_t value)
+{
+	AppendUint(out, value);
+}
+
+void AppendTokDocValue(String_t& out, common::GameTime value)
+{
+	const double seconds = value.ToSeconds_d();
+	const size_t len = out.length();
+	::AppendFormat(out, RS2_TEXT("%.15g"), seconds);
+	double loadedSeconds = 0.;
+	if(!CharsToDouble(loadedSeconds, out.data() + len, out.data() + out.length()) || loadedSeconds != seconds)
+	{
+		out.resize(len);
+		::AppendFormat(out, RS2_TEXT("%.17g"), seconds);
+	}
+}
+
+static void AppendTokDocValue(String_t& out, const void* srcParam, const StringParamDesc& paramDesc)
+{
+	// Appended without temporary copy of the string.
+	if(!paramDesc.AppendToString(out, srcParam))
+		throw common::Error(ERR_MSG_VALUE_NOT_CONST, __TFILE__, __LINE__);
+}
+
+static void AppendTokDocValue(String_t& out, const void* srcParam, const EnumParamDesc& paramDesc)
+{
+	paramDesc.m_EnumDesc->AppendValueToStr(out, paramDesc.GetConst(srcParam));
+}
+
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const BoolParamDesc& paramDesc)
 {
-	bool value = paramDesc.GetConst(srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, paramDesc.GetConst(srcParam));
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const UintParamDesc& paramDesc)
 {
-	uint32_t value = paramDesc.GetConst(srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, paramDesc.GetConst(srcParam));
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const IntParamDesc& paramDesc)
 {
-	int32_t value = paramDesc.GetConst(srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, paramDesc.GetConst(srcParam));
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const FloatParamDesc& paramDesc)
 {
 	float value = paramDesc.GetConst(srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	SaveFloatsToTokDoc(dstNode, &value, 1);
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const StringParamDesc& paramDesc)
 {
-	wstring value;
-	paramDesc.GetConst(value, srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, srcParam, paramDesc);
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const GameTimeParamDesc& paramDesc)
 {
-	common::GameTime value = paramDesc.GetConst(srcParam);
-	common::tokdoc::NodeFrom(dstNode, value.ToSeconds_d());
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, paramDesc.GetConst(srcParam));
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const Vec2ParamDesc& paramDesc)
 {
 	common::VEC2 value;
 	paramDesc.GetConst(value, srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	SaveFloatsToTokDoc(dstNode, &value.x, 2);
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const Vec3ParamDesc& paramDesc)
 {
 	common::VEC3 value;
 	paramDesc.GetConst(value, srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	SaveFloatsToTokDoc(dstNode, &value.x, 3);
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const Vec4ParamDesc& paramDesc)
 {
 	common::VEC4 value;
 	paramDesc.GetConst(value, srcParam);
-	common::tokdoc::NodeFrom(dstNode, value);
+	SaveFloatsToTokDoc(dstNode, &value.x, 4);
 }
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const StructParamDesc& paramDesc)
@@ -84,70 +165,197 @@ void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, cons
 
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const EnumParamDesc& paramDesc)
 {
-	int32_t value = paramDesc.GetConst(srcParam);
-    wstring valueStr;
-    paramDesc.m_EnumDesc->ValueToStr(valueStr, value);
-	common::tokdoc::NodeFrom(dstNode, valueStr);
+	dstNode.Value.clear();
+	AppendTokDocValue(dstNode.Value, srcParam, paramDesc);
 }
 
-// ADD NEW PARAMETER TYPES HERE.
-
 void SaveParamToTokDoc(common::tokdoc::Node& dstNode, const void* srcParam, const ParamDesc& paramDesc)
 {
-	if(typeid(BoolParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const BoolParamDesc&)paramDesc);
-	if(typeid(IntParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const IntParamDesc&)paramDesc);
-	if(typeid(UintParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const UintParamDesc&)paramDesc);
-	if(typeid(FloatParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const FloatParamDesc&)paramDesc);
-	if(typeid(StringParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const StringParamDesc&)paramDesc);
-	if(typeid(GameTimeParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const GameTimeParamDesc&)paramDesc);
-	if(typeid(Vec2ParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const Vec2ParamDesc&)paramDesc);
-	if(typeid(Vec3ParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const Vec3ParamDesc&)paramDesc);
-	if(typeid(Vec4ParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const Vec4ParamDesc&)paramDesc);
-	if(typeid(StructParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const StructParamDesc&)paramDesc);
-	if(typeid(FixedSizeArrayParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const FixedSizeArrayParamDesc&)paramDesc);
-	if(typeid(EnumParamDesc) == typeid(paramDesc))
-		return SaveParamToTokDoc(dstNode, srcParam, (const EnumParamDesc&)paramDesc);
-	// ADD NEW PARAMETER TYPES HERE.
-
-	assert(!"Unsupported parameter type.");
+	VisitParamDesc(paramDesc, [&](const auto& typedParamDesc) {
+		SaveParamToTokDoc(dstNode, srcParam, typedParamDesc);
+	});
 }
 
 void SaveObjToTokDoc(common::tokdoc::Node& dstNode, const void* srcObj, const StructDesc& structDesc)
 {
-	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
-	if(baseStructDesc)
-		SaveObjToTokDoc(dstNode, srcObj, *baseStructDesc);
-
-	for(size_t i = 0, count = structDesc.Params.size(); i < count; ++i)
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	const char* const srcBytes = (const char*)srcObj;
+	// Nodes of struct and array parameters currently open, innermost last.
+	std::vector<common::tokdoc::Node*> parentNodes;
+	parentNodes.push_back(&dstNode);
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
 	{
+		const LayoutEntry& entry = entries[i];
+		if(entry.Kind == LayoutEntry::KIND::STRUCT_END || entry.Kind == LayoutEntry::KIND::ARRAY_END)
+		{
+			parentNodes.pop_back();
+			continue;
+		}
+
 		common::tokdoc::Node* subNode = new common::tokdoc::Node();
-		dstNode.LinkChildAtEnd(subNode);
-		subNode->Name = structDesc.Names[i];
-		SaveParamToTokDoc(
-			*subNode,
-			structDesc.AccessRawParam(srcObj, i),
-			*structDesc.Params[i]);
+		parentNodes.back()->LinkChildAtEnd(subNode);
+		if(entry.Name)
+			subNode->Name = entry.Name;
+		if(entry.Kind == LayoutEntry::KIND::PARAM)
+			SaveParamToTokDoc(*subNode, srcBytes + entry.Offset, *entry.Desc);
+		else
+			parentNodes.push_back(subNode);
 	}
 }
 
-static inline bool IsFlagOptional(uint32_t flags)
+// Writes vector like common::tokdoc::Node::Save writes node with one child per component.
+static void SaveFloatsToTokDocStream(common::TokenWriter& dst, String_t& buf, const float* values, size_t count)
 {
-	return (flags & (TOKDOC_FLAG_OPTIONAL | TOKDOC_FLAG_OPTIONAL_CORRECT)) != 0;
+	Char_t chars[FLOAT_TO_CHARS_MAX_LEN];
+	dst.WriteSymbol(RS2_TEXT('{'));
+	dst.WriteEOL();
+	for(size_t i = 0; i < count; ++i)
+	{
+		buf.assign(chars, FloatToChars(chars, values[i]));
+		dst.WriteString(buf);
+		dst.WriteSymbol(RS2_TEXT(';'));
+		dst.WriteEOL();
+	}
+	dst.WriteSymbol(RS2_TEXT('}'));
 }
-static inline bool IsFlagRequired(uint32_t flags)
+
+// Writes value of parameter other than struct or array. buf is reused between parameters.
+static void SaveParamToTokDocStream(common::TokenWriter& dst, String_t& buf, const void* srcParam, const ParamDesc& paramDesc)
 {
-	return !IsFlagOptional(flags);
+	buf.clear();
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::BOOL:
+		AppendTokDocValue(buf, ((const BoolParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::INT:
+		AppendTokDocValue(buf, ((const IntParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::UINT:
+		AppendTokDocValue(buf, ((const UintParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::ENUM:
+		AppendTokDocValue(buf, srcParam, (const EnumParamDesc&)paramDesc);
+		break;
+	case PARAM_TYPE::FLOAT:
+		{
+			Char_t chars[FLOAT_TO_CHARS_MAX_LEN];
+			buf.assign(chars, FloatToChars(chars, ((const FloatParamDesc&)paramDesc).GetConst(srcParam)));
+		}
+		break;
+	case PARAM_TYPE::STRING:
+		AppendTokDocValue(buf, srcParam, (const StringParamDesc&)paramDesc);
+		break;
+	case PARAM_TYPE::GAMETIME:
+		AppendTokDocValue(buf, ((const GameTimeParamDesc&)paramDesc).GetConst(srcParam));
+		break;
+	case PARAM_TYPE::VEC2:
+		{
+			common::VEC2 value;
+			((const Vec2ParamDesc&)paramDesc).GetConst(value, srcParam);
+			SaveFloatsToTokDocStream(dst, buf, &value.x, 2);
+		}
+		return;
+	case PARAM_TYPE::VEC3:
+		{
+			common::VEC3 value;
+			((const Vec3ParamDesc&)paramDesc).GetConst(value, srcParam);
+			SaveFloatsToTokDocStream(dst, buf, &value.x, 3);
+		}
+		return;
+	case PARAM_TYPE::VEC4:
+		{
+			common::VEC4 value;
+			((const Vec4ParamDesc&)paramDesc).GetConst(value, srcParam);
+			SaveFloatsToTokDocStream(dst, buf, &value.x, 4);
+		}
+		return;
+	default:
+		assert(0);
+	}
+	dst.WriteString(buf);
+}
+
+void SaveObjToTokDocStream(common::TokenWriter& dst, const void* srcObj, const StructDesc& structDesc)
+{
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	const char* const srcBytes = (const char*)srcObj;
+	// Values are formatted here one by one, so saving doesn't allocate memory per parameter.
+	String_t buf;
+	for(size_t i = 0, count = entries.size(); i < count; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(entry.Kind == LayoutEntry::KIND::STRUCT_END || entry.Kind == LayoutEntry::KIND::ARRAY_END)
+		{
+			dst.WriteSymbol(RS2_TEXT('}'));
+			dst.WriteSymbol(RS2_TEXT(';'));
+			dst.WriteEOL();
+			continue;
+		}
+
+		if(entry.Name)
+		{
+			dst.WriteString(entry.Name);
+			dst.WriteSymbol(RS2_TEXT('='));
+		}
+		if(entry.Kind == LayoutEntry::KIND::PARAM)
+			SaveParamToTokDocStream(dst, buf, srcBytes + entry.Offset, *entry.Desc);
+		// Struct or array with contents is written as node with children, one by one.
+		else if(entry.EndIndex > i + 1)
+		{
+			dst.WriteSymbol(RS2_TEXT('{'));
+			dst.WriteEOL();
+			continue;
+		}
+		// Empty one is written like node without children, with empty value.
+		else
+		{
+			buf.clear();
+			dst.WriteString(buf);
+			i = entry.EndIndex;
+		}
+		dst.WriteSymbol(RS2_TEXT(';'));
+		dst.WriteEOL();
+	}
+}
+
+// Returns true if anything was saved.
+static bool SaveStructToTokDocDelta(common::tokdoc::Node& dstNode, const char* srcBytes, const char* baseBytes, const StructDesc& structDesc)
+{
+	const LayoutPlan& plan = structDesc.GetLayoutPlan();
+	bool anySaved = false;
+	for(size_t i = 0, count = plan.TopLevelEntries.size(); i < count; ++i)
+	{
+		const LayoutEntry& entry = plan.Entries[plan.TopLevelEntries[i]];
+		if(!entry.CanRead())
+			continue;
+		const char* const srcParam = srcBytes + entry.Offset;
+		const char* const baseParam = baseBytes ? baseBytes + entry.Offset : nullptr;
+		if(entry.Desc->GetType() == PARAM_TYPE::STRUCT)
+		{
+			std::unique_ptr<common::tokdoc::Node> subNode(new common::tokdoc::Node());
+			subNode->Name = entry.Name;
+			if(SaveStructToTokDocDelta(*subNode, srcParam, baseParam, *((const StructParamDesc*)entry.Desc)->GetStructDesc()))
+			{
+				dstNode.LinkChildAtEnd(subNode.release());
+				anySaved = true;
+			}
+			continue;
+		}
+		if(baseParam ? ParamEquals(srcParam, baseParam, *entry.Desc) : ParamIsDefault(srcParam, *entry.Desc))
+			continue;
+		common::tokdoc::Node* subNode = new common::tokdoc::Node();
+		dstNode.LinkChildAtEnd(subNode);
+		subNode->Name = entry.Name;
+		SaveParamToTokDoc(*subNode, srcParam, *entry.Desc);
+		anySaved = true;
+	}
+	return anySaved;
+}
+
+void SaveObjToTokDocDelta(common::tokdoc::Node& dstNode, const void* srcObj, const void* baseObj, const StructDesc& structDesc)
+{
+	SaveStructToTokDocDelta(dstNode, (const char*)srcObj, (const char*)baseObj, structDesc);
 }
 
 bool LoadParamFromTokDoc(void* dstParam, const BoolParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
@@ -163,7 +371,7 @@ bool LoadParamFromTokDoc(void* dstParam, const BoolParamDesc& paramDesc, const c
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid bool value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid bool value."));
 		return false;
 	}
 }
@@ -181,7 +389,7 @@ bool LoadParamFromTokDoc(void* dstParam, const IntParamDesc& paramDesc, const co
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid int value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid int value."));
 		return false;
 	}
 }
@@ -199,7 +407,7 @@ bool LoadParamFromTokDoc(void* dstParam, const UintParamDesc& paramDesc, const c
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid uint value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid uint value."));
 		return false;
 	}
 }
@@ -207,24 +415,26 @@ bool LoadParamFromTokDoc(void* dstParam, const UintParamDesc& paramDesc, const c
 bool LoadParamFromTokDoc(void* dstParam, const FloatParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
 	float value;
-	if(common::tokdoc::NodeTo(value, srcNode, IsFlagRequired(config.Flags)))
+	if(LoadFloatsFromTokDoc(&value, 1, srcNode))
 	{
 		paramDesc.SetConst(dstParam, value);
 		return true;
 	}
 	else
 	{
+		if(IsFlagRequired(config.Flags))
+			throw common::Error(RS2_TEXT("Invalid float value."), __TFILE__, __LINE__);
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid float value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid float value."));
 		return false;
 	}
 }
 
 bool LoadParamFromTokDoc(void* dstParam, const StringParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
-	wstring value;
+	String_t value;
 	if(common::tokdoc::NodeTo(value, srcNode, IsFlagRequired(config.Flags)))
 	{
 		paramDesc.SetConst(dstParam, value.c_str());
@@ -235,7 +445,7 @@ bool LoadParamFromTokDoc(void* dstParam, const StringParamDesc& paramDesc, const
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid string value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid string value."));
 		return false;
 	}
 }
@@ -253,7 +463,7 @@ bool LoadParamFromTokDoc(void* dstParam, const GameTimeParamDesc& paramDesc, con
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid GameTime value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid GameTime value."));
 		return false;
 	}
 }
@@ -261,17 +471,19 @@ bool LoadParamFromTokDoc(void* dstParam, const GameTimeParamDesc& paramDesc, con
 bool LoadParamFromTokDoc(void* dstParam, const Vec2ParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
 	common::VEC2 value;
-	if(common::tokdoc::NodeTo(value, srcNode, IsFlagRequired(config.Flags)))
+	if(LoadFloatsFromTokDoc(&value.x, 2, srcNode))
 	{
 		paramDesc.SetConst(dstParam, value);
 		return true;
 	}
 	else
 	{
+		if(IsFlagRequired(config.Flags))
+			throw common::Error(RS2_TEXT("Invalid vector value."), __TFILE__, __LINE__);
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid vec2 value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid vec2 value."));
 		return false;
 	}
 }
@@ -279,17 +491,19 @@ bool LoadParamFromTokDoc(void* dstParam, const Vec2ParamDesc& paramDesc, const c
 bool LoadParamFromTokDoc(void* dstParam, const Vec3ParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
 	common::VEC3 value;
-	if(common::tokdoc::NodeTo(value, srcNode, IsFlagRequired(config.Flags)))
+	if(LoadFloatsFromTokDoc(&value.x, 3, srcNode))
 	{
 		paramDesc.SetConst(dstParam, value);
 		return true;
 	}
 	else
 	{
+		if(IsFlagRequired(config.Flags))
+			throw common::Error(RS2_TEXT("Invalid vector value."), __TFILE__, __LINE__);
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid vec2 value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid vec2 value."));
 		return false;
 	}
 }
@@ -297,17 +511,19 @@ bool LoadParamFromTokDoc(void* dstParam, const Vec3ParamDesc& paramDesc, const c
 bool LoadParamFromTokDoc(void* dstParam, const Vec4ParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
 	common::VEC4 value;
-	if(common::tokdoc::NodeTo(value, srcNode, IsFlagRequired(config.Flags)))
+	if(LoadFloatsFromTokDoc(&value.x, 4, srcNode))
 	{
 		paramDesc.SetConst(dstParam, value);
 		return true;
 	}
 	else
 	{
+		if(IsFlagRequired(config.Flags))
+			throw common::Error(RS2_TEXT("Invalid vector value."), __TFILE__, __LINE__);
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Invalid vec2 value.");
+			config.WarningPrinter->printf(RS2_TEXT("Invalid vec2 value."));
 		return false;
 	}
 }
@@ -322,11 +538,11 @@ bool LoadParamFromTokDoc(void* dstParam, const FixedSizeArrayParamDesc& paramDes
 	if(!srcNode.HasChildren())
 	{
 		if(!IsFlagOptional(config.Flags))
-			throw common::Error(L"Array parameter is empty.", __TFILE__, __LINE__);
+			throw common::Error(RS2_TEXT("Array parameter is empty."), __TFILE__, __LINE__);
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Configuration array is empty.");
+			config.WarningPrinter->printf(RS2_TEXT("Configuration array is empty."));
 		return false;
 	}
 	bool allOk = true;
@@ -347,14 +563,14 @@ bool LoadParamFromTokDoc(void* dstParam, const FixedSizeArrayParamDesc& paramDes
 	if((elementNode == nullptr) != (index == elementCount))
 	{
 		if(!IsFlagOptional(config.Flags))
-			throw common::Error(L"Array parameter has invalid size.", __TFILE__, __LINE__);
+			throw common::Error(RS2_TEXT("Array parameter has invalid size."), __TFILE__, __LINE__);
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 		{
 			for(; index < elementCount; ++index)
 				paramDesc.SetElementToDefault(dstParam, index);
 		}
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Configuration array has invalid size.");
+			config.WarningPrinter->printf(RS2_TEXT("Configuration array has invalid size."));
 		allOk = false;
 	}
 	return allOk;
@@ -362,7 +578,7 @@ bool LoadParamFromTokDoc(void* dstParam, const FixedSizeArrayParamDesc& paramDes
 
 bool LoadParamFromTokDoc(void* dstParam, const EnumParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
-	wstring valueStr;
+	String_t valueStr;
 	if(common::tokdoc::NodeTo(valueStr, srcNode, IsFlagRequired(config.Flags)))
 	{
         int32_t value;
@@ -378,97 +594,788 @@ bool LoadParamFromTokDoc(void* dstParam, const EnumParamDesc& paramDesc, const c
 		    if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			    paramDesc.SetToDefault(dstParam);
 		    if(config.WarningPrinter)
-			    config.WarningPrinter->printf(L"Invalid enum value.");
+			    config.WarningPrinter->printf(RS2_TEXT("Invalid enum value."));
             return false;
         }
         else
-            throw common::Error(L"Invalid enum value.", __TFILE__, __LINE__);
+            throw common::Error(RS2_TEXT("Invalid enum value."), __TFILE__, __LINE__);
 	}
 	else
 	{
 		if((config.Flags & TOKDOC_FLAG_DEFAULT))
 			paramDesc.SetToDefault(dstParam);
 		if(config.WarningPrinter)
-			config.WarningPrinter->printf(L"Cannot load enum value.");
+			config.WarningPrinter->printf(RS2_TEXT("Cannot load enum value."));
 		return false;
 	}
 }
 
-// ADD NEW PARAMETER TYPES HERE.
-
 bool LoadParamFromTokDoc(void* dstParam, const ParamDesc& paramDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
-	if(typeid(BoolParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const BoolParamDesc&)paramDesc, srcNode, config);
-	if(typeid(IntParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const IntParamDesc&)paramDesc, srcNode, config);
-	if(typeid(UintParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const UintParamDesc&)paramDesc, srcNode, config);
-	if(typeid(FloatParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const FloatParamDesc&)paramDesc, srcNode, config);
-	if(typeid(StringParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const StringParamDesc&)paramDesc, srcNode, config);
-	if(typeid(GameTimeParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const GameTimeParamDesc&)paramDesc, srcNode, config);
-	if(typeid(Vec2ParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const Vec2ParamDesc&)paramDesc, srcNode, config);
-	if(typeid(Vec3ParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const Vec3ParamDesc&)paramDesc, srcNode, config);
-	if(typeid(Vec4ParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const Vec4ParamDesc&)paramDesc, srcNode, config);
-	if(typeid(StructParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const StructParamDesc&)paramDesc, srcNode, config);
-	if(typeid(FixedSizeArrayParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const FixedSizeArrayParamDesc&)paramDesc, srcNode, config);
-	if(typeid(EnumParamDesc) == typeid(paramDesc))
-		return LoadParamFromTokDoc(dstParam, (const EnumParamDesc&)paramDesc, srcNode, config);
-	// ADD NEW PARAMETER TYPES HERE.
-	
-	assert(!"Unsupported parameter type.");
-	return false;
+	return VisitParamDesc(paramDesc, [&](const auto& typedParamDesc) {
+		return LoadParamFromTokDoc(dstParam, typedParamDesc, srcNode, config);
+	});
+}
+
+/*
+State of LoadObjFromTokDoc walking the layout plan of a structure. It is kept
+outside of ERR_TRY block, so that the path to the parameter that failed can be
+reported in ERR_CATCH.
+*/
+struct TokDocLoadState
+{
+	struct Frame
+	{
+		// STRUCT_BEGIN or ARRAY_BEGIN entry.
+		const LayoutEntry* Entry;
+		const common::tokdoc::Node* Node;
+		// For arrays: node of the next element to load.
+		const common::tokdoc::Node* NextElementNode;
+		size_t LoadedElementCount;
+		bool AllOk;
+	};
+
+	char* DstBytes;
+	const STokDocLoadConfig* Config;
+	// Struct and array parameters currently open, innermost last.
+	std::vector<Frame> Frames;
+	// Entry currently being loaded, or null.
+	const LayoutEntry* CurrEntry;
+
+	String_t GetParamPath() const;
+};
+
+String_t TokDocLoadState::GetParamPath() const
+{
+	String_t path;
+	for(size_t i = 0, count = Frames.size(); i <= count; ++i)
+	{
+		const LayoutEntry* entry = i < count ? Frames[i].Entry : CurrEntry;
+		if(entry == nullptr)
+			continue;
+		if(entry->Name)
+		{
+			if(!path.empty())
+				path += RS2_TEXT('\\');
+			path += entry->Name;
+		}
+		else
+			AppendFormat(path, RS2_TEXT("[%u]"), (uint32_t)entry->ElementIndex);
+	}
+	return path;
+}
+
+static void OnTokDocParamLoadFailed(const LayoutEntry& entry, const STokDocLoadConfig& config)
+{
+	if(entry.Name && config.WarningPrinter)
+		config.WarningPrinter->printf(RS2_TEXT("RegScript2 TokDoc parameter \"%s\" loading failed."), entry.Name);
+}
+
+// Loads parameter represented by entry, or opens new frame if it is struct or array.
+// Returns false if loading failed, like LoadParamFromTokDoc.
+static bool BeginTokDocLayoutEntry(TokDocLoadState& state, const LayoutEntry& entry, const common::tokdoc::Node& srcNode)
+{
+	const STokDocLoadConfig& config = *state.Config;
+	void* const dstParam = state.DstBytes + entry.Offset;
+	bool ok = true;
+	state.CurrEntry = &entry;
+	switch(entry.Kind)
+	{
+	case LayoutEntry::KIND::PARAM:
+		ok = LoadParamFromTokDoc(dstParam, *entry.Desc, srcNode, config);
+		break;
+	case LayoutEntry::KIND::STRUCT_BEGIN:
+		state.Frames.push_back({ &entry, &srcNode, nullptr, 0, true });
+		break;
+	case LayoutEntry::KIND::ARRAY_BEGIN:
+		if(srcNode.HasChildren())
+			state.Frames.push_back({ &entry, &srcNode, srcNode.GetFirstChild(), 0, true });
+		else
+		{
+			if(!IsFlagOptional(config.Flags))
+				throw common::Error(RS2_TEXT("Array parameter is empty."), __TFILE__, __LINE__);
+			if((config.Flags & TOKDOC_FLAG_DEFAULT))
+				entry.Desc->SetToDefault(dstParam);
+			if(config.WarningPrinter)
+				config.WarningPrinter->printf(RS2_TEXT("Configuration array is empty."));
+			ok = false;
+		}
+		break;
+	default:
+		assert(0);
+	}
+	state.CurrEntry = nullptr;
+	return ok;
+}
+
+// Closes innermost frame. Returns false if loading of the struct or array failed.
+static bool EndTokDocLayoutEntry(TokDocLoadState& state)
+{
+	const STokDocLoadConfig& config = *state.Config;
+	TokDocLoadState::Frame& frame = state.Frames.back();
+	bool allOk = frame.AllOk;
+	if(frame.Entry->Kind == LayoutEntry::KIND::ARRAY_BEGIN)
+	{
+		const FixedSizeArrayParamDesc& paramDesc = (const FixedSizeArrayParamDesc&)*frame.Entry->Desc;
+		const size_t elementCount = paramDesc.GetCount();
+		if((frame.NextElementNode == nullptr) != (frame.LoadedElementCount == elementCount))
+		{
+			if(!IsFlagOptional(config.Flags))
+				throw common::Error(RS2_TEXT("Array parameter has invalid size."), __TFILE__, __LINE__);
+			if((config.Flags & TOKDOC_FLAG_DEFAULT))
+			{
+				void* const dstParam = state.DstBytes + frame.Entry->Offset;
+				for(size_t index = frame.LoadedElementCount; index < elementCount; ++index)
+					paramDesc.SetElementToDefault(dstParam, index);
+			}
+			if(config.WarningPrinter)
+				config.WarningPrinter->printf(RS2_TEXT("Configuration array has invalid size."));
+			allOk = false;
+		}
+	}
+	state.Frames.pop_back();
+	return allOk;
+}
+
+// Loads struct or array parameter at entries[beginIndex], which has already been begun, with all its contents.
+static bool LoadTokDocLayoutSubtree(TokDocLoadState& state, const std::vector<LayoutEntry>& entries, size_t beginIndex)
+{
+	const STokDocLoadConfig& config = *state.Config;
+	const size_t baseFrameCount = state.Frames.size() - 1;
+	for(size_t i = beginIndex + 1; ; ++i)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(entry.Kind == LayoutEntry::KIND::STRUCT_END || entry.Kind == LayoutEntry::KIND::ARRAY_END)
+		{
+			const bool ok = EndTokDocLayoutEntry(state);
+			if(state.Frames.size() == baseFrameCount)
+				return ok;
+			if(!ok)
+			{
+				state.Frames.back().AllOk = false;
+				OnTokDocParamLoadFailed(entry, config);
+			}
+			continue;
+		}
+
+		TokDocLoadState::Frame& frame = state.Frames.back();
+		const common::tokdoc::Node* subNode;
+		if(entry.IsArrayElement())
+		{
+			subNode = frame.NextElementNode;
+			if(subNode == nullptr)
+			{
+				// Missing elements are handled when the array ends.
+				i = entry.EndIndex;
+				continue;
+			}
+			frame.NextElementNode = subNode->GetNextSibling();
+			++frame.LoadedElementCount;
+		}
+		else
+		{
+			if(!entry.CanWrite())
+			{
+				i = entry.EndIndex;
+				continue;
+			}
+			subNode = frame.Node->FindFirstChild(entry.Name);
+			if(subNode == nullptr)
+			{
+				if((config.Flags & TOKDOC_FLAG_PATCH))
+				{
+					i = entry.EndIndex;
+					continue;
+				}
+				if(IsFlagOptional(config.Flags))
+				{
+					if((config.Flags & TOKDOC_FLAG_DEFAULT))
+						entry.Desc->SetToDefault(state.DstBytes + entry.Offset);
+					if(config.WarningPrinter)
+						config.WarningPrinter->printf(RS2_TEXT("RegScript2 TokDoc parameter \"%s\" not found."), entry.Name);
+					frame.AllOk = false;
+					i = entry.EndIndex;
+					continue;
+				}
+				else
+					throw common::Error(String_t(RS2_TEXT("Parameter not found: ")) + entry.Name, __TFILE__, __LINE__);
+			}
+		}
+
+		if(!BeginTokDocLayoutEntry(state, entry, *subNode))
+		{
+			state.Frames.back().AllOk = false;
+			OnTokDocParamLoadFailed(entry, config);
+			i = entry.EndIndex;
+		}
+	}
 }
 
 bool LoadObjFromTokDoc(void* dstObj, const StructDesc& structDesc, const common::tokdoc::Node& srcNode, const STokDocLoadConfig& config)
 {
-	const StructDesc* baseStructDesc = structDesc.GetBaseStructDesc();
+	const std::vector<LayoutEntry>& entries = structDesc.GetLayoutPlan().Entries;
+	TokDocLoadState state;
+	state.DstBytes = (char*)dstObj;
+	state.Config = &config;
+	state.CurrEntry = nullptr;
+
 	bool allOk = true;
-	if(baseStructDesc)
-		allOk = LoadObjFromTokDoc(dstObj, *baseStructDesc, srcNode, config);
+	for(size_t i = 0, count = entries.size(); i < count; i = entries[i].EndIndex + 1)
+	{
+		const LayoutEntry& entry = entries[i];
+		if(!entry.CanWrite())
+			continue;
+		const common::tokdoc::Node* subNode = srcNode.FindFirstChild(entry.Name);
+		if(subNode)
+		{
+			bool ok;
+			ERR_TRY;
+			ok = BeginTokDocLayoutEntry(state, entry, *subNode);
+			if(ok && entry.Kind != LayoutEntry::KIND::PARAM)
+				ok = LoadTokDocLayoutSubtree(state, entries, i);
+			ERR_CATCH(RS2_TEXT("RegScript2 TokDoc parameter: ") + state.GetParamPath());
+			if(!ok)
+			{
+				allOk = false;
+				OnTokDocParamLoadFailed(entry, config);
+			}
+		}
+		else if(!(config.Flags & TOKDOC_FLAG_PATCH))
+		{
+			if(IsFlagOptional(config.Flags))
+			{
+				if((config.Flags & TOKDOC_FLAG_DEFAULT))
+					entry.Desc->SetToDefault(state.DstBytes + entry.Offset);
+				if(config.WarningPrinter)
+					config.WarningPrinter->printf(RS2_TEXT("RegScript2 TokDoc parameter \"%s\" not found."), entry.Name);
+				allOk = false;
+			}
+			else
+				throw common::Error(String_t(RS2_TEXT("Parameter not found: ")) + entry.Name, __TFILE__, __LINE__);
+		}
+	}
+	return allOk;
+}
 
-	for(size_t i = 0, count = structDesc.Params.size(); i < count; ++i)
+// Reads value that follows '=' into dstNode, same way as common::tokdoc::Node::Load does.
+static void LoadTokDocStreamValue(common::tokdoc::Node& dstNode, common::Tokenizer& src)
+{
+	if(src.QuerySymbol(RS2_TEXT('{')))
 	{
-        if(structDesc.Params[i]->CanWrite())
-        {
-		    common::tokdoc::Node* subNode = srcNode.FindFirstChild(structDesc.Names[i]);
-		    if(subNode)
-		    {
-			    ERR_TRY;
-			    if(!LoadParamFromTokDoc(
-				    structDesc.AccessRawParam(dstObj, i),
-				    *structDesc.Params[i],
-				    *subNode,
-				    config))
-			    {
-				    allOk = false;
-				    if(config.WarningPrinter)
-					    config.WarningPrinter->printf(L"RegScript2 TokDoc parameter \"%s\" loading failed.", structDesc.Names[i].c_str());
-			    }
-			    ERR_CATCH(L"RegScript2 TokDoc parameter: " + structDesc.Names[i]);
-		    }
-		    else
-		    {
-			    if(IsFlagOptional(config.Flags))
-			    {
-				    if((config.Flags & TOKDOC_FLAG_DEFAULT))
-					    structDesc.SetParamToDefault(dstObj, i);
-				    if(config.WarningPrinter)
-					    config.WarningPrinter->printf(L"RegScript2 TokDoc parameter \"%s\" not found.", structDesc.Names[i].c_str());
-				    allOk = false;
-			    }
-			    else
-				    throw common::Error(L"Parameter not found.", __TFILE__, __LINE__);
-		    }
-        }
+		src.Next();
+		dstNode.LoadChildren(src);
+		src.AssertSymbol(RS2_TEXT('}'));
+		src.Next();
+	}
+	else
+	{
+		if(src.QueryEOF() || src.QueryToken(common::Tokenizer::TOKEN_SYMBOL))
+			src.CreateError();
+		dstNode.Value = src.GetString();
+		src.Next();
+	}
+}
+
+// Skips single value or whole block in braces.
+static void SkipTokDocStreamValue(common::Tokenizer& src)
+{
+	if(!src.QuerySymbol(RS2_TEXT('{')))
+	{
+		if(src.QueryEOF() || src.QueryToken(common::Tokenizer::TOKEN_SYMBOL))
+			src.CreateError();
+		src.Next();
+		return;
+	}
+	size_t depth = 0;
+	do
+	{
+		if(src.QuerySymbol(RS2_TEXT('{')))
+			++depth;
+		else if(src.QuerySymbol(RS2_TEXT('}')))
+			--depth;
+		else if(src.QueryEOF())
+			src.CreateError();
+		src.Next();
+	}
+	while(depth > 0);
+}
+
+/*
+State of LoadObjFromTokDocStream, shared by all nested structures and arrays,
+so that its buffers are allocated once and then reused.
+*/
+struct TokDocStreamLoadState
+{
+	const STokDocLoadConfig* Config;
+	// "Loaded" flags of top-level entries of structures currently open, innermost last.
+	std::vector<bool> Loaded;
+	// Copy of token string that must outlive Tokenizer::Next.
+	String_t Buf;
+};
+
+static bool LoadStructFromTokDocStream(char* dstBytes, const StructDesc& structDesc, common::Tokenizer& src, TokDocStreamLoadState& state);
+static bool LoadArrayFromTokDocStream(void* dstParam, const FixedSizeArrayParamDesc& paramDesc, common::Tokenizer& src, TokDocStreamLoadState& state);
+
+// Message of LoadParamFromTokDoc for invalid value of parameter of given type.
+static const Char_t* GetTokDocInvalidValueMessage(PARAM_TYPE type)
+{
+	switch(type)
+	{
+	case PARAM_TYPE::BOOL:
+		return RS2_TEXT("Invalid bool value.");
+	case PARAM_TYPE::INT:
+		return RS2_TEXT("Invalid int value.");
+	case PARAM_TYPE::UINT:
+		return RS2_TEXT("Invalid uint value.");
+	case PARAM_TYPE::ENUM:
+		return RS2_TEXT("Cannot load enum value.");
+	case PARAM_TYPE::FLOAT:
+		return RS2_TEXT("Invalid float value.");
+	case PARAM_TYPE::STRING:
+		return RS2_TEXT("Invalid string value.");
+	case PARAM_TYPE::GAMETIME:
+		return RS2_TEXT("Invalid GameTime value.");
+	case PARAM_TYPE::VEC2:
+	case PARAM_TYPE::VEC3:
+	case PARAM_TYPE::VEC4:
+		return RS2_TEXT("Invalid vec2 value.");
+	default:
+		return RS2_TEXT("Invalid value.");
+	}
+}
+
+// Reports invalid value of parameter that is not struct or array, like LoadParamFromTokDoc does.
+static bool OnTokDocStreamValueInvalid(void* dstParam, const ParamDesc& paramDesc, const STokDocLoadConfig& config)
+{
+	const PARAM_TYPE type = paramDesc.GetType();
+	const Char_t* const message = GetTokDocInvalidValueMessage(type);
+	if(IsFlagRequired(config.Flags))
+	{
+		const bool isVec = type == PARAM_TYPE::VEC2 || type == PARAM_TYPE::VEC3 || type == PARAM_TYPE::VEC4;
+		throw common::Error(isVec ? RS2_TEXT("Invalid vector value.") : message, __TFILE__, __LINE__);
+	}
+	if((config.Flags & TOKDOC_FLAG_DEFAULT))
+		paramDesc.SetToDefault(dstParam);
+	if(config.WarningPrinter)
+		config.WarningPrinter->printf(message);
+	return false;
+}
+
+// Loads parameter from string of single token, without creating temporary node.
+static bool LoadParamFromTokDocStreamToken(void* dstParam, const ParamDesc& paramDesc, const Char_t* str, size_t strLen, const STokDocLoadConfig& config)
+{
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::ENUM:
+		{
+			const EnumParamDesc& enumParamDesc = (const EnumParamDesc&)paramDesc;
+			int32_t value;
+			if(enumParamDesc.m_EnumDesc->StrToValue(value, str, strLen,
+				false, // caseSensitive
+				true)) // allowInteger
+			{
+				enumParamDesc.SetConst(dstParam, value);
+				return true;
+			}
+			if(!(config.Flags & TOKDOC_FLAG_OPTIONAL_CORRECT))
+				throw common::Error(RS2_TEXT("Invalid enum value."), __TFILE__, __LINE__);
+			if((config.Flags & TOKDOC_FLAG_DEFAULT))
+				paramDesc.SetToDefault(dstParam);
+			if(config.WarningPrinter)
+				config.WarningPrinter->printf(RS2_TEXT("Invalid enum value."));
+			return false;
+		}
+	case PARAM_TYPE::VEC2:
+	case PARAM_TYPE::VEC3:
+	case PARAM_TYPE::VEC4:
+		return OnTokDocStreamValueInvalid(dstParam, paramDesc, config);
+	case PARAM_TYPE::STRUCT:
+	case PARAM_TYPE::FIXED_SIZE_ARRAY:
+		{
+			// Rare case of single value given for whole structure or array - let LoadParamFromTokDoc report it.
+			common::tokdoc::Node node;
+			node.Value.assign(str, strLen);
+			return LoadParamFromTokDoc(dstParam, paramDesc, node, config);
+		}
+	default:
+		if(paramDesc.Parse(dstParam, str, strLen))
+			return true;
+		return OnTokDocStreamValueInvalid(dstParam, paramDesc, config);
+	}
+}
+
+/*
+If src is at "name =", skips it - elements of arrays and vectors can have names,
+which are ignored, like by LoadParamFromTokDoc. If src is at string or identifier
+not followed by '=', that is an unnamed value: copies it to state.Buf, skips it and
+returns true.
+*/
+static bool SkipTokDocStreamElementName(common::Tokenizer& src, TokDocStreamLoadState& state)
+{
+	if(!src.QueryToken(common::Tokenizer::TOKEN_STRING, common::Tokenizer::TOKEN_IDENTIFIER))
+		return false;
+	state.Buf = src.GetString();
+	src.Next();
+	if(!src.QuerySymbol(RS2_TEXT('=')))
+		return true;
+	src.Next();
+	return false;
+}
+
+// src is at '{'. Reads components token by token. Reports errors same way as LoadParamFromTokDoc.
+template<typename VecParamDesc_t>
+static bool LoadVecFromTokDocStream(void* dstParam, const VecParamDesc_t& paramDesc, common::Tokenizer& src, TokDocStreamLoadState& state)
+{
+	typename VecParamDesc_t::Value_t value;
+	float* const components = &value.x;
+	const size_t componentCount = sizeof(value) / sizeof(float);
+	size_t index = 0;
+	bool ok = true;
+	src.Next();
+	while(!src.QueryEOF() && !src.QuerySymbol(RS2_TEXT('}')))
+	{
+		if(src.QuerySymbol(RS2_TEXT(';')) || src.QuerySymbol(RS2_TEXT(',')))
+		{
+			src.Next();
+			continue;
+		}
+		bool componentOk = index < componentCount;
+		if(SkipTokDocStreamElementName(src, state))
+			componentOk = componentOk && CharsToFloat(components[index], state.Buf.data(), state.Buf.data() + state.Buf.length());
+		else if(src.QuerySymbol(RS2_TEXT('{')))
+		{
+			SkipTokDocStreamValue(src);
+			componentOk = false;
+		}
+		else
+		{
+			if(src.QueryEOF() || src.QueryToken(common::Tokenizer::TOKEN_SYMBOL))
+				src.CreateError();
+			const String_t& str = src.GetString();
+			componentOk = componentOk && CharsToFloat(components[index], str.data(), str.data() + str.length());
+			src.Next();
+		}
+		if(componentOk)
+			++index;
+		else
+			ok = false;
+	}
+	src.AssertSymbol(RS2_TEXT('}'));
+	src.Next();
+
+	if(ok && index == componentCount)
+	{
+		paramDesc.SetConst(dstParam, value);
+		return true;
+	}
+	return OnTokDocStreamValueInvalid(dstParam, paramDesc, *state.Config);
+}
+
+// Loads value that follows '=' or array element token by token, straight into dstParam.
+static bool LoadParamFromTokDocStream(void* dstParam, const ParamDesc& paramDesc, common::Tokenizer& src, TokDocStreamLoadState& state)
+{
+	if(!src.QuerySymbol(RS2_TEXT('{')))
+	{
+		if(src.QueryEOF() || src.QueryToken(common::Tokenizer::TOKEN_SYMBOL))
+			src.CreateError();
+		const String_t& str = src.GetString();
+		const bool ok = LoadParamFromTokDocStreamToken(dstParam, paramDesc, str.data(), str.length(), *state.Config);
+		src.Next();
+		return ok;
+	}
+	switch(paramDesc.GetType())
+	{
+	case PARAM_TYPE::STRUCT:
+		{
+			src.Next();
+			const bool ok = LoadStructFromTokDocStream(
+				(char*)dstParam, *((const StructParamDesc&)paramDesc).GetStructDesc(), src, state);
+			src.AssertSymbol(RS2_TEXT('}'));
+			src.Next();
+			return ok;
+		}
+	case PARAM_TYPE::FIXED_SIZE_ARRAY:
+		return LoadArrayFromTokDocStream(dstParam, (const FixedSizeArrayParamDesc&)paramDesc, src, state);
+	case PARAM_TYPE::VEC2:
+		return LoadVecFromTokDocStream(dstParam, (const Vec2ParamDesc&)paramDesc, src, state);
+	case PARAM_TYPE::VEC3:
+		return LoadVecFromTokDocStream(dstParam, (const Vec3ParamDesc&)paramDesc, src, state);
+	case PARAM_TYPE::VEC4:
+		return LoadVecFromTokDocStream(dstParam, (const Vec4ParamDesc&)paramDesc, src, state);
+	default:
+		SkipTokDocStreamValue(src);
+		return OnTokDocStreamValueInvalid(dstParam, paramDesc, *state.Config);
+	}
+}
+
+// src is at '{'. Reports errors same way as LoadParamFromTokDoc for FixedSizeArrayParamDesc.
+static bool LoadArrayFromTokDocStream(void* dstParam, const FixedSizeArrayParamDesc& paramDesc, common::Tokenizer& src, TokDocStreamLoadState& state)
+{
+	const STokDocLoadConfig& config = *state.Config;
+	src.Next();
+	bool allOk = true;
+	bool tooManyElements = false;
+	size_t index = 0;
+	char* dstElement = (char*)dstParam;
+	const size_t elementCount = paramDesc.GetCount();
+	const ParamDesc* elementParamDesc = paramDesc.GetElementParamDesc();
+	const size_t elementSize = elementParamDesc->GetParamSize();
+	while(!src.QueryEOF() && !src.QuerySymbol(RS2_TEXT('}')))
+	{
+		if(src.QuerySymbol(RS2_TEXT(';')) || src.QuerySymbol(RS2_TEXT(',')))
+		{
+			src.Next();
+			continue;
+		}
+		const bool unnamedString = SkipTokDocStreamElementName(src, state);
+		if(index < elementCount)
+		{
+			bool ok;
+			if(unnamedString)
+				ok = LoadParamFromTokDocStreamToken(dstElement, *elementParamDesc, state.Buf.data(), state.Buf.length(), config);
+			else
+				ok = LoadParamFromTokDocStream(dstElement, *elementParamDesc, src, state);
+			if(!ok)
+				allOk = false;
+			++index;
+			dstElement += elementSize;
+		}
+		else
+		{
+			if(!unnamedString)
+				SkipTokDocStreamValue(src);
+			tooManyElements = true;
+		}
+	}
+	src.AssertSymbol(RS2_TEXT('}'));
+	src.Next();
+
+	if(index == 0 && !tooManyElements)
+	{
+		if(!IsFlagOptional(config.Flags))
+			throw common::Error(RS2_TEXT("Array parameter is empty."), __TFILE__, __LINE__);
+		if((config.Flags & TOKDOC_FLAG_DEFAULT))
+			paramDesc.SetToDefault(dstParam);
+		if(config.WarningPrinter)
+			config.WarningPrinter->printf(RS2_TEXT("Configuration array is empty."));
+		return false;
+	}
+	if(index < elementCount || tooManyElements)
+	{
+		if(!IsFlagOptional(config.Flags))
+			throw common::Error(RS2_TEXT("Array parameter has invalid size."), __TFILE__, __LINE__);
+		if((config.Flags & TOKDOC_FLAG_DEFAULT))
+		{
+			for(; index < elementCount; ++index)
+				paramDesc.SetElementToDefault(dstParam, index);
+		}
+		if(config.WarningPrinter)
+			config.WarningPrinter->printf(RS2_TEXT("Configuration array has invalid size."));
+		allOk = false;
+	}
+	return allOk;
+}
+
+/*
+Parameter of a structure shadows parameter of its base structure with the same name.
+Like LoadObjFromTokDoc, loads all of them from the same value, parsed into temporary
+node for that. Flags of this structure start at loadedBegin in TokDocStreamLoadState::Loaded.
+*/
+static bool LoadSameNameParamsFromTokDocStream(
+	char* dstBytes, const LayoutPlan& plan, size_t topLevelIndex, size_t loadedBegin,
+	common::Tokenizer& src, TokDocStreamLoadState& state)
+{
+	const STokDocLoadConfig& config = *state.Config;
+	common::tokdoc::Node node;
+	LoadTokDocStreamValue(node, src);
+	bool allOk = true;
+	size_t i = topLevelIndex;
+	do
+	{
+		state.Loaded[loadedBegin + i] = true;
+		const LayoutEntry& entry = plan.Entries[plan.TopLevelEntries[i]];
+		if(entry.CanWrite())
+		{
+			bool ok;
+			ERR_TRY;
+			ok = LoadParamFromTokDoc(dstBytes + entry.Offset, *entry.Desc, node, config);
+			ERR_CATCH(String_t(RS2_TEXT("RegScript2 TokDoc parameter: ")) + entry.Name);
+			if(!ok)
+			{
+				allOk = false;
+				OnTokDocParamLoadFailed(entry, config);
+			}
+		}
+		i = plan.SameNameTopLevelEntries[i];
+	}
+	while(i != topLevelIndex);
+	return allOk;
+}
+
+static bool LoadStructFromTokDocStream(char* dstBytes, const StructDesc& structDesc, common::Tokenizer& src, TokDocStreamLoadState& state)
+{
+	const STokDocLoadConfig& config = *state.Config;
+	const LayoutPlan& plan = structDesc.GetLayoutPlan();
+	const size_t topLevelCount = plan.TopLevelEntries.size();
+	// This structure uses flags at the end of state.Loaded, removed when it's finished.
+	const size_t loadedBegin = state.Loaded.size();
+	state.Loaded.resize(loadedBegin + topLevelCount, false);
+	bool allOk = true;
+	while(!src.QueryEOF() && !src.QuerySymbol(RS2_TEXT('}')))
+	{
+		if(src.QuerySymbol(RS2_TEXT(';')) || src.QuerySymbol(RS2_TEXT(',')))
+		{
+			src.Next();
+			continue;
+		}
+		// Values without names are ignored, like by FindFirstChild.
+		if(!src.QueryToken(common::Tokenizer::TOKEN_STRING, common::Tokenizer::TOKEN_IDENTIFIER))
+		{
+			SkipTokDocStreamValue(src);
+			continue;
+		}
+		const String_t& name = src.GetString();
+		const size_t topLevelIndex = structDesc.FindTopLevel(name.c_str(), name.length(), true);
+		src.Next();
+		if(!src.QuerySymbol(RS2_TEXT('=')))
+			continue;
+		src.Next();
+
+		if(topLevelIndex == SIZE_MAX || state.Loaded[loadedBegin + topLevelIndex])
+		{
+			SkipTokDocStreamValue(src);
+			continue;
+		}
+		if(plan.SameNameTopLevelEntries[topLevelIndex] != topLevelIndex)
+		{
+			if(!LoadSameNameParamsFromTokDocStream(dstBytes, plan, topLevelIndex, loadedBegin, src, state))
+				allOk = false;
+			continue;
+		}
+		state.Loaded[loadedBegin + topLevelIndex] = true;
+		const LayoutEntry& entry = plan.Entries[plan.TopLevelEntries[topLevelIndex]];
+		if(!entry.CanWrite())
+		{
+			SkipTokDocStreamValue(src);
+			continue;
+		}
+
+		bool ok;
+		ERR_TRY;
+		ok = LoadParamFromTokDocStream(dstBytes + entry.Offset, *entry.Desc, src, state);
+		ERR_CATCH(String_t(RS2_TEXT("RegScript2 TokDoc parameter: ")) + entry.Name);
+		if(!ok)
+		{
+			allOk = false;
+			OnTokDocParamLoadFailed(entry, config);
+		}
+	}
+
+	for(size_t i = 0; i < topLevelCount; ++i)
+	{
+		const LayoutEntry& entry = plan.Entries[plan.TopLevelEntries[i]];
+		if(state.Loaded[loadedBegin + i] || !entry.CanWrite() || (config.Flags & TOKDOC_FLAG_PATCH))
+			continue;
+		if(IsFlagOptional(config.Flags))
+		{
+			if((config.Flags & TOKDOC_FLAG_DEFAULT))
+				entry.Desc->SetToDefault(dstBytes + entry.Offset);
+			if(config.WarningPrinter)
+				config.WarningPrinter->printf(RS2_TEXT("RegScript2 TokDoc parameter \"%s\" not found."), entry.Name);
+			allOk = false;
+		}
+		else
+			throw common::Error(String_t(RS2_TEXT("Parameter not found: ")) + entry.Name, __TFILE__, __LINE__);
+	}
+	state.Loaded.resize(loadedBegin);
+	return allOk;
+}
+
+bool LoadObjFromTokDocStream(void* dstObj, const StructDesc& structDesc, common::Tokenizer& src, const STokDocLoadConfig& config)
+{
+	TokDocStreamLoadState state;
+	state.Config = &config;
+	return LoadStructFromTokDocStream((char*)dstObj, structDesc, src, state);
+}
+
+// Stores warnings of a job until they can be printed in order.
+class TokDocJobWarningPrinter : public IPrinter
+{
+public:
+	std::vector<String_t> Lines;
+
+	virtual void printf(const Char_t* format, ...)
+	{
+		va_list argList;
+		va_start(argList, format);
+		Lines.push_back(String_t());
+		VFormat(Lines.back(), format, argList);
+		va_end(argList);
+	}
+};
+
+static void RunTokDocLoadJob(STokDocLoadJob& job, TokDocJobWarningPrinter& warningPrinter)
+{
+	STokDocLoadConfig config = job.Config;
+	if(config.WarningPrinter)
+		config.WarningPrinter = &warningPrinter;
+	job.Ok = false;
+	job.ErrorMessage.clear();
+	try
+	{
+		common::tokdoc::Node rootNode;
+		common::Tokenizer tokenizer(job.Doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+		tokenizer.Next();
+		rootNode.LoadChildren(tokenizer);
+		tokenizer.AssertEOF();
+		job.Ok = LoadObjFromTokDoc(job.DstObj, *job.DstStructDesc, rootNode, config);
+	}
+	catch(common::Error& err)
+	{
+		err.Push(RS2_TEXT("RegScript2 TokDoc file: ") + job.FileName, __TFILE__, __LINE__);
+		err.GetMessage_(&job.ErrorMessage);
+	}
+	// Exception must not escape the thread.
+	catch(const std::exception& err)
+	{
+		const char* what = err.what();
+		job.ErrorMessage.assign(what, what + strlen(what));
+	}
+}
+
+bool LoadObjsFromTokDocParallel(STokDocLoadJob* jobs, size_t jobCount, uint32_t threadCount)
+{
+	if(threadCount == 0)
+		threadCount = std::thread::hardware_concurrency();
+	if(threadCount == 0)
+		threadCount = 1;
+	if(threadCount > jobCount)
+		threadCount = (uint32_t)jobCount;
+
+	std::vector<TokDocJobWarningPrinter> warningPrinters(jobCount);
+	std::atomic<size_t> nextJobIndex(0);
+	auto worker = [&]() {
+		for(size_t jobIndex = nextJobIndex++; jobIndex < jobCount; jobIndex = nextJobIndex++)
+			RunTokDocLoadJob(jobs[jobIndex], warningPrinters[jobIndex]);
+	};
+	std::vector<std::thread> threads;
+	for(uint32_t i = 1; i < threadCount; ++i)
+		threads.emplace_back(worker);
+	worker();
+	for(std::thread& thread : threads)
+		thread.join();
+
+	bool allOk = true;
+	for(size_t i = 0; i < jobCount; ++i)
+	{
+		const STokDocLoadJob& job = jobs[i];
+		if(job.Config.WarningPrinter)
+		{
+			for(const String_t& line : warningPrinters[i].Lines)
+				job.Config.WarningPrinter->printf(RS2_TEXT("%s: %s"), job.FileName.c_str(), line.c_str());
+		}
+		if(!job.Ok)
+			allOk = false;
 	}
 	return allOk;
 }
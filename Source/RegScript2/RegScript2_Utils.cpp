@@ -2,12 +2,474 @@
 #include <vector>
 #include <cstdio>
 #include <cstdarg>
+#include <cwctype>
+#include <cwchar>
+#include <cstring>
+#include <cassert>
 
 namespace RegScript2
 {
 
+////////////////////////////////////////////////////////////////////////////////
+// class IPrinter
+
+void IPrinter::PrintLine(const Char_t* str, size_t strLen)
+{
+	printf(RS2_TEXT("%.*s"), (int)strLen, str);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class BufferedPrinter
+
+BufferedPrinter::BufferedPrinter(size_t bufferCapacity) :
+	m_BufferCapacity(bufferCapacity)
+{
+	// Space for a long line past the capacity, so buffer doesn't grow again.
+	m_Buffer.reserve(bufferCapacity + 1024);
+}
+
+void BufferedPrinter::printf(const Char_t* format, ...)
+{
+	va_list argList;
+	va_start(argList, format);
+	AppendVFormat(m_Buffer, format, argList);
+	va_end(argList);
+	LineEnded();
+}
+
+void BufferedPrinter::PrintLine(const Char_t* str, size_t strLen)
+{
+	m_Buffer.append(str, strLen);
+	LineEnded();
+}
+
+void BufferedPrinter::FlushBuffer()
+{
+	if(!m_Buffer.empty())
+	{
+		Flush(m_Buffer.data(), m_Buffer.length());
+		m_Buffer.clear();
+	}
+}
+
+void BufferedPrinter::LineEnded()
+{
+	m_Buffer += RS2_TEXT('\n');
+	if(m_Buffer.length() >= m_BufferCapacity)
+		FlushBuffer();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class FilePrinter
+
+void FilePrinter::Flush(const Char_t* data, size_t dataLen)
+{
+#ifdef RS2_UTF8
+	fwrite(data, 1, dataLen, m_File);
+#else
+	m_Utf8Buffer.clear();
+	AppendUtf8(m_Utf8Buffer, data, dataLen);
+	fwrite(m_Utf8Buffer.data(), 1, m_Utf8Buffer.length(), m_File);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unicode conversions
+
+template<typename SrcChar_t>
+static void AppendUtf8Generic(std::string& out, const SrcChar_t* src, size_t srcLen)
+{
+	const size_t oldLen = out.length();
+	// Upper bound: 3 bytes per UTF-16 code unit, 4 per UTF-32 code point.
+	out.resize(oldLen + srcLen * (sizeof(SrcChar_t) == 2 ? 3 : 4));
+	char* dst = &out[oldLen];
+	for(size_t i = 0; i < srcLen; ++i)
+	{
+		uint32_t ch = (uint32_t)src[i];
+		if(sizeof(SrcChar_t) == 2 && ch >= 0xD800 && ch <= 0xDFFF)
+		{
+			// Surrogate pair.
+			if(ch <= 0xDBFF && i + 1 < srcLen && (uint32_t)src[i + 1] >= 0xDC00 && (uint32_t)src[i + 1] <= 0xDFFF)
+			{
+				ch = 0x10000 + ((ch - 0xD800) << 10) + ((uint32_t)src[i + 1] - 0xDC00);
+				++i;
+			}
+			else
+				ch = 0xFFFD;
+		}
+		else if((ch >= 0xD800 && ch <= 0xDFFF) || ch > 0x10FFFF)
+			ch = 0xFFFD;
+
+		if(ch < 0x80)
+			*dst++ = (char)ch;
+		else if(ch < 0x800)
+		{
+			*dst++ = (char)(0xC0 | (ch >> 6));
+			*dst++ = (char)(0x80 | (ch & 0x3F));
+		}
+		else if(ch < 0x10000)
+		{
+			*dst++ = (char)(0xE0 | (ch >> 12));
+			*dst++ = (char)(0x80 | ((ch >> 6) & 0x3F));
+			*dst++ = (char)(0x80 | (ch & 0x3F));
+		}
+		else
+		{
+			*dst++ = (char)(0xF0 | (ch >> 18));
+			*dst++ = (char)(0x80 | ((ch >> 12) & 0x3F));
+			*dst++ = (char)(0x80 | ((ch >> 6) & 0x3F));
+			*dst++ = (char)(0x80 | (ch & 0x3F));
+		}
+	}
+	out.resize(dst - out.data());
+}
+
+void AppendUtf8(std::string& out, const wchar_t* src, size_t srcLen)
+{
+	AppendUtf8Generic(out, src, srcLen);
+}
+
+void AppendUtf8(std::string& out, const char16_t* src, size_t srcLen)
+{
+	AppendUtf8Generic(out, src, srcLen);
+}
+
+// Decodes code point starting at src[index] and moves index past it. Invalid sequence gives U+FFFD.
+static uint32_t DecodeUtf8(const char* src, size_t srcLen, size_t& index)
+{
+	const uint32_t lead = (uint8_t)src[index++];
+	if(lead < 0x80)
+		return lead;
+	uint32_t ch, minValue;
+	size_t trailCount;
+	if(lead >= 0xC2 && lead <= 0xDF)
+	{
+		ch = lead & 0x1F;
+		minValue = 0x80;
+		trailCount = 1;
+	}
+	else if(lead >= 0xE0 && lead <= 0xEF)
+	{
+		ch = lead & 0x0F;
+		minValue = 0x800;
+		trailCount = 2;
+	}
+	else if(lead >= 0xF0 && lead <= 0xF4)
+	{
+		ch = lead & 0x07;
+		minValue = 0x10000;
+		trailCount = 3;
+	}
+	else
+		return 0xFFFD;
+	for(size_t i = 0; i < trailCount; ++i)
+	{
+		if(index == srcLen || ((uint8_t)src[index] & 0xC0) != 0x80)
+			return 0xFFFD;
+		ch = (ch << 6) | ((uint8_t)src[index++] & 0x3F);
+	}
+	if(ch < minValue || ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF))
+		return 0xFFFD;
+	return ch;
+}
+
+void AppendUtf16(std::u16string& out, const char* src, size_t srcLen)
+{
+	for(size_t i = 0; i < srcLen; )
+	{
+		const uint32_t ch = DecodeUtf8(src, srcLen, i);
+		if(ch >= 0x10000)
+		{
+			out += (char16_t)(0xD800 + ((ch - 0x10000) >> 10));
+			out += (char16_t)(0xDC00 + ((ch - 0x10000) & 0x3FF));
+		}
+		else
+			out += (char16_t)ch;
+	}
+}
+
+void AppendUtf16(std::u16string& out, const wchar_t* src, size_t srcLen)
+{
+	if(sizeof(wchar_t) == sizeof(char16_t))
+	{
+		out.append((const char16_t*)src, srcLen);
+		return;
+	}
+	for(size_t i = 0; i < srcLen; ++i)
+	{
+		uint32_t ch = (uint32_t)src[i];
+		if(ch > 0x10FFFF)
+			ch = 0xFFFD;
+		if(ch >= 0x10000)
+		{
+			out += (char16_t)(0xD800 + ((ch - 0x10000) >> 10));
+			out += (char16_t)(0xDC00 + ((ch - 0x10000) & 0x3FF));
+		}
+		else
+			out += (char16_t)ch;
+	}
+}
+
+void AppendWide(std::wstring& out, const char16_t* src, size_t srcLen)
+{
+	if(sizeof(wchar_t) == sizeof(char16_t))
+	{
+		out.append((const wchar_t*)src, srcLen);
+		return;
+	}
+	for(size_t i = 0; i < srcLen; ++i)
+	{
+		uint32_t ch = src[i];
+		if(ch >= 0xD800 && ch <= 0xDFFF)
+		{
+			if(ch <= 0xDBFF && i + 1 < srcLen && src[i + 1] >= 0xDC00 && src[i + 1] <= 0xDFFF)
+			{
+				ch = 0x10000 + ((ch - 0xD800) << 10) + ((uint32_t)src[i + 1] - 0xDC00);
+				++i;
+			}
+			else
+				ch = 0xFFFD;
+		}
+		out += (wchar_t)ch;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class NameIndex
+
+const size_t NameIndex::INVALID_VALUE;
+
+// Hashes single UTF-16 code unit, or surrogate pair for character outside of BMP.
+static inline uint32_t HashCodePoint(uint32_t hash, uint32_t ch)
+{
+	if(ch >= 0x10000)
+	{
+		hash = (hash ^ (0xD800 + ((ch - 0x10000) >> 10))) * 16777619u;
+		ch = 0xDC00 + ((ch - 0x10000) & 0x3FF);
+	}
+	return (hash ^ ch) * 16777619u;
+}
+
+uint32_t HashName(const char* name, size_t nameLen, bool caseSensitive)
+{
+	uint32_t hash = 2166136261u;
+	for(size_t i = 0; i < nameLen; )
+	{
+		uint32_t ch = DecodeUtf8(name, nameLen, i);
+		if(!caseSensitive && ch < 0x80)
+			ch = (uint32_t)CharToLower((char)ch);
+		hash = HashCodePoint(hash, ch);
+	}
+	return hash;
+}
+
+uint32_t HashName(const wchar_t* name, size_t nameLen, bool caseSensitive)
+{
+	uint32_t hash = 2166136261u;
+	for(size_t i = 0; i < nameLen; ++i)
+	{
+		const wchar_t ch = caseSensitive ? name[i] : CharToLower(name[i]);
+		hash = HashCodePoint(hash, (uint32_t)ch);
+	}
+	return hash;
+}
+
+static bool NamesEqual(const Char_t* lhs, const Char_t* rhs, size_t len, bool caseSensitive)
+{
+	if(caseSensitive)
+		return MemCmp(lhs, rhs, len) == 0;
+	for(size_t i = 0; i < len; ++i)
+	{
+		if(CharToLower(lhs[i]) != CharToLower(rhs[i]))
+			return false;
+	}
+	return true;
+}
+
+void NameIndex::Reset(size_t nameCount)
+{
+	// Power of 2, at most half full.
+	size_t slotCount = 4;
+	while(slotCount < nameCount * 2)
+		slotCount *= 2;
+	const Slot emptySlot = { nullptr, 0, 0, 0 };
+	m_Slots.assign(slotCount, emptySlot);
+	m_FoldedSlots.assign(slotCount, emptySlot);
+	m_Count = 0;
+}
+
+void NameIndex::Add(const Char_t* name, size_t nameLen, size_t value)
+{
+	assert(name != nullptr);
+	if((m_Count + 1) * 2 > m_Slots.size())
+	{
+		std::vector<Slot> oldSlots, oldFoldedSlots;
+		oldSlots.swap(m_Slots);
+		oldFoldedSlots.swap(m_FoldedSlots);
+		size_t count = m_Count;
+		Reset(count + 1);
+		m_Count = count;
+		// Each table holds only distinct names, so order of reinsertion doesn't matter.
+		for(const Slot& slot : oldSlots)
+			if(slot.Name != nullptr)
+				Insert(m_Slots, slot.Name, slot.NameLen, slot.Value, slot.Hash, true);
+		for(const Slot& slot : oldFoldedSlots)
+			if(slot.Name != nullptr)
+				Insert(m_FoldedSlots, slot.Name, slot.NameLen, slot.Value, slot.Hash, false);
+	}
+	Insert(m_Slots, name, nameLen, value, HashName(name, nameLen, true), true);
+	Insert(m_FoldedSlots, name, nameLen, value, HashName(name, nameLen, false), false);
+	++m_Count;
+}
+
+size_t NameIndex::Find(const Char_t* name, size_t nameLen, bool caseSensitive) const
+{
+	if(m_Count == 0)
+		return INVALID_VALUE;
+	return Lookup(
+		caseSensitive ? m_Slots : m_FoldedSlots,
+		name, nameLen,
+		HashName(name, nameLen, caseSensitive),
+		caseSensitive);
+}
+
+void NameIndex::Insert(std::vector<Slot>& slots, const Char_t* name, size_t nameLen, size_t value, uint32_t hash, bool caseSensitive)
+{
+	const size_t mask = slots.size() - 1;
+	for(size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		Slot& slot = slots[i];
+		if(slot.Name == nullptr)
+		{
+			slot.Name = name;
+			slot.NameLen = nameLen;
+			slot.Value = value;
+			slot.Hash = hash;
+			return;
+		}
+		// Already present - first one wins.
+		if(slot.Hash == hash && slot.NameLen == nameLen && NamesEqual(slot.Name, name, nameLen, caseSensitive))
+			return;
+	}
+}
+
+size_t NameIndex::Lookup(const std::vector<Slot>& slots, const Char_t* name, size_t nameLen, uint32_t hash, bool caseSensitive)
+{
+	const size_t mask = slots.size() - 1;
+	for(size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		const Slot& slot = slots[i];
+		if(slot.Name == nullptr)
+			return INVALID_VALUE;
+		if(slot.Hash == hash && slot.NameLen == nameLen && NamesEqual(slot.Name, name, nameLen, caseSensitive))
+			return slot.Value;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class DescArena
+
+DescArena::DescArena(size_t blockSize) :
+	m_BlockSize(blockSize),
+	m_CurrPtr(nullptr),
+	m_CurrEnd(nullptr),
+	m_AllocatedSize(0),
+	m_UsedSize(0)
+{
+}
+
+DescArena::~DescArena()
+{
+	for(size_t i = m_Blocks.size(); i--; )
+		delete[] m_Blocks[i].Data;
+}
+
+void* DescArena::Allocate(size_t size, size_t alignment)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return AllocateUnlocked(size, alignment);
+}
+
+void* DescArena::AllocateUnlocked(size_t size, size_t alignment)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+	char* ptr = (char*)(((uintptr_t)m_CurrPtr + alignment - 1) & ~(uintptr_t)(alignment - 1));
+	if(m_CurrPtr == nullptr || ptr + size > m_CurrEnd)
+	{
+		// Allocations bigger than the block get a block of their own, so the current one can still be used.
+		const size_t blockSize = size + alignment > m_BlockSize ? size + alignment : m_BlockSize;
+		char* block = new char[blockSize];
+		m_Blocks.push_back(Block{block, blockSize});
+		m_AllocatedSize += blockSize;
+		ptr = (char*)(((uintptr_t)block + alignment - 1) & ~(uintptr_t)(alignment - 1));
+		if(blockSize == m_BlockSize)
+		{
+			m_CurrPtr = ptr + size;
+			m_CurrEnd = block + blockSize;
+		}
+	}
+	else
+		m_CurrPtr = ptr + size;
+	m_UsedSize += size;
+	return ptr;
+}
+
+const Char_t* DescArena::Intern(const Char_t* str, size_t len)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	size_t index = m_InternIndex.Find(str, len, true);
+	if(index != NameIndex::INVALID_VALUE)
+		return m_InternedStrings[index];
+
+	Char_t* copy = (Char_t*)AllocateUnlocked((len + 1) * sizeof(Char_t), alignof(Char_t));
+	MemCpy(copy, str, len);
+	copy[len] = RS2_TEXT('\0');
+	m_InternIndex.Add(copy, len, m_InternedStrings.size());
+	m_InternedStrings.push_back(copy);
+	return copy;
+}
+
+bool DescArena::Contains(const void* ptr) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for(size_t i = 0, count = m_Blocks.size(); i < count; ++i)
+	{
+		if((const char*)ptr >= m_Blocks[i].Data && (const char*)ptr < m_Blocks[i].Data + m_Blocks[i].Size)
+			return true;
+	}
+	return false;
+}
+
+size_t DescArena::GetFootprint() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_AllocatedSize +
+		m_Blocks.capacity() * sizeof(Block) +
+		m_InternIndex.GetFootprint() +
+		m_InternedStrings.capacity() * sizeof(const Char_t*);
+}
+
+size_t DescArena::GetUsedSize() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_UsedSize;
+}
+
+DescArena& GetDescArena()
+{
+	static DescArena* arena = new DescArena();
+	return *arena;
+}
+
 } // namespace RegScript2
 
+using RegScript2::Char_t;
+using RegScript2::String_t;
+using RegScript2::StrLen;
+using RegScript2::MemCmp;
+using RegScript2::MemCpy;
+using RegScript2::MemChr;
+
 void Format(std::string& str, const char* format, ...)
 {
     va_list argList;
@@ -64,9 +526,9 @@ string Format_r(const char* format, ...)
 	return result;
 }
 
-wstring Format_r(const wchar_t* format, ...)
+std::wstring Format_r(const wchar_t* format, ...)
 {
-    wstring result;
+    std::wstring result;
 
     va_list argList;
     va_start(argList, format);
@@ -98,9 +560,10 @@ void AppendVFormat(std::string& str, const char* format, va_list argList)
 
 	if(dstLen)
 	{
-		std::vector<char> buf(dstLen + 1);
-		vsprintf_s(&buf[0], dstLen + 1, format, argList);
-		str.append(&buf[0], &buf[dstLen]);
+		// Formatted directly at the end of str, which always has space for terminating null.
+		const size_t oldLen = str.length();
+		str.resize(oldLen + dstLen);
+		vsprintf_s(&str[oldLen], dstLen + 1, format, argList);
 	}
 }
 
@@ -110,57 +573,65 @@ void AppendVFormat(std::wstring& str, const wchar_t* format, va_list argList)
 
     if(dstLen)
     {
-        std::vector<wchar_t> buf(dstLen + 1);
-        vswprintf_s(&buf[0], dstLen + 1, format, argList);
-        str.append(&buf[0], &buf[dstLen]);
+        const size_t oldLen = str.length();
+        str.resize(oldLen + dstLen);
+        vswprintf_s(&str[oldLen], dstLen + 1, format, argList);
     }
 }
 
-void SecondsToFriendlyStr(std::wstring& out, double seconds)
+void SecondsToFriendlyStr(String_t& out, double seconds)
 {
-	bool negative = seconds < 0.;
-	if(negative)
+	out.clear();
+	AppendSecondsToFriendlyStr(out, seconds);
+}
+
+void AppendSecondsToFriendlyStr(String_t& out, double seconds)
+{
+	if(seconds < 0.)
+	{
+		out += RS2_TEXT('-');
 		seconds = -seconds;
+	}
 
 	// 0: 0
 	if(seconds == 0.f)
-		out = L"0";
+		out += RS2_TEXT('0');
 	// seconds < 1 ns: Whatever s
 	else if(seconds < 1e-9)
-		::Format(out, L"%gs", seconds);
+		::AppendFormat(out, RS2_TEXT("%gs"), seconds);
 	// seconds < 10 ns: N.NNns
 	else if(seconds < 1e-8)
-		::Format(out, L"%.2fns", seconds * 1e9);
+		::AppendFormat(out, RS2_TEXT("%.2fns"), seconds * 1e9);
 	// seconds < 100 ns: NN.Nns
 	else if(seconds < 1e-7)
-		::Format(out, L"%.1fns", seconds * 1e9);
+		::AppendFormat(out, RS2_TEXT("%.1fns"), seconds * 1e9);
 	// seconds < 1 us: NNNns
 	else if(seconds < 1e-6)
-		::Format(out, L"%.0fns", seconds * 1e9);
+		::AppendFormat(out, RS2_TEXT("%.0fns"), seconds * 1e9);
 	// seconds < 10 us: N.NNus
 	else if(seconds < 1e-5)
-		::Format(out, L"%.2fus", seconds * 1e6);
+		::AppendFormat(out, RS2_TEXT("%.2fus"), seconds * 1e6);
 	// seconds < 100 us: NN.Nus
 	else if(seconds < 1e-4)
-		::Format(out, L"%.1fus", seconds * 1e6);
+		::AppendFormat(out, RS2_TEXT("%.1fus"), seconds * 1e6);
 	// seconds < 1 ms: NNNus
 	else if(seconds < 1e-3)
-		::Format(out, L"%.0fus", seconds * 1e6);
+		::AppendFormat(out, RS2_TEXT("%.0fus"), seconds * 1e6);
 	// seconds < 10 ms: N.NNms
 	else if(seconds < 1e-2)
-		::Format(out, L"%.2fms", seconds * 1e3);
+		::AppendFormat(out, RS2_TEXT("%.2fms"), seconds * 1e3);
 	// seconds < 100 ms: NN.Nms
 	else if(seconds < 1e-1)
-		::Format(out, L"%.1fms", seconds * 1e3);
+		::AppendFormat(out, RS2_TEXT("%.1fms"), seconds * 1e3);
 	// seconds < 1 s: NNNms
 	else if(seconds < 1.0)
-		::Format(out, L"%.0fms", seconds * 1e3);
+		::AppendFormat(out, RS2_TEXT("%.0fms"), seconds * 1e3);
 	// seconds < 10 s: N.NNs
 	else if(seconds < 10.0)
-		::Format(out, L"%.2fs", seconds);
+		::AppendFormat(out, RS2_TEXT("%.2fs"), seconds);
 	// seconds < 1 min: NN.Ns"
 	else if(seconds < 60.0)
-		::Format(out, L"%.1fs", seconds);
+		::AppendFormat(out, RS2_TEXT("%.1fs"), seconds);
 	else
 	{
 		uint64_t secondsU = (uint64_t)(seconds + 0.5);
@@ -168,109 +639,637 @@ void SecondsToFriendlyStr(std::wstring& out, double seconds)
 		secondsU %= 60;
 		// seconds < 1 h: N:NN
 		if(minutesU < 60)
-			::Format(out, L"%u:%02u", (uint32_t)minutesU, (uint32_t)secondsU);
+			::AppendFormat(out, RS2_TEXT("%u:%02u"), (uint32_t)minutesU, (uint32_t)secondsU);
 		else
 		{
 			uint64_t hoursU = minutesU / 60;
 			minutesU %= 60;
 			// N:NN:NN
-			::Format(out, L"%u:%02u:%02u", (uint32_t)hoursU, (uint32_t)minutesU, (uint32_t)secondsU);
+			::AppendFormat(out, RS2_TEXT("%u:%02u:%02u"), (uint32_t)hoursU, (uint32_t)minutesU, (uint32_t)secondsU);
 		}
 	}
+}
 
-	if(negative)
-		out.insert(0, L"-");
+static bool StrEndsWith(const Char_t* str, size_t strLen, const Char_t* suffix, size_t suffixLen)
+{
+	return strLen >= suffixLen && MemCmp(str + strLen - suffixLen, suffix, suffixLen) == 0;
 }
 
-bool FriendlyStrToSeconds(double& outSeconds, const wchar_t *str)
+bool FriendlyStrToSeconds(double& outSeconds, const Char_t *str)
+{
+	return FriendlyStrToSeconds(outSeconds, str, StrLen(str));
+}
+
+bool FriendlyStrToSeconds(double& outSeconds, const Char_t *str, size_t strLen)
 {
-	size_t strLen = wcslen(str);
 	if(strLen == 0)
 		return false;
 
-	bool negative = str[0] == L'-';
+	bool negative = str[0] == RS2_TEXT('-');
 	if(negative)
 	{
 		++str;
 		--strLen;
 	}
+	const Char_t* const strEnd = str + strLen;
 
 	bool ok = true;
 	// "m:s" or "h:m:s"
-	const wchar_t* firstColon = wcschr(str, L':');
+	const Char_t* firstColon = MemChr(str, RS2_TEXT(':'), strLen);
 	if(firstColon != nullptr)
 	{
-		const wchar_t* secondColon = wcschr(firstColon + 1, L':');
+		const Char_t* secondColon = MemChr(firstColon + 1, RS2_TEXT(':'), strEnd - (firstColon + 1));
 		// "h:m:s"
 		if(secondColon != nullptr)
 		{
-			wstring newStr{str, firstColon};
-			uint32_t hours = 0;
-			ok = common::StrToUint(&hours, newStr) == 0;
+			uint32_t hours = 0, minutes = 0;
+			ok = CharsToUint(hours, str, firstColon) &&
+				CharsToUint(minutes, firstColon + 1, secondColon) &&
+				CharsToDouble(outSeconds, secondColon + 1, strEnd);
 			if(ok)
-			{		
-				newStr = wstring{firstColon + 1, secondColon};
-				uint32_t minutes = 0;
-				ok = common::StrToUint(&minutes, newStr) == 0;
-				if(ok)
-				{
-					newStr = secondColon + 1;
-					ok = common::StrToDouble(&outSeconds, newStr) == 0;
-					if(ok)
-						outSeconds += ((double)minutes + (double)hours * 60.) * 60.;
-				}
-			}
+				outSeconds += ((double)minutes + (double)hours * 60.) * 60.;
 		}
 		// "m:s"
 		else
 		{
-			wstring newStr{str, firstColon};
 			uint32_t minutes = 0;
-			ok = common::StrToUint(&minutes, newStr) == 0;
+			ok = CharsToUint(minutes, str, firstColon) &&
+				CharsToDouble(outSeconds, firstColon + 1, strEnd);
 			if(ok)
-			{
-				newStr = firstColon + 1;
-				ok = common::StrToDouble(&outSeconds, newStr) == 0;
-				if(ok)
-					outSeconds += (double)minutes * 60.;
-			}
+				outSeconds += (double)minutes * 60.;
 		}
 	}
-	else if(common::StrEnds(str, L"ns", true))
+	else if(StrEndsWith(str, strLen, RS2_TEXT("ns"), 2))
 	{
-		wstring newStr{str, str + (strLen - 2)};
-		ok = common::StrToDouble(&outSeconds, newStr) == 0;
+		ok = CharsToDouble(outSeconds, str, strEnd - 2);
 		if(ok)
 			outSeconds *= 1e-9;
 	}
-	else if(common::StrEnds(str, L"us", true))
+	else if(StrEndsWith(str, strLen, RS2_TEXT("us"), 2))
 	{
-		wstring newStr{str, str + (strLen - 2)};
-		ok = common::StrToDouble(&outSeconds, newStr) == 0;
+		ok = CharsToDouble(outSeconds, str, strEnd - 2);
 		if(ok)
 			outSeconds *= 1e-6;
 	}
-	else if(common::StrEnds(str, L"ms", true))
+	else if(StrEndsWith(str, strLen, RS2_TEXT("ms"), 2))
 	{
-		wstring newStr{str, str + (strLen - 2)};
-		ok = common::StrToDouble(&outSeconds, newStr) == 0;
+		ok = CharsToDouble(outSeconds, str, strEnd - 2);
 		if(ok)
 			outSeconds *= 1e-3;
 	}
-	else if(common::StrEnds(str, L"s", true))
-	{
-		wstring newStr{str, str + (strLen - 1)};
-		ok = common::StrToDouble(&outSeconds, newStr) == 0;
-	}
+	else if(StrEndsWith(str, strLen, RS2_TEXT("s"), 1))
+		ok = CharsToDouble(outSeconds, str, strEnd - 1);
 	// No unit: default is seconds.
 	else
-		ok = common::StrToDouble(&outSeconds, str) == 0;
+		ok = CharsToDouble(outSeconds, str, strEnd);
 
 	if(ok && negative)
 		outSeconds = -outSeconds;
 	return ok;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Float conversions
+
+// Ryu algorithm by Ulf Adams: https://github.com/ulfjack/ryu, float version.
+
+static const uint32_t FLOAT_MANTISSA_BITS = 23;
+static const int32_t FLOAT_BIAS = 127;
+static const int32_t FLOAT_POW5_INV_BITCOUNT = 59;
+static const int32_t FLOAT_POW5_BITCOUNT = 61;
+
+// floor(2^(pow5bits(i) - 1 + FLOAT_POW5_INV_BITCOUNT) / 5^i) + 1
+static const uint64_t FLOAT_POW5_INV_SPLIT[31] = {
+	576460752303423489u, 461168601842738791u, 368934881474191033u,
+	295147905179352826u, 472236648286964522u, 377789318629571618u,
+	302231454903657294u, 483570327845851670u, 386856262276681336u,
+	309485009821345069u, 495176015714152110u, 396140812571321688u,
+	316912650057057351u, 507060240091291761u, 405648192073033409u,
+	324518553658426727u, 519229685853482763u, 415383748682786211u,
+	332306998946228969u, 531691198313966350u, 425352958651173080u,
+	340282366920938464u, 544451787073501542u, 435561429658801234u,
+	348449143727040987u, 557518629963265579u, 446014903970612463u,
+	356811923176489971u, 570899077082383953u, 456719261665907162u,
+	365375409332725730u,
+};
+
+// 5^i normalized to FLOAT_POW5_BITCOUNT bits.
+static const uint64_t FLOAT_POW5_SPLIT[47] = {
+	1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+	2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+	2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+	2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+	2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+	2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+	2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+	1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+	1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+	1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+	1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+	1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+	1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+	1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+	1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+	1615587133892632177u, 2019483917365790221u,
+};
+
+// Returns ceil(log2(5^e)), or 1 for e == 0. Valid for 0 <= e <= 3528.
+static inline int32_t Pow5Bits(int32_t e)
+{
+	return (int32_t)(((uint32_t)e * 1217359u) >> 19) + 1;
+}
+
+// Returns floor(log10(2^e)). Valid for 0 <= e <= 1650.
+static inline uint32_t Log10Pow2(int32_t e)
+{
+	return ((uint32_t)e * 78913u) >> 18;
+}
+
+// Returns floor(log10(5^e)). Valid for 0 <= e <= 2620.
+static inline uint32_t Log10Pow5(int32_t e)
+{
+	return ((uint32_t)e * 732923u) >> 20;
+}
+
+static inline bool MultipleOfPowerOf5(uint32_t value, uint32_t p)
+{
+	uint32_t count = 0;
+	while(value % 5 == 0)
+	{
+		value /= 5;
+		++count;
+	}
+	return count >= p;
+}
+
+static inline bool MultipleOfPowerOf2(uint32_t value, uint32_t p)
+{
+	return (value & ((1u << p) - 1)) == 0;
+}
+
+static inline uint32_t MulShift32(uint32_t m, uint64_t factor, int32_t shift)
+{
+	assert(shift > 32);
+	const uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+	const uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+	const uint64_t sum = (bits0 >> 32) + bits1;
+	return (uint32_t)(sum >> (shift - 32));
+}
+
+// Converts finite, positive float given as IEEE bits to shortest decimal outMantissa * 10^outExponent.
+static void FloatToDecimal(uint32_t& outMantissa, int32_t& outExponent, uint32_t ieeeMantissa, uint32_t ieeeExponent)
+{
+	int32_t e2;
+	uint32_t m2;
+	if(ieeeExponent == 0)
+	{
+		// Subtract 2 so that the bounds computation has 2 additional bits.
+		e2 = 1 - FLOAT_BIAS - (int32_t)FLOAT_MANTISSA_BITS - 2;
+		m2 = ieeeMantissa;
+	}
+	else
+	{
+		e2 = (int32_t)ieeeExponent - FLOAT_BIAS - (int32_t)FLOAT_MANTISSA_BITS - 2;
+		m2 = (1u << FLOAT_MANTISSA_BITS) | ieeeMantissa;
+	}
+	const bool acceptBounds = (m2 & 1) == 0;
+
+	// Interval of valid decimal representations, multiplied by 4.
+	const uint32_t mv = 4 * m2;
+	const uint32_t mp = 4 * m2 + 2;
+	const uint32_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1 ? 1 : 0;
+	const uint32_t mm = 4 * m2 - 1 - mmShift;
+
+	// Convert to decimal power base.
+	uint32_t vr, vp, vm;
+	int32_t e10;
+	bool vmIsTrailingZeros = false;
+	bool vrIsTrailingZeros = false;
+	uint32_t lastRemovedDigit = 0;
+	if(e2 >= 0)
+	{
+		const uint32_t q = Log10Pow2(e2);
+		e10 = (int32_t)q;
+		const int32_t k = FLOAT_POW5_INV_BITCOUNT + Pow5Bits((int32_t)q) - 1;
+		const int32_t i = -e2 + (int32_t)q + k;
+		vr = MulShift32(mv, FLOAT_POW5_INV_SPLIT[q], i);
+		vp = MulShift32(mp, FLOAT_POW5_INV_SPLIT[q], i);
+		vm = MulShift32(mm, FLOAT_POW5_INV_SPLIT[q], i);
+		if(q != 0 && (vp - 1) / 10 <= vm / 10)
+		{
+			// One removed digit is needed even if the loop below doesn't run.
+			const int32_t l = FLOAT_POW5_INV_BITCOUNT + Pow5Bits((int32_t)(q - 1)) - 1;
+			lastRemovedDigit = MulShift32(mv, FLOAT_POW5_INV_SPLIT[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+		}
+		if(q <= 9)
+		{
+			// Only one of mp, mv and mm can be a multiple of 5, if any.
+			if(mv % 5 == 0)
+				vrIsTrailingZeros = MultipleOfPowerOf5(mv, q);
+			else if(acceptBounds)
+				vmIsTrailingZeros = MultipleOfPowerOf5(mm, q);
+			else
+				vp -= MultipleOfPowerOf5(mp, q) ? 1 : 0;
+		}
+	}
+	else
+	{
+		const uint32_t q = Log10Pow5(-e2);
+		e10 = (int32_t)q + e2;
+		const int32_t i = -e2 - (int32_t)q;
+		const int32_t k = Pow5Bits(i) - FLOAT_POW5_BITCOUNT;
+		int32_t j = (int32_t)q - k;
+		vr = MulShift32(mv, FLOAT_POW5_SPLIT[i], j);
+		vp = MulShift32(mp, FLOAT_POW5_SPLIT[i], j);
+		vm = MulShift32(mm, FLOAT_POW5_SPLIT[i], j);
+		if(q != 0 && (vp - 1) / 10 <= vm / 10)
+		{
+			j = (int32_t)q - 1 - (Pow5Bits(i + 1) - FLOAT_POW5_BITCOUNT);
+			lastRemovedDigit = MulShift32(mv, FLOAT_POW5_SPLIT[i + 1], j) % 10;
+		}
+		if(q <= 1)
+		{
+			// mv = 4 * m2, so it always has at least two trailing 0 bits.
+			vrIsTrailingZeros = true;
+			if(acceptBounds)
+				vmIsTrailingZeros = mmShift == 1;
+			else
+				--vp;
+		}
+		else if(q < 31)
+			vrIsTrailingZeros = MultipleOfPowerOf2(mv, q - 1);
+	}
+
+	// Find the shortest decimal representation in the interval.
+	int32_t removed = 0;
+	if(vmIsTrailingZeros || vrIsTrailingZeros)
+	{
+		// General case, which happens rarely.
+		while(vp / 10 > vm / 10)
+		{
+			vmIsTrailingZeros &= vm % 10 == 0;
+			vrIsTrailingZeros &= lastRemovedDigit == 0;
+			lastRemovedDigit = vr % 10;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++removed;
+		}
+		if(vmIsTrailingZeros)
+		{
+			while(vm % 10 == 0)
+			{
+				vrIsTrailingZeros &= lastRemovedDigit == 0;
+				lastRemovedDigit = vr % 10;
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+				++removed;
+			}
+		}
+		// Round to even if the exact number is .....50..0.
+		if(vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0)
+			lastRemovedDigit = 4;
+		// Take vr + 1 if vr is outside bounds or rounding up is needed.
+		outMantissa = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5) ? 1 : 0);
+	}
+	else
+	{
+		// Common case.
+		while(vp / 10 > vm / 10)
+		{
+			lastRemovedDigit = vr % 10;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++removed;
+		}
+		outMantissa = vr + ((vr == vm || lastRemovedDigit >= 5) ? 1 : 0);
+	}
+	outExponent = e10 + removed;
+}
+
+size_t FloatToChars(Char_t* dst, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32_t ieeeMantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+	const uint32_t ieeeExponent = (bits >> FLOAT_MANTISSA_BITS) & 0xFFu;
+	Char_t* dstCurr = dst;
+	if(bits >> 31)
+		*dstCurr++ = RS2_TEXT('-');
+
+	if(ieeeExponent == 0xFFu)
+	{
+		const Char_t* str = ieeeMantissa ? RS2_TEXT("nan") : RS2_TEXT("inf");
+		// NaN is written without sign.
+		if(ieeeMantissa)
+			dstCurr = dst;
+		for(; *str; ++str)
+			*dstCurr++ = *str;
+		return dstCurr - dst;
+	}
+	if(ieeeExponent == 0 && ieeeMantissa == 0)
+	{
+		*dstCurr++ = RS2_TEXT('0');
+		return dstCurr - dst;
+	}
+
+	uint32_t mantissa;
+	int32_t exponent;
+	FloatToDecimal(mantissa, exponent, ieeeMantissa, ieeeExponent);
+
+	Char_t digits[10];
+	int32_t digitCount = 0;
+	for(; mantissa; mantissa /= 10)
+		digits[digitCount++] = (Char_t)(RS2_TEXT('0') + mantissa % 10);
+	// Value is 0.DIGITS * 10^pointPos.
+	const int32_t pointPos = exponent + digitCount;
+
+	// Same choice between fixed and scientific notation as in printf %g, but for 9 significant digits.
+	if(pointPos > -4 && pointPos <= 9)
+	{
+		if(pointPos <= 0)
+		{
+			*dstCurr++ = RS2_TEXT('0');
+			*dstCurr++ = RS2_TEXT('.');
+			for(int32_t i = pointPos; i < 0; ++i)
+				*dstCurr++ = RS2_TEXT('0');
+			for(int32_t i = digitCount; i--; )
+				*dstCurr++ = digits[i];
+		}
+		else
+		{
+			const int32_t intDigitCount = digitCount < pointPos ? digitCount : pointPos;
+			for(int32_t i = 0; i < intDigitCount; ++i)
+				*dstCurr++ = digits[digitCount - 1 - i];
+			for(int32_t i = digitCount; i < pointPos; ++i)
+				*dstCurr++ = RS2_TEXT('0');
+			if(digitCount > pointPos)
+			{
+				*dstCurr++ = RS2_TEXT('.');
+				for(int32_t i = digitCount - pointPos; i--; )
+					*dstCurr++ = digits[i];
+			}
+		}
+	}
+	else
+	{
+		*dstCurr++ = digits[digitCount - 1];
+		if(digitCount > 1)
+		{
+			*dstCurr++ = RS2_TEXT('.');
+			for(int32_t i = digitCount - 1; i--; )
+				*dstCurr++ = digits[i];
+		}
+		int32_t exp10 = pointPos - 1;
+		*dstCurr++ = RS2_TEXT('e');
+		if(exp10 < 0)
+		{
+			*dstCurr++ = RS2_TEXT('-');
+			exp10 = -exp10;
+		}
+		else
+			*dstCurr++ = RS2_TEXT('+');
+		// At least 2 digits, like printf.
+		if(exp10 >= 10)
+			*dstCurr++ = (Char_t)(RS2_TEXT('0') + exp10 / 10);
+		else
+			*dstCurr++ = RS2_TEXT('0');
+		*dstCurr++ = (Char_t)(RS2_TEXT('0') + exp10 % 10);
+	}
+	assert((size_t)(dstCurr - dst) <= FLOAT_TO_CHARS_MAX_LEN);
+	return dstCurr - dst;
+}
+
+void AppendFloat(String_t& out, float value)
+{
+	Char_t buf[FLOAT_TO_CHARS_MAX_LEN];
+	out.append(buf, FloatToChars(buf, value));
+}
+
+/*
+Parses simple decimal number: [sign] digits [. digits] [e [sign] digits]
+to mantissa * 10^exponent. Returns false if the syntax is different or the
+mantissa doesn't fit in 19 digits, so the caller must use slow path.
+*/
+static bool ParseSimpleDecimal(bool& outNegative, uint64_t& outMantissa, int32_t& outExponent, const Char_t* begin, const Char_t* end)
+{
+	const Char_t* curr = begin;
+	outNegative = false;
+	if(curr < end && (*curr == RS2_TEXT('-') || *curr == RS2_TEXT('+')))
+	{
+		outNegative = *curr == RS2_TEXT('-');
+		++curr;
+	}
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+	uint32_t digitCount = 0, significantDigitCount = 0;
+	bool afterPoint = false;
+	for(; curr < end; ++curr)
+	{
+		if(*curr >= RS2_TEXT('0') && *curr <= RS2_TEXT('9'))
+		{
+			++digitCount;
+			if(mantissa != 0 || *curr != RS2_TEXT('0'))
+			{
+				if(++significantDigitCount > 19)
+					return false;
+				mantissa = mantissa * 10 + (uint32_t)(*curr - RS2_TEXT('0'));
+			}
+			if(afterPoint)
+				--exponent;
+		}
+		else if(*curr == RS2_TEXT('.') && !afterPoint)
+			afterPoint = true;
+		else
+			break;
+	}
+	if(digitCount == 0)
+		return false;
+	if(curr < end && (*curr == RS2_TEXT('e') || *curr == RS2_TEXT('E')))
+	{
+		++curr;
+		bool negativeExponent = false;
+		if(curr < end && (*curr == RS2_TEXT('-') || *curr == RS2_TEXT('+')))
+		{
+			negativeExponent = *curr == RS2_TEXT('-');
+			++curr;
+		}
+		if(curr == end)
+			return false;
+		int32_t explicitExponent = 0;
+		for(; curr < end && *curr >= RS2_TEXT('0') && *curr <= RS2_TEXT('9'); ++curr)
+		{
+			if(explicitExponent > 10000)
+				return false;
+			explicitExponent = explicitExponent * 10 + (int32_t)(*curr - RS2_TEXT('0'));
+		}
+		exponent += negativeExponent ? -explicitExponent : explicitExponent;
+	}
+	if(curr != end)
+		return false;
+	outMantissa = mantissa;
+	outExponent = exponent;
+	return true;
+}
+
+/*
+Calls strtof/wcstof or strtod/wcstod on null-terminated copy of [begin, end),
+made on the stack if it is short enough, otherwise on the heap.
+*/
+template<typename T, typename Func_t>
+static bool ParseNumberSlow(T& outValue, const Char_t* begin, const Char_t* end, Func_t func)
+{
+	const size_t len = end - begin;
+	if(len == 0)
+		return false;
+	Char_t stackBuf[64];
+	std::vector<Char_t> heapBuf;
+	Char_t* buf = stackBuf;
+	if(len >= sizeof(stackBuf) / sizeof(stackBuf[0]))
+	{
+		heapBuf.resize(len + 1);
+		buf = heapBuf.data();
+	}
+	MemCpy(buf, begin, len);
+	buf[len] = RS2_TEXT('\0');
+	Char_t* parseEnd = nullptr;
+	outValue = func(buf, &parseEnd);
+	return parseEnd == buf + len;
+}
+
+bool CharsToFloat(float& outValue, const Char_t* begin, const Char_t* end)
+{
+	// Exact when both mantissa and power of 10 are exactly representable as float.
+	static const float POW10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	bool negative;
+	uint64_t mantissa;
+	int32_t exponent;
+	if(ParseSimpleDecimal(negative, mantissa, exponent, begin, end) &&
+		mantissa <= (1u << 24) && exponent >= -10 && exponent <= 10)
+	{
+		float value = (float)mantissa;
+		if(exponent < 0)
+			value /= POW10[-exponent];
+		else
+			value *= POW10[exponent];
+		outValue = negative ? -value : value;
+		return true;
+	}
+#ifdef RS2_UTF8
+	return ParseNumberSlow(outValue, begin, end, strtof);
+#else
+	return ParseNumberSlow(outValue, begin, end, wcstof);
+#endif
+}
+
+bool CharsToDouble(double& outValue, const Char_t* begin, const Char_t* end)
+{
+	static const double POW10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	bool negative;
+	uint64_t mantissa;
+	int32_t exponent;
+	if(ParseSimpleDecimal(negative, mantissa, exponent, begin, end) &&
+		mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+	{
+		double value = (double)mantissa;
+		if(exponent < 0)
+			value /= POW10[-exponent];
+		else
+			value *= POW10[exponent];
+		outValue = negative ? -value : value;
+		return true;
+	}
+#ifdef RS2_UTF8
+	return ParseNumberSlow(outValue, begin, end, strtod);
+#else
+	return ParseNumberSlow(outValue, begin, end, wcstod);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Integer conversions
+
+void AppendInt(String_t& out, int32_t value)
+{
+	if(value < 0)
+	{
+		out += RS2_TEXT('-');
+		// Correct also for INT32_MIN.
+		AppendUint(out, 0u - (uint32_t)value);
+	}
+	else
+		AppendUint(out, (uint32_t)value);
+}
+
+void AppendUint(String_t& out, uint32_t value, uint32_t base)
+{
+	assert(base == 10 || base == 16);
+	Char_t buf[10];
+	size_t len = 0;
+	do
+	{
+		buf[len++] = RS2_TEXT("0123456789ABCDEF")[value % base];
+		value /= base;
+	}
+	while(value);
+	const size_t oldLen = out.length();
+	out.resize(oldLen + len);
+	for(size_t i = 0; i < len; ++i)
+		out[oldLen + i] = buf[len - 1 - i];
+}
+
+bool CharsToInt(int32_t& outValue, const Char_t* begin, const Char_t* end)
+{
+	const bool negative = begin < end && *begin == RS2_TEXT('-');
+	if(begin < end && (*begin == RS2_TEXT('-') || *begin == RS2_TEXT('+')))
+		++begin;
+	uint32_t absValue;
+	if(!CharsToUint(absValue, begin, end))
+		return false;
+	if(negative)
+	{
+		if(absValue > 0x80000000u)
+			return false;
+		outValue = (int32_t)(0u - absValue);
+	}
+	else
+	{
+		if(absValue > 0x7FFFFFFFu)
+			return false;
+		outValue = (int32_t)absValue;
+	}
+	return true;
+}
+
+bool CharsToUint(uint32_t& outValue, const Char_t* begin, const Char_t* end, uint32_t base)
+{
+	assert(base == 10 || base == 16);
+	if(begin == end)
+		return false;
+	uint64_t value = 0;
+	for(; begin < end; ++begin)
+	{
+		uint32_t digit;
+		if(*begin >= RS2_TEXT('0') && *begin <= RS2_TEXT('9'))
+			digit = (uint32_t)(*begin - RS2_TEXT('0'));
+		else if(base == 16 && *begin >= RS2_TEXT('A') && *begin <= RS2_TEXT('F'))
+			digit = (uint32_t)(*begin - RS2_TEXT('A')) + 10;
+		else if(base == 16 && *begin >= RS2_TEXT('a') && *begin <= RS2_TEXT('f'))
+			digit = (uint32_t)(*begin - RS2_TEXT('a')) + 10;
+		else
+			return false;
+		value = value * base + digit;
+		if(value > UINT32_MAX)
+			return false;
+	}
+	outValue = (uint32_t)value;
+	return true;
+}
+
 const common::VEC2 VEC2_MIN = common::VEC2(-FLT_MAX, -FLT_MAX);
 const common::VEC3 VEC3_MIN = common::VEC3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
 const common::VEC4 VEC4_MIN = common::VEC4(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX);
@@ -1,7 +1,11 @@
 #include <RegScript2.hpp>
 #include <RegScript2_TokDoc.hpp>
+#include <RegScript2_Static.hpp>
+#include <RegScript2_Binary.hpp>
+#include <RegScript2_DebugPrint.hpp>
 #include <Common/Tokenizer.hpp>
 #include <memory>
+#include <thread>
 #include <cstddef>
 #include <gtest/gtest.h>
 
@@ -116,6 +120,148 @@ TEST(Utils, FriendlyStrToSeconds)
 	EXPECT_DOUBLE_EQ((100. * 60. + 20.) * 60. + 55.5, seconds);
 }
 
+static wstring FloatToCharsString(float value)
+{
+	wchar_t buf[FLOAT_TO_CHARS_MAX_LEN];
+	return wstring(buf, FloatToChars(buf, value));
+}
+
+TEST(Utils, FloatToChars)
+{
+	EXPECT_EQ(L"0", FloatToCharsString(0.f));
+	EXPECT_EQ(L"-0", FloatToCharsString(-0.f));
+	EXPECT_EQ(L"1", FloatToCharsString(1.f));
+	EXPECT_EQ(L"-2.5", FloatToCharsString(-2.5f));
+	EXPECT_EQ(L"0.1", FloatToCharsString(0.1f));
+	EXPECT_EQ(L"3.14", FloatToCharsString(3.14f));
+	EXPECT_EQ(L"0.0001", FloatToCharsString(1e-4f));
+	EXPECT_EQ(L"1e-05", FloatToCharsString(1e-5f));
+	EXPECT_EQ(L"123456790", FloatToCharsString(123456789.f));
+	EXPECT_EQ(L"1e+10", FloatToCharsString(1e10f));
+	EXPECT_EQ(L"3.4028235e+38", FloatToCharsString(FLT_MAX));
+	EXPECT_EQ(L"1e-45", FloatToCharsString(1e-45f));
+	EXPECT_EQ(L"inf", FloatToCharsString(INFINITY));
+	EXPECT_EQ(L"-inf", FloatToCharsString(-INFINITY));
+
+	// Round trip is bit-exact.
+	uint32_t bits = 1;
+	for(uint32_t i = 0; i < 100000; ++i)
+	{
+		bits = bits * 1664525u + 1013904223u;
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		if(!isfinite(value))
+			continue;
+		const wstring str = FloatToCharsString(value);
+		float parsedValue = 0.f;
+		ASSERT_TRUE(CharsToFloat(parsedValue, str.data(), str.data() + str.length()));
+		ASSERT_EQ(0, memcmp(&value, &parsedValue, sizeof(value))) << str;
+	}
+}
+
+TEST(TokDoc, FloatsBitExact)
+{
+	uint32_t bits = 1;
+	for(uint32_t i = 0; i < 10000; ++i)
+	{
+		common::VEC3 value;
+		for(uint32_t j = 0; j < 3; ++j)
+		{
+			do
+			{
+				bits = bits * 1664525u + 1013904223u;
+				memcpy(&value[j], &bits, sizeof(float));
+			}
+			while(!isfinite(value[j]));
+		}
+		common::tokdoc::Node node;
+		rs2::SaveFloatsToTokDoc(node, &value.x, 3);
+		EXPECT_EQ(3, node.GetChildCount());
+		common::VEC3 loadedValue;
+		ASSERT_TRUE(rs2::LoadFloatsFromTokDoc(&loadedValue.x, 3, node));
+		ASSERT_EQ(0, memcmp(&value, &loadedValue, sizeof(value)));
+		EXPECT_FALSE(rs2::LoadFloatsFromTokDoc(&loadedValue.x, 2, node));
+		EXPECT_FALSE(rs2::LoadFloatsFromTokDoc(&loadedValue.x, 4, node));
+		EXPECT_FALSE(rs2::LoadFloatsFromTokDoc(&loadedValue.x, 1, node));
+	}
+}
+
+TEST(Utils, CharsToFloat)
+{
+	const wchar_t* str = L"1.5;";
+	float value = 0.f;
+	EXPECT_TRUE(CharsToFloat(value, str, str + 3));
+	EXPECT_EQ(1.5f, value);
+	EXPECT_FALSE(CharsToFloat(value, str, str + 4));
+	EXPECT_FALSE(CharsToFloat(value, str, str));
+
+	str = L"-12e-3";
+	EXPECT_TRUE(CharsToFloat(value, str, str + wcslen(str)));
+	EXPECT_EQ(-12e-3f, value);
+	str = L"0.000000000000000000000000000000000000000000001";
+	EXPECT_TRUE(CharsToFloat(value, str, str + wcslen(str)));
+	EXPECT_EQ(1e-45f, value);
+	str = L"16777217";
+	EXPECT_TRUE(CharsToFloat(value, str, str + wcslen(str)));
+	EXPECT_EQ(16777216.f, value);
+	str = L"1e";
+	EXPECT_FALSE(CharsToFloat(value, str, str + wcslen(str)));
+	str = L"1.2.3";
+	EXPECT_FALSE(CharsToFloat(value, str, str + wcslen(str)));
+	// Longer than buffer on the stack.
+	const wstring longStr = L"0." + wstring(100, L'0') + L"1e+101";
+	EXPECT_TRUE(CharsToFloat(value, longStr.data(), longStr.data() + longStr.length()));
+	EXPECT_EQ(1.f, value);
+
+	double doubleValue = 0.;
+	str = L"0.1";
+	EXPECT_TRUE(CharsToDouble(doubleValue, str, str + wcslen(str)));
+	EXPECT_EQ(0.1, doubleValue);
+}
+
+// Narrow functions used with RS2_UTF8, tested in default build too.
+TEST(Utils, NarrowStrings)
+{
+	EXPECT_EQ(4, rs2::StrLen("Name"));
+	EXPECT_EQ(0, rs2::StrNICmp("NAME", "name", 4));
+	EXPECT_NE(0, rs2::StrNICmp("Name", "Nam_", 4));
+	EXPECT_EQ(0, rs2::StrNICmp("Name", "Nam_", 3));
+	EXPECT_EQ('a', rs2::CharToLower('A'));
+	EXPECT_EQ('1', rs2::CharToLower('1'));
+	// Non-ASCII bytes of UTF-8 are not changed.
+	EXPECT_EQ('\xC3', rs2::CharToLower('\xC3'));
+
+	// "Name\u00C4\U0001F600" - 2-byte and 4-byte UTF-8 sequence.
+	const char* const utf8 = "Name\xC3\x84\xF0\x9F\x98\x80";
+	const size_t utf8Len = rs2::StrLen(utf8);
+	const char16_t utf16[] = { u'N', u'a', u'm', u'e', 0x00C4, 0xD83D, 0xDE00 };
+	const size_t utf16Len = sizeof(utf16) / sizeof(utf16[0]);
+	std::u16string u16;
+	rs2::AppendUtf16(u16, utf8, utf8Len);
+	EXPECT_EQ(std::u16string(utf16, utf16Len), u16);
+	std::string u8;
+	rs2::AppendUtf8(u8, utf16, utf16Len);
+	EXPECT_EQ(std::string(utf8), u8);
+	wstring wide;
+	rs2::AppendWide(wide, utf16, utf16Len);
+	u16.clear();
+	rs2::AppendUtf16(u16, wide.data(), wide.length());
+	EXPECT_EQ(std::u16string(utf16, utf16Len), u16);
+	u8.clear();
+	rs2::AppendUtf8(u8, wide.data(), wide.length());
+	EXPECT_EQ(std::string(utf8), u8);
+
+	// Invalid UTF-8 becomes U+FFFD.
+	u16.clear();
+	rs2::AppendUtf16(u16, "A\xFF", 2);
+	EXPECT_EQ(std::u16string(u"A\uFFFD"), u16);
+
+	// Same hash from UTF-8 and wchar_t, so chunked binary files are compatible.
+	EXPECT_EQ(rs2::HashName(wide.data(), wide.length()), rs2::HashName(utf8, utf8Len));
+	EXPECT_EQ(rs2::HashName(L"NAME", 4, false), rs2::HashName("name", 4, false));
+	EXPECT_NE(rs2::HashName(L"NAME", 4), rs2::HashName("name", 4));
+}
+
 enum OldEnumWithoutValues
 {
 	OldEnumWithoutValues_Value0,
@@ -160,6 +306,54 @@ static rs2::TypedEnumDesc<NewEnumWithValues> g_NewEnumWithValuesDesc = {
 	NewEnumWithValuesValues
 };
 
+TEST(Utils, NameIndex)
+{
+	const wchar_t* const names[] = { L"Alpha", L"beta", L"ALPHA", L"Gamma" };
+	rs2::NameIndex index;
+	EXPECT_EQ(rs2::NameIndex::INVALID_VALUE, index.Find(L"Alpha", true));
+	// Starts small to exercise growing.
+	index.Reset(1);
+	for(size_t i = 0; i < _countof(names); ++i)
+		index.Add(names[i], i);
+	std::vector<wstring> moreNames(100);
+	for(size_t i = 0; i < moreNames.size(); ++i)
+	{
+		Format(moreNames[i], L"Name%u", (uint32_t)i);
+		index.Add(moreNames[i].c_str(), 100 + i);
+	}
+
+	EXPECT_EQ(0, index.Find(L"Alpha", true));
+	EXPECT_EQ(2, index.Find(L"ALPHA", true));
+	EXPECT_EQ(0, index.Find(L"alpha", false));
+	EXPECT_EQ(1, index.Find(L"BETA", false));
+	EXPECT_EQ(3, index.Find(L"Gamma_", 5, true));
+	EXPECT_EQ(199, index.Find(L"name99", false));
+	EXPECT_EQ(rs2::NameIndex::INVALID_VALUE, index.Find(L"beta", 3, true));
+	EXPECT_EQ(rs2::NameIndex::INVALID_VALUE, index.Find(L"Delta", false));
+}
+
+TEST(Utils, DescArena)
+{
+	rs2::DescArena arena(256);
+	const wchar_t* const str1 = arena.Intern(L"Range");
+	EXPECT_EQ(wstring(L"Range"), str1);
+	EXPECT_EQ(str1, arena.Intern(L"Range"));
+	EXPECT_EQ(str1, arena.Intern(L"Ranges", 5));
+	EXPECT_NE(str1, arena.Intern(L"range"));
+	EXPECT_TRUE(arena.Contains(str1));
+	EXPECT_FALSE(arena.Contains(&arena));
+
+	void* const small = arena.Allocate(3, 1);
+	void* const aligned = arena.Allocate(16, 16);
+	EXPECT_EQ(0, (uintptr_t)aligned % 16);
+	EXPECT_NE(small, aligned);
+	// Bigger than the block.
+	void* const big = arena.Allocate(1000, 8);
+	EXPECT_TRUE(arena.Contains(big));
+	EXPECT_GE(arena.GetUsedSize(), 3 + 16 + 1000u);
+	EXPECT_GE(arena.GetFootprint(), arena.GetUsedSize());
+}
+
 TEST(Utils, OldEnumWithoutValues)
 {
 	EXPECT_EQ(0, g_OldEnumWithoutValuesDesc.GetValue(0));
@@ -171,6 +365,9 @@ TEST(Utils, OldEnumWithoutValues)
 	EXPECT_EQ(1, g_OldEnumWithoutValuesDesc.FindItemByName(L"VALUE1", false));
 	EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, g_OldEnumWithoutValuesDesc.FindItemByName(L"NonExisting", false));
 	EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, g_OldEnumWithoutValuesDesc.FindItemByName(L"NonExisting", true));
+	// Longer than any item name, so item names must not be read past their end.
+	EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, g_OldEnumWithoutValuesDesc.FindItemByName(L"Value1_LongerThanAnyName", 24, false));
+	EXPECT_EQ(1, g_OldEnumWithoutValuesDesc.FindItemByName(L"Value1_LongerThanAnyName", 6, true));
 
 	EXPECT_EQ(1, g_OldEnumWithoutValuesDesc.FindItemByValue(1));
 	EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, g_OldEnumWithoutValuesDesc.FindItemByValue(666));
@@ -239,6 +436,53 @@ TEST(Utils, NewEnumWithValues)
 	EXPECT_EQ(-666, (int32_t)val);
 }
 
+TEST(Utils, LargeEnumIndex)
+{
+	// Names Item0..Item299. Dense values: every third integer from -300, plus duplicate of the first one at the end.
+	const size_t itemCount = 301;
+	std::vector<wstring> nameStrs(itemCount);
+	std::vector<const wchar_t*> names(itemCount);
+	std::vector<int32_t> denseValues(itemCount), sparseValues(itemCount);
+	for(size_t i = 0; i < itemCount - 1; ++i)
+	{
+		Format(nameStrs[i], L"Item%u", (uint32_t)i);
+		denseValues[i] = (int32_t)i * 3 - 300;
+		sparseValues[i] = (int32_t)i * 1000000 - 150000000;
+	}
+	nameStrs[itemCount - 1] = L"ITEM0";
+	denseValues[itemCount - 1] = denseValues[0];
+	sparseValues[itemCount - 1] = sparseValues[0];
+	for(size_t i = 0; i < itemCount; ++i)
+		names[i] = nameStrs[i].c_str();
+
+	const rs2::EnumDesc denseDesc(L"DenseEnum", itemCount, names.data(), denseValues.data());
+	const rs2::EnumDesc sparseDesc(L"SparseEnum", itemCount, names.data(), sparseValues.data());
+	for(const rs2::EnumDesc* desc : { &denseDesc, &sparseDesc })
+	{
+		EXPECT_EQ(123, desc->FindItemByName(L"Item123", true));
+		EXPECT_EQ(123, desc->FindItemByName(L"item123", false));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByName(L"item123", true));
+		EXPECT_EQ(300, desc->FindItemByName(L"ITEM0", true));
+		EXPECT_EQ(0, desc->FindItemByName(L"ITEM0", false));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByName(L"Item300", false));
+
+		for(size_t i = 0; i < itemCount - 1; ++i)
+			EXPECT_EQ(i, desc->FindItemByValue(desc->ItemValues[i]));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByValue(desc->ItemValues[0] - 1));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByValue(desc->ItemValues[0] + 1));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByValue(desc->ItemValues[299] + 1));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByValue(INT32_MIN));
+		EXPECT_EQ(rs2::EnumDesc::INVALID_INDEX, desc->FindItemByValue(INT32_MAX));
+
+		wstring str;
+		desc->ValueToStr(str, desc->ItemValues[42]);
+		EXPECT_EQ(L"Item42", str);
+		int32_t val = 0;
+		EXPECT_TRUE(desc->StrToValue(val, L"item299", false, false));
+		EXPECT_EQ(desc->ItemValues[299], val);
+	}
+}
+
 class SimpleStruct
 {
 public:
@@ -464,6 +708,49 @@ TEST_F(Fixture1, ContainerCopyObj)
 	obj2.CheckDefaultValues();
 }
 
+TEST_F(Fixture1, ContainerLayoutPlan)
+{
+	typedef rs2::LayoutEntry::KIND KIND;
+	const std::vector<rs2::LayoutEntry>& entries = m_ContainerStructDesc->GetLayoutPlan().Entries;
+	// StructParam: begin, 6 params, end. FixedSizeArrayParam: begin, 3 elements, end.
+	ASSERT_EQ(13, entries.size());
+
+	EXPECT_EQ(KIND::STRUCT_BEGIN, entries[0].Kind);
+	EXPECT_EQ(7, entries[0].EndIndex);
+	EXPECT_EQ(offsetof(ContainerStruct, StructParam), entries[0].Offset);
+	EXPECT_EQ(KIND::PARAM, entries[2].Kind);
+	EXPECT_EQ(1, entries[2].Depth);
+	EXPECT_EQ(wstring(L"IntParam"), entries[2].Name);
+	EXPECT_EQ(offsetof(ContainerStruct, StructParam) + offsetof(SimpleStruct, IntParam), entries[2].Offset);
+	EXPECT_EQ(KIND::STRUCT_END, entries[7].Kind);
+
+	EXPECT_EQ(KIND::ARRAY_BEGIN, entries[8].Kind);
+	EXPECT_EQ(12, entries[8].EndIndex);
+	EXPECT_EQ(KIND::PARAM, entries[10].Kind);
+	EXPECT_TRUE(entries[10].IsArrayElement());
+	EXPECT_EQ(1, entries[10].ElementIndex);
+	EXPECT_EQ(0, entries[10].Depth);
+	EXPECT_EQ(offsetof(ContainerStruct, FixedSizeArrayParam) + sizeof(rs2::UintParam), entries[10].Offset);
+	EXPECT_EQ(KIND::ARRAY_END, entries[12].Kind);
+}
+
+TEST_F(Fixture1, CopyStructDesc)
+{
+	const size_t entryCount = m_SimpleStructDesc->GetLayoutPlan().Entries.size();
+	rs2::StructDesc copy = *m_SimpleStructDesc;
+	EXPECT_EQ(1, copy.Find(L"IntParam"));
+	copy.AddParam(L"ExtraParam", 0, new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+	EXPECT_EQ(entryCount + 1, copy.GetLayoutPlan().Entries.size());
+	EXPECT_EQ(entryCount, copy.Find(L"ExtraParam"));
+	// Source is not affected.
+	EXPECT_EQ(entryCount, m_SimpleStructDesc->GetLayoutPlan().Entries.size());
+	EXPECT_EQ((size_t)-1, m_SimpleStructDesc->Find(L"ExtraParam"));
+
+	copy = *m_SimpleStructDesc;
+	EXPECT_EQ(entryCount, copy.GetLayoutPlan().Entries.size());
+	EXPECT_EQ((size_t)-1, copy.Find(L"ExtraParam"));
+}
+
 TEST_F(Fixture1, SimpleTokDocLoad)
 {
 	const wchar_t* const DOC =
@@ -962,6 +1249,77 @@ TEST(Math, TokDocLoadOptionalAndNotFound)
 	EXPECT_TRUE(printer.TextContains(L"Vec4Param"));
 }
 
+class StringBufferedPrinter : public rs2::BufferedPrinter
+{
+public:
+	wstring Text;
+	size_t FlushCount = 0;
+
+	explicit StringBufferedPrinter(size_t bufferCapacity) : rs2::BufferedPrinter(bufferCapacity) { }
+
+protected:
+	virtual void Flush(const wchar_t* data, size_t dataLen)
+	{
+		Text.append(data, dataLen);
+		++FlushCount;
+	}
+};
+
+TEST(DebugPrint, BufferedPrinter)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	ContainerStruct obj;
+	obj.SetCustomValues();
+
+	StringBufferedPrinter printer(64);
+	rs2::DebugPrintObj(printer, &obj, *containerStructDesc);
+	printer.FlushBuffer();
+	EXPECT_EQ(
+		L"StructParam:\n"
+		L"\tBoolParam = false\n"
+		L"\tIntParam = -20\n"
+		L"\tUintParam = 124\n"
+		L"\tFloatParam = 13.5\n"
+		L"\tStringParam = ABC\n"
+		L"\tGameTimeParam = 123ms\n"
+		L"FixedSizeArrayParam[0] = 57005\n"
+		L"FixedSizeArrayParam[1] = 57006\n"
+		L"FixedSizeArrayParam[2] = 57007\n",
+		printer.Text);
+	// Flushed in blocks of whole lines, not line by line.
+	EXPECT_GT(printer.FlushCount, 1u);
+	EXPECT_LT(printer.FlushCount, 10u);
+
+	// Indentation is not limited.
+	StringBufferedPrinter deepPrinter(64);
+	rs2::DebugPrintParam(deepPrinter, &obj.FixedSizeArrayParam[0], L"Deep", *containerStructDesc->GetParamDesc(1), 100);
+	deepPrinter.FlushBuffer();
+	const wstring deepIndent(100, L'\t');
+	EXPECT_EQ(
+		deepIndent + L"Deep[0] = 57005\n" +
+		deepIndent + L"Deep[1] = 57006\n" +
+		deepIndent + L"Deep[2] = 57007\n",
+		deepPrinter.Text);
+}
+
+TEST(DebugPrint, FilePrinter)
+{
+	FILE* file = tmpfile();
+	ASSERT_NE(nullptr, file);
+	{
+		rs2::FilePrinter printer(file);
+		printer.printf(L"A%d", 1);
+		const wchar_t* const line = L"\u00E9\u20AC";
+		printer.PrintLine(line, wcslen(line));
+	}
+	rewind(file);
+	char buf[32] = {};
+	const size_t len = fread(buf, 1, sizeof(buf), file);
+	fclose(file);
+	EXPECT_EQ(string("A1\n\xC3\xA9\xE2\x82\xAC\n"), string(buf, len));
+}
+
 TEST(TokDoc, SimpleStructTokDocSaveLoad)
 {
 	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
@@ -1138,6 +1496,428 @@ TEST(TokDoc, MathStructTokDocStringSaveLoad)
 	}
 }
 
+static wstring SaveObjToTokDocString(const void* obj, const rs2::StructDesc& structDesc)
+{
+	wstring doc;
+	common::tokdoc::Node rootNode;
+	rs2::SaveObjToTokDoc(rootNode, obj, structDesc);
+	common::TokenWriter tokenWriter(&doc);
+	rootNode.SaveChildren(tokenWriter);
+	return doc;
+}
+
+static wstring SaveObjToTokDocStreamString(const void* obj, const rs2::StructDesc& structDesc)
+{
+	wstring doc;
+	common::TokenWriter tokenWriter(&doc);
+	rs2::SaveObjToTokDocStream(tokenWriter, obj, structDesc);
+	return doc;
+}
+
+TEST(TokDoc, TokDocStreamSameAsNodes)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> derivedStructDesc = DerivedStruct::CreateStructDesc(simpleStructDesc);
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	{
+		SimpleStruct obj;
+		obj.SetCustomValues();
+		EXPECT_EQ(SaveObjToTokDocString(&obj, *simpleStructDesc), SaveObjToTokDocStreamString(&obj, *simpleStructDesc));
+	}
+	{
+		DerivedStruct obj;
+		obj.SetCustomValues();
+		EXPECT_EQ(SaveObjToTokDocString(&obj, *derivedStructDesc), SaveObjToTokDocStreamString(&obj, *derivedStructDesc));
+	}
+	{
+		MathStruct obj;
+		obj.SetCustomValues();
+		EXPECT_EQ(SaveObjToTokDocString(&obj, *MathStruct::GetStructDesc()), SaveObjToTokDocStreamString(&obj, *MathStruct::GetStructDesc()));
+	}
+
+	wstring doc;
+	{
+		ContainerStruct obj;
+		obj.SetCustomValues();
+		doc = SaveObjToTokDocStreamString(&obj, *containerStructDesc);
+		EXPECT_EQ(SaveObjToTokDocString(&obj, *containerStructDesc), doc);
+	}
+	{
+		common::tokdoc::Node rootNode;
+		common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+		tokenizer.Next();
+		rootNode.LoadChildren(tokenizer);
+		ContainerStruct obj;
+		bool ok = rs2::LoadObjFromTokDoc(&obj, *containerStructDesc, rootNode,
+			rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED));
+		EXPECT_TRUE(ok);
+		obj.CheckCustomValues();
+	}
+}
+
+template<typename Struct_t>
+static bool LoadObjFromTokDocStreamString(Struct_t& obj, const rs2::StructDesc& structDesc, const wstring& doc, uint32_t flags)
+{
+	common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+	tokenizer.Next();
+	const bool ok = rs2::LoadObjFromTokDocStream(&obj, structDesc, tokenizer, rs2::STokDocLoadConfig(flags));
+	EXPECT_TRUE(tokenizer.QueryEOF());
+	return ok;
+}
+
+TEST(TokDoc, TokDocStreamLoad)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> derivedStructDesc = DerivedStruct::CreateStructDesc(simpleStructDesc);
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	{
+		SimpleStruct obj;
+		obj.SetCustomValues();
+		const wstring doc = SaveObjToTokDocString(&obj, *simpleStructDesc);
+		SimpleStruct loadedObj;
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(loadedObj, *simpleStructDesc, doc, rs2::TOKDOC_FLAG_REQUIRED));
+		loadedObj.CheckCustomValues();
+	}
+	{
+		DerivedStruct obj;
+		obj.SetCustomValues();
+		const wstring doc = SaveObjToTokDocString(&obj, *derivedStructDesc);
+		DerivedStruct loadedObj;
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(loadedObj, *derivedStructDesc, doc, rs2::TOKDOC_FLAG_REQUIRED));
+		loadedObj.CheckCustomValues();
+	}
+	{
+		ContainerStruct obj;
+		obj.SetCustomValues();
+		const wstring doc = SaveObjToTokDocString(&obj, *containerStructDesc);
+		ContainerStruct loadedObj;
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(loadedObj, *containerStructDesc, doc, rs2::TOKDOC_FLAG_REQUIRED));
+		loadedObj.CheckCustomValues();
+	}
+	{
+		MathStruct obj;
+		obj.SetCustomValues();
+		const wstring doc = SaveObjToTokDocString(&obj, *MathStruct::GetStructDesc());
+		MathStruct loadedObj;
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(loadedObj, *MathStruct::GetStructDesc(), doc, rs2::TOKDOC_FLAG_REQUIRED));
+		loadedObj.CheckCustomValues();
+	}
+
+	// Any order, unknown and repeated parameters.
+	{
+		const wstring doc =
+			L"\"GameTimeParam\"=\"0.123\"; \"Unknown\"={ 1; { \"a\"=2; }; }; \"StringParam\"=\"ABC\"; "
+			L"\"FloatParam\"=13.5; \"UintParam\"=124; \"IntParam\"=-20; \"BoolParam\"=false; \"IntParam\"=1;";
+		SimpleStruct obj;
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(obj, *simpleStructDesc, doc, rs2::TOKDOC_FLAG_REQUIRED));
+		obj.CheckCustomValues();
+	}
+	// Missing parameters.
+	{
+		const wstring doc = L"\"IntParam\"=-20;";
+		SimpleStruct obj;
+		EXPECT_THROW(LoadObjFromTokDocStreamString(obj, *simpleStructDesc, doc, rs2::TOKDOC_FLAG_REQUIRED), common::Error);
+		obj.SetCustomValues();
+		EXPECT_FALSE(LoadObjFromTokDocStreamString(obj, *simpleStructDesc, doc, rs2::TOKDOC_FLAG_OPTIONAL | rs2::TOKDOC_FLAG_DEFAULT));
+		EXPECT_EQ(-20, obj.IntParam.GetConst());
+		EXPECT_EQ(123, obj.UintParam.GetConst());
+	}
+}
+
+TEST(TokDoc, TokDocStreamSameAsTree)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+
+	// Names of array elements are ignored.
+	{
+		const wstring doc = L"\"FixedSizeArrayParam\"={ \"a\"=1; b=2; 3; };";
+		common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+		tokenizer.Next();
+		common::tokdoc::Node rootNode;
+		rootNode.LoadChildren(tokenizer);
+		ContainerStruct treeObj;
+		containerStructDesc->SetObjToDefault(&treeObj);
+		EXPECT_TRUE(rs2::LoadObjFromTokDoc(&treeObj, *containerStructDesc, rootNode, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_PATCH)));
+		ContainerStruct streamObj;
+		containerStructDesc->SetObjToDefault(&streamObj);
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(streamObj, *containerStructDesc, doc, rs2::TOKDOC_FLAG_PATCH));
+		EXPECT_EQ(1, streamObj.FixedSizeArrayParam[0].GetConst());
+		EXPECT_EQ(2, streamObj.FixedSizeArrayParam[1].GetConst());
+		EXPECT_EQ(3, streamObj.FixedSizeArrayParam[2].GetConst());
+		EXPECT_TRUE(rs2::ParamEquals(&treeObj, &streamObj, rs2::StructParamDesc(containerStructDesc.get())));
+	}
+	// Error names missing parameter.
+	{
+		const wstring doc = L"\"BoolParam\"=true; \"IntParam\"=-20;";
+		common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+		tokenizer.Next();
+		common::tokdoc::Node rootNode;
+		rootNode.LoadChildren(tokenizer);
+		SimpleStruct obj;
+		wstring treeMessage, streamMessage;
+		try
+		{
+			rs2::LoadObjFromTokDoc(&obj, *simpleStructDesc, rootNode, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED));
+		}
+		catch(const common::Error& err)
+		{
+			err.GetMessage_(&treeMessage);
+		}
+		try
+		{
+			LoadObjFromTokDocStreamString(obj, *simpleStructDesc, doc, rs2::TOKDOC_FLAG_REQUIRED);
+		}
+		catch(const common::Error& err)
+		{
+			err.GetMessage_(&streamMessage);
+		}
+		EXPECT_NE(wstring::npos, treeMessage.find(L"UintParam"));
+		EXPECT_NE(wstring::npos, streamMessage.find(L"UintParam"));
+	}
+	// Parameter of derived structure shadowing parameter of base structure - both are loaded.
+	{
+		rs2::StructDesc baseDesc(L"Base", sizeof(int32_t));
+		baseDesc.AddParam(L"Value", 0, new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+		rs2::StructDesc derivedDesc(L"Derived", sizeof(int32_t) * 2, &baseDesc);
+		derivedDesc.AddParam(L"Value", sizeof(int32_t), new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+		EXPECT_EQ(1, derivedDesc.FindTopLevel(L"Value", 5, true));
+
+		const wstring doc = L"\"Value\"=5;";
+		common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+		tokenizer.Next();
+		common::tokdoc::Node rootNode;
+		rootNode.LoadChildren(tokenizer);
+		int32_t treeObj[2] = {};
+		EXPECT_TRUE(rs2::LoadObjFromTokDoc(treeObj, derivedDesc, rootNode, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED)));
+		EXPECT_EQ(5, treeObj[0]);
+		EXPECT_EQ(5, treeObj[1]);
+		int32_t streamObj[2] = {};
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(streamObj, derivedDesc, doc, rs2::TOKDOC_FLAG_REQUIRED));
+		EXPECT_EQ(5, streamObj[0]);
+		EXPECT_EQ(5, streamObj[1]);
+	}
+}
+
+// Counts allocations of the calling thread while g_CountAllocations is set.
+static thread_local bool g_CountAllocations = false;
+static thread_local size_t g_AllocationCount = 0;
+
+void* operator new(size_t size)
+{
+	if(g_CountAllocations)
+		++g_AllocationCount;
+	if(void* ptr = malloc(size > 0 ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+// Saves obj with SaveObjToTokDocStream and loads it back, returns number of allocations made meanwhile.
+static size_t CountTokDocStreamAllocations(void* obj, const rs2::StructDesc& structDesc)
+{
+	// First pass builds layout plans and name indices and tells size of the document.
+	const wstring doc = SaveObjToTokDocStreamString(obj, structDesc);
+	{
+		common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+		tokenizer.Next();
+		EXPECT_TRUE(rs2::LoadObjFromTokDocStream(obj, structDesc, tokenizer, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED)));
+	}
+	wstring savedDoc;
+	savedDoc.reserve(doc.length());
+	common::TokenWriter tokenWriter(&savedDoc);
+	common::Tokenizer tokenizer(&doc, common::Tokenizer::FLAG_MULTILINE_STRINGS);
+
+	g_AllocationCount = 0;
+	g_CountAllocations = true;
+	rs2::SaveObjToTokDocStream(tokenWriter, obj, structDesc);
+	tokenizer.Next();
+	const bool loaded = rs2::LoadObjFromTokDocStream(obj, structDesc, tokenizer, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED));
+	g_CountAllocations = false;
+
+	EXPECT_TRUE(loaded);
+	EXPECT_EQ(doc, savedDoc);
+	return g_AllocationCount;
+}
+
+TEST(TokDoc, TokDocStreamAllocations)
+{
+	/*
+	Stream paths don't allocate per parameter, so number of allocations doesn't depend
+	on size of the object. Values have same length, as longer tokens can grow strings.
+	*/
+	const rs2::StructDesc* mathStructDesc = MathStruct::GetStructDesc();
+	size_t allocationCounts[2] = {};
+	for(size_t i = 0; i < 2; ++i)
+	{
+		const size_t elementCount = (i + 1) * 100;
+
+		std::vector<MathStruct> structs(elementCount);
+		rs2::StructDesc structsDesc(L"Structs", elementCount * sizeof(MathStruct));
+		structsDesc.AddParam(
+			L"Elements",
+			0,
+			new rs2::FixedSizeArrayParamDesc(new rs2::StructParamDesc(mathStructDesc), elementCount));
+		for(size_t j = 0; j < elementCount; ++j)
+			structs[j].SetCustomValues();
+		allocationCounts[i] += CountTokDocStreamAllocations(structs.data(), structsDesc);
+
+		std::vector<uint32_t> values(elementCount);
+		rs2::StructDesc valuesDesc(L"Values", elementCount * sizeof(uint32_t));
+		valuesDesc.AddParam(
+			L"Elements",
+			0,
+			new rs2::FixedSizeArrayParamDesc(new rs2::UintParamDesc(rs2::STORAGE::RAW, 0u), elementCount));
+		for(size_t j = 0; j < elementCount; ++j)
+			values[j] = 1000000u + (uint32_t)(j % 10);
+		allocationCounts[i] += CountTokDocStreamAllocations(values.data(), valuesDesc);
+	}
+	EXPECT_EQ(allocationCounts[0], allocationCounts[1]);
+}
+
+TEST(TokDoc, TokDocDeltaSaveLoad)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+
+	// Against defaults.
+	{
+		ContainerStruct obj;
+		containerStructDesc->SetObjToDefault(&obj);
+		EXPECT_TRUE(rs2::ParamIsDefault(&obj, rs2::StructParamDesc(containerStructDesc.get())));
+		common::tokdoc::Node rootNode;
+		rs2::SaveObjToTokDocDelta(rootNode, &obj, nullptr, *containerStructDesc);
+		EXPECT_FALSE(rootNode.HasChildren());
+
+		obj.StructParam.IntParam = -20;
+		obj.FixedSizeArrayParam[1] = 0xDEAE;
+		rs2::SaveObjToTokDocDelta(rootNode, &obj, nullptr, *containerStructDesc);
+		EXPECT_EQ(2, rootNode.GetChildCount());
+		const common::tokdoc::Node* structNode = rootNode.FindFirstChild(L"StructParam");
+		ASSERT_TRUE(structNode != nullptr);
+		EXPECT_EQ(1, structNode->GetChildCount());
+		EXPECT_TRUE(structNode->FindFirstChild(L"IntParam") != nullptr);
+
+		ContainerStruct loadedObj;
+		containerStructDesc->SetObjToDefault(&loadedObj);
+		loadedObj.FixedSizeArrayParam[0] = 1;
+		EXPECT_TRUE(rs2::LoadObjFromTokDoc(&loadedObj, *containerStructDesc, rootNode,
+			rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_PATCH)));
+		EXPECT_EQ(-20, loadedObj.StructParam.IntParam.GetConst());
+		EXPECT_EQ(123, loadedObj.StructParam.UintParam.GetConst());
+		// Whole array is saved.
+		EXPECT_EQ(124, loadedObj.FixedSizeArrayParam[0].GetConst());
+		EXPECT_EQ(0xDEAE, loadedObj.FixedSizeArrayParam[1].GetConst());
+	}
+	// Against baseline object, loaded from stream.
+	{
+		SimpleStruct baseObj;
+		baseObj.SetCustomValues();
+		SimpleStruct obj;
+		obj.SetCustomValues();
+		obj.StringParam = L"DEF";
+		EXPECT_FALSE(rs2::ParamEquals(&obj, &baseObj, rs2::StructParamDesc(simpleStructDesc)));
+		common::tokdoc::Node rootNode;
+		rs2::SaveObjToTokDocDelta(rootNode, &obj, &baseObj, *simpleStructDesc);
+		EXPECT_EQ(1, rootNode.GetChildCount());
+		wstring doc;
+		common::TokenWriter tokenWriter(&doc);
+		rootNode.SaveChildren(tokenWriter);
+
+		SimpleStruct loadedObj;
+		loadedObj.SetCustomValues();
+		EXPECT_TRUE(LoadObjFromTokDocStreamString(loadedObj, *simpleStructDesc, doc, rs2::TOKDOC_FLAG_PATCH));
+		EXPECT_TRUE(rs2::ParamEquals(&obj, &loadedObj, rs2::StructParamDesc(simpleStructDesc)));
+	}
+}
+
+class LinePrinter : public rs2::IPrinter
+{
+public:
+	std::vector<wstring> Lines;
+
+	virtual void printf(const wchar_t* format, ...)
+	{
+		va_list argList;
+		va_start(argList, format);
+		Lines.push_back(wstring());
+		VFormat(Lines.back(), format, argList);
+		va_end(argList);
+	}
+};
+
+TEST(TokDoc, LoadObjsFromTokDocParallel)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	const size_t jobCount = 64;
+	std::vector<wstring> docs(jobCount);
+	std::vector<ContainerStruct> objs(jobCount);
+	std::vector<rs2::STokDocLoadJob> jobs(jobCount);
+	LinePrinter printer;
+	for(size_t i = 0; i < jobCount; ++i)
+	{
+		ContainerStruct obj;
+		obj.SetCustomValues();
+		obj.FixedSizeArrayParam[0] = (uint32_t)i;
+		docs[i] = SaveObjToTokDocString(&obj, *containerStructDesc);
+		rs2::STokDocLoadJob& job = jobs[i];
+		job.FileName = Format_r(L"File%u", (uint32_t)i);
+		job.DstObj = &objs[i];
+		job.DstStructDesc = containerStructDesc.get();
+		job.Config = rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED, &printer);
+		job.Doc = &docs[i];
+	}
+	// Each 8th document has missing parameter, reported as warning. Each 16th has syntax error.
+	for(size_t i = 0; i < jobCount; i += 8)
+	{
+		docs[i] = L"\"FixedSizeArrayParam\"={ 1; 2; 3; };";
+		jobs[i].Config.Flags = rs2::TOKDOC_FLAG_OPTIONAL;
+	}
+	for(size_t i = 4; i < jobCount; i += 16)
+		docs[i] = L"\"StructParam\"={ ";
+
+	EXPECT_FALSE(rs2::LoadObjsFromTokDocParallel(jobs.data(), jobCount, 4));
+	for(size_t i = 0; i < jobCount; ++i)
+	{
+		if(i % 8 == 0)
+		{
+			EXPECT_FALSE(jobs[i].Ok);
+			EXPECT_TRUE(jobs[i].ErrorMessage.empty());
+			EXPECT_EQ(1, objs[i].FixedSizeArrayParam[0].GetConst());
+		}
+		else if(i % 16 == 4)
+		{
+			EXPECT_FALSE(jobs[i].Ok);
+			EXPECT_NE(wstring::npos, jobs[i].ErrorMessage.find(jobs[i].FileName));
+		}
+		else
+		{
+			EXPECT_TRUE(jobs[i].Ok);
+			EXPECT_EQ(i, objs[i].FixedSizeArrayParam[0].GetConst());
+			objs[i].StructParam.CheckCustomValues();
+		}
+	}
+	// Warnings in order of jobs.
+	ASSERT_EQ(jobCount / 8, printer.Lines.size());
+	for(size_t i = 0; i < printer.Lines.size(); ++i)
+		EXPECT_EQ(0, printer.Lines[i].find(Format_r(L"File%u: ", (uint32_t)(i * 8))));
+
+	// Without errors.
+	for(size_t i = 0; i < jobCount; ++i)
+	{
+		ContainerStruct obj;
+		obj.SetCustomValues();
+		docs[i] = SaveObjToTokDocString(&obj, *containerStructDesc);
+		jobs[i].Config = rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED);
+	}
+	EXPECT_TRUE(rs2::LoadObjsFromTokDocParallel(jobs.data(), jobCount));
+}
+
 struct PolymorphicBaseStruct
 {
 	rs2::UintParam BaseUintParam;
@@ -1312,42 +2092,135 @@ TEST(StringConversion, Float)
 
 	EXPECT_TRUE( paramDesc->Parse(&s.FloatParam, L"-1.2345e-3") );
 	EXPECT_FLOAT_EQ(-1.2345e-3f, s.FloatParam.GetConst());
+
+	// Shortest string that parses back to exactly the same value.
+	s.FloatParam = 0.1f + 0.2f;
+	EXPECT_TRUE( paramDesc->ToString(valueStr, &s.FloatParam) );
+	EXPECT_EQ(L"0.3", valueStr);
+	s.FloatParam = 1.f / 3.f;
+	EXPECT_TRUE( paramDesc->ToString(valueStr, &s.FloatParam) );
+	EXPECT_EQ(L"0.33333334", valueStr);
+	EXPECT_TRUE( paramDesc->Parse(&s.FloatParam, valueStr.c_str()) );
+	EXPECT_EQ(1.f / 3.f, s.FloatParam.GetConst());
+
+	EXPECT_FALSE( paramDesc->Parse(&s.FloatParam, L"1.5x") );
 }
 
-TEST(StringConversion, String)
+TEST(StringConversion, Vec)
 {
-	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
-	size_t paramIndex = structDesc->Find(L"StringParam");
-	ASSERT_NE((size_t)-1, paramIndex);
-	const rs2::ParamDesc* paramDesc = structDesc->GetParamDesc(paramIndex);
-	ASSERT_NE(nullptr, paramDesc);
-
-	SimpleStruct s;
+	rs2::Vec3ParamDesc paramDesc(rs2::STORAGE::RAW);
+	common::VEC3 value(1.f, -0.5f, 1.f / 3.f);
 	wstring valueStr;
+	EXPECT_TRUE( paramDesc.ToString(valueStr, &value) );
+	EXPECT_EQ(L"1,-0.5,0.33333334", valueStr);
 
-	s.StringParam = L"aaa";
-	EXPECT_TRUE( paramDesc->ToString(valueStr, &s.StringParam) );
-	EXPECT_EQ(L"aaa", valueStr);
+	common::VEC3 parsedValue(0.f, 0.f, 0.f);
+	EXPECT_TRUE( paramDesc.Parse(&parsedValue, valueStr.c_str()) );
+	EXPECT_TRUE(parsedValue == value);
 
-	EXPECT_TRUE( paramDesc->Parse(&s.StringParam, L"\r\n\t<>&%") );
-	s.StringParam.GetConst(valueStr);
-	EXPECT_EQ(L"\r\n\t<>&%", valueStr);
+	EXPECT_FALSE( paramDesc.Parse(&parsedValue, L"1,2") );
+	EXPECT_FALSE( paramDesc.Parse(&parsedValue, L"1,2,3,") );
+	EXPECT_FALSE( paramDesc.Parse(&parsedValue, L"1,,3") );
 }
 
-TEST(StringConversion, GameTime)
+TEST(StringConversion, AppendAndParseRange)
 {
 	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
-	size_t paramIndex = structDesc->Find(L"GameTimeParam");
-	ASSERT_NE((size_t)-1, paramIndex);
-	const rs2::ParamDesc* paramDesc = structDesc->GetParamDesc(paramIndex);
-	ASSERT_NE(nullptr, paramDesc);
-
 	SimpleStruct s;
-	wstring valueStr;
+	s.SetCustomValues();
 
-	s.GameTimeParam = common::SecondsToGameTime(12.5);
-	EXPECT_TRUE( paramDesc->ToString(valueStr, &s.GameTimeParam) );
-	EXPECT_EQ(L"12.5s", valueStr);
+	// All values appended to single buffer.
+	wstring buf = L"Values:";
+	for(size_t i = 0; i < structDesc->Params.size(); ++i)
+	{
+		buf += L' ';
+		EXPECT_TRUE( structDesc->GetParamDesc(i)->AppendToString(buf, structDesc->AccessRawParam(&s, i)) );
+	}
+	EXPECT_EQ(L"Values: false -20 124 13.5 ABC 123ms", buf);
+
+	// Each value parsed from the middle of the buffer, without terminating null.
+	SimpleStruct loaded;
+	const wchar_t* valueBeg = buf.c_str() + 8;
+	for(size_t i = 0; i < structDesc->Params.size(); ++i)
+	{
+		const wchar_t* valueEnd = wcschr(valueBeg, L' ');
+		if(valueEnd == nullptr)
+			valueEnd = buf.c_str() + buf.length();
+		EXPECT_TRUE( structDesc->GetParamDesc(i)->Parse(structDesc->AccessRawParam(&loaded, i), valueBeg, valueEnd - valueBeg) );
+		valueBeg = valueEnd + 1;
+	}
+	loaded.CheckCustomValues();
+
+	const rs2::ParamDesc* intParamDesc = structDesc->GetParamDesc(structDesc->Find(L"IntParam"));
+	EXPECT_FALSE( intParamDesc->Parse(&loaded.IntParam, L"12", 0) );
+	EXPECT_TRUE( intParamDesc->Parse(&loaded.IntParam, L"125", 2) );
+	EXPECT_EQ(12, loaded.IntParam.GetConst());
+}
+
+// Overrides only ToString and Parse, as code written before AppendToString did.
+class RomanIntParamDesc : public rs2::IntParamDesc
+{
+public:
+	RomanIntParamDesc() : rs2::IntParamDesc(rs2::STORAGE::RAW, 0) { }
+	virtual bool ToString(wstring& out, const void* srcParam) const
+	{
+		out.assign((size_t)*(const int32_t*)srcParam, L'I');
+		return true;
+	}
+	virtual bool Parse(void* dstParam, const wchar_t* src) const
+	{
+		*(int32_t*)dstParam = (int32_t)wcslen(src);
+		return wcsspn(src, L"I") == wcslen(src);
+	}
+};
+
+TEST(StringConversion, OverriddenToStringAndParse)
+{
+	const RomanIntParamDesc romanParamDesc;
+	const rs2::ParamDesc& paramDesc = romanParamDesc;
+	int32_t value = 3;
+	wstring str;
+	EXPECT_TRUE( paramDesc.ToString(str, &value) );
+	EXPECT_EQ(L"III", str);
+	EXPECT_TRUE( paramDesc.Parse(&value, L"IIII") );
+	EXPECT_EQ(4, value);
+	EXPECT_FALSE( paramDesc.Parse(&value, L"IV") );
+}
+
+TEST(StringConversion, String)
+{
+	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
+	size_t paramIndex = structDesc->Find(L"StringParam");
+	ASSERT_NE((size_t)-1, paramIndex);
+	const rs2::ParamDesc* paramDesc = structDesc->GetParamDesc(paramIndex);
+	ASSERT_NE(nullptr, paramDesc);
+
+	SimpleStruct s;
+	wstring valueStr;
+
+	s.StringParam = L"aaa";
+	EXPECT_TRUE( paramDesc->ToString(valueStr, &s.StringParam) );
+	EXPECT_EQ(L"aaa", valueStr);
+
+	EXPECT_TRUE( paramDesc->Parse(&s.StringParam, L"\r\n\t<>&%") );
+	s.StringParam.GetConst(valueStr);
+	EXPECT_EQ(L"\r\n\t<>&%", valueStr);
+}
+
+TEST(StringConversion, GameTime)
+{
+	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
+	size_t paramIndex = structDesc->Find(L"GameTimeParam");
+	ASSERT_NE((size_t)-1, paramIndex);
+	const rs2::ParamDesc* paramDesc = structDesc->GetParamDesc(paramIndex);
+	ASSERT_NE(nullptr, paramDesc);
+
+	SimpleStruct s;
+	wstring valueStr;
+
+	s.GameTimeParam = common::SecondsToGameTime(12.5);
+	EXPECT_TRUE( paramDesc->ToString(valueStr, &s.GameTimeParam) );
+	EXPECT_EQ(L"12.5s", valueStr);
 
 	EXPECT_TRUE( paramDesc->Parse(&s.GameTimeParam, L"10:25") );
 	EXPECT_DOUBLE_EQ(10. * 60. + 25., s.GameTimeParam.GetConst().ToSeconds_d());
@@ -1422,6 +2295,151 @@ TEST(StringConversion, Vec4)
 	EXPECT_FLOAT_EQ(1e-6f, v4.w);
 }
 
+TEST(StructDesc, ArenaAndFootprint)
+{
+	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
+	rs2::DescArena& arena = rs2::GetDescArena();
+	EXPECT_EQ(arena.Intern(L"SimpleStruct"), structDesc->GetName());
+	EXPECT_EQ(L"IntParam", structDesc->Names[1]);
+	EXPECT_EQ(arena.Intern(L"IntParam"), structDesc->GetInternedName(1));
+	// Names are stored only as interned pointers.
+	EXPECT_EQ(sizeof(const wchar_t*), sizeof(rs2::InternedString));
+	ASSERT_TRUE(structDesc->GetParamArena() != nullptr);
+	for(size_t i = 0; i < structDesc->Params.size(); ++i)
+		EXPECT_TRUE(structDesc->GetParamArena()->Contains(structDesc->Params[i].get()));
+
+	rs2::StructDesc localDesc(L"SimpleStruct", sizeof(SimpleStruct));
+	EXPECT_EQ(structDesc->GetName(), localDesc.GetName());
+	const size_t emptyFootprint = localDesc.GetFootprint();
+	localDesc.AddParam(L"IntParam", 0, new rs2::IntParamDesc(rs2::STORAGE::RAW, 1)).SetUnitName(L"m");
+	EXPECT_GT(localDesc.GetFootprint(), emptyFootprint);
+	EXPECT_EQ(L"m", localDesc.GetParamDesc(0)->UnitName);
+	EXPECT_EQ(arena.Intern(L"m"), localDesc.GetParamDesc(0)->GetInternedUnitName());
+	EXPECT_EQ(0, localDesc.Find(L"IntParam", false));
+
+	// Renaming through Names.
+	localDesc.Names[0] = wstring(L"RenamedParam");
+	localDesc.InvalidateNameIndex();
+	localDesc.InvalidateLayoutPlan();
+	EXPECT_EQ(0, localDesc.Find(L"RenamedParam"));
+	EXPECT_EQ((size_t)-1, localDesc.Find(L"IntParam"));
+	EXPECT_EQ(arena.Intern(L"RenamedParam"), localDesc.GetLayoutPlan().Entries[0].Name);
+	EXPECT_GT(structDesc->GetFootprint(), 0u);
+
+	// Descriptors created with EmplaceParam are freed with the structure, not in the global arena.
+	const size_t globalUsedSize = arena.GetUsedSize();
+	std::weak_ptr<rs2::ParamDesc> weakParamDesc;
+	std::shared_ptr<rs2::ParamDesc> keptParamDesc;
+	{
+		rs2::StructDesc tempDesc(L"SimpleStruct", sizeof(SimpleStruct));
+		tempDesc.EmplaceParam<rs2::IntParamDesc>(L"IntParam", 0, rs2::STORAGE::RAW, 1);
+		tempDesc.EmplaceParam<rs2::UintParamDesc>(L"UintParam", 0, rs2::STORAGE::RAW, 2u);
+		weakParamDesc = tempDesc.Params[0];
+		keptParamDesc = tempDesc.Params[1];
+	}
+	EXPECT_EQ(globalUsedSize, arena.GetUsedSize());
+	EXPECT_TRUE(weakParamDesc.expired());
+	// Arena stays alive while any of its descriptors is referenced.
+	EXPECT_EQ(2u, ((const rs2::UintParamDesc&)*keptParamDesc).DefaultValue);
+	keptParamDesc.reset();
+}
+
+TEST(ParamType, VisitParamDesc)
+{
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(SimpleStruct::GetStructDesc());
+	EXPECT_EQ(rs2::PARAM_TYPE::STRUCT, containerStructDesc->GetParamDesc(0)->GetType());
+	const rs2::ParamDesc* arrayParamDesc = containerStructDesc->GetParamDesc(1);
+	EXPECT_EQ(rs2::PARAM_TYPE::FIXED_SIZE_ARRAY, arrayParamDesc->GetType());
+	EXPECT_EQ(rs2::PARAM_TYPE::UINT, ((const rs2::FixedSizeArrayParamDesc*)arrayParamDesc)->GetElementParamDesc()->GetType());
+
+	rs2::Vec3ParamDesc vec3ParamDesc(rs2::STORAGE::RAW);
+	EXPECT_EQ(rs2::PARAM_TYPE::VEC3, vec3ParamDesc.GetType());
+
+	struct CountVisitor
+	{
+		size_t operator()(const rs2::FixedSizeArrayParamDesc& paramDesc) const { return paramDesc.GetCount(); }
+		size_t operator()(const rs2::ParamDesc& paramDesc) const { return 1; }
+	};
+	EXPECT_EQ(3, rs2::VisitParamDesc(*arrayParamDesc, CountVisitor()));
+	EXPECT_EQ(1, rs2::VisitParamDesc(vec3ParamDesc, CountVisitor()));
+	EXPECT_EQ(sizeof(common::VEC3), rs2::VisitParamDesc(vec3ParamDesc, [](const auto& typedParamDesc) {
+		return typedParamDesc.GetParamSize();
+	}));
+}
+
+struct StaticStruct
+{
+	bool BoolValue;
+	int32_t IntValue;
+	uint32_t UintValue;
+	float FloatValue;
+	wstring StringValue;
+	GameTime GameTimeValue;
+	VEC3 Vec3Value;
+};
+
+static const auto staticStructDesc = rs2::MakeStaticStructDesc<StaticStruct>(L"StaticStruct",
+	RS2_STATIC_PARAM(StaticStruct, BoolValue, true),
+	RS2_STATIC_PARAM(StaticStruct, IntValue, -10),
+	RS2_STATIC_PARAM(StaticStruct, UintValue, 123u),
+	RS2_STATIC_PARAM(StaticStruct, FloatValue, 3.14f),
+	RS2_STATIC_PARAM(StaticStruct, StringValue, L"StringDefault"),
+	RS2_STATIC_PARAM(StaticStruct, GameTimeValue, common::MillisecondsToGameTime(1023)),
+	RS2_STATIC_PARAM(StaticStruct, Vec3Value, VEC3(1.f, 2.f, 3.f)));
+
+TEST(StaticStructDesc, Operations)
+{
+	EXPECT_EQ(7, staticStructDesc.PARAM_COUNT);
+
+	StaticStruct obj1, obj2;
+	staticStructDesc.SetObjToDefault(obj1);
+	EXPECT_TRUE(obj1.BoolValue);
+	EXPECT_EQ(-10, obj1.IntValue);
+	EXPECT_EQ(L"StringDefault", obj1.StringValue);
+	EXPECT_EQ(VEC3(1.f, 2.f, 3.f), obj1.Vec3Value);
+
+	staticStructDesc.CopyObj(obj2, obj1);
+	EXPECT_TRUE(staticStructDesc.ObjEquals(obj1, obj2));
+	obj2.FloatValue = 13.5f;
+	EXPECT_FALSE(staticStructDesc.ObjEquals(obj1, obj2));
+
+	common::tokdoc::Node node;
+	staticStructDesc.SaveObjToTokDoc(node, obj2);
+	StaticStruct obj3;
+	staticStructDesc.LoadObjFromTokDoc(obj3, node);
+	EXPECT_TRUE(staticStructDesc.ObjEquals(obj2, obj3));
+
+	node.FindFirstChild(L"IntValue")->Name = L"Renamed";
+	EXPECT_THROW(staticStructDesc.LoadObjFromTokDoc(obj3, node), common::Error);
+}
+
+TEST(StaticStructDesc, CreateStructDesc)
+{
+	unique_ptr<rs2::StructDesc> structDesc = staticStructDesc.CreateStructDesc();
+	ASSERT_EQ(7, structDesc->Params.size());
+	EXPECT_EQ(sizeof(StaticStruct), structDesc->GetStructSize());
+	EXPECT_EQ(L"FloatValue", structDesc->Names[3]);
+	EXPECT_EQ(offsetof(StaticStruct, FloatValue), structDesc->Offsets[3]);
+	EXPECT_EQ(offsetof(StaticStruct, Vec3Value), structDesc->Offsets[6]);
+	EXPECT_EQ(rs2::PARAM_TYPE::GAMETIME, structDesc->Params[5]->GetType());
+
+	// Dynamic and static paths give the same results.
+	StaticStruct obj1, obj2;
+	structDesc->SetObjToDefault(&obj1);
+	staticStructDesc.SetObjToDefault(obj2);
+	EXPECT_TRUE(staticStructDesc.ObjEquals(obj1, obj2));
+
+	obj1.UintValue = 0xDEAD;
+	common::tokdoc::Node staticNode, dynamicNode;
+	staticStructDesc.SaveObjToTokDoc(staticNode, obj1);
+	rs2::SaveObjToTokDoc(dynamicNode, &obj1, *structDesc);
+	wstring staticStr, dynamicStr;
+	common::TokenWriter staticWriter(&staticStr), dynamicWriter(&dynamicStr);
+	staticNode.SaveChildren(staticWriter);
+	dynamicNode.SaveChildren(dynamicWriter);
+	EXPECT_EQ(dynamicStr, staticStr);
+}
+
 TEST(FindObjParamByPath, Simple)
 {
 	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
@@ -1492,6 +2510,104 @@ TEST(FindObjParamByPath, FixedSizeArray)
 	EXPECT_EQ(123, uintParam->GetConst());
 }
 
+TEST(FindObjParamByPath, Derived)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> derivedStructDesc = DerivedStruct::CreateStructDesc(simpleStructDesc);
+	DerivedStruct s;
+	s.UintParam = 123;
+	s.DerivedUintParam = 456;
+
+	void* param = nullptr;
+	const rs2::ParamDesc* paramDesc = nullptr;
+	ASSERT_TRUE( rs2::FindObjParamByPath(
+		param, paramDesc,
+		&s, *derivedStructDesc,
+		L"uintparam", false) );
+	EXPECT_EQ(123, ((rs2::UintParam*)param)->GetConst());
+	ASSERT_TRUE( rs2::FindObjParamByPath(
+		param, paramDesc,
+		&s, *derivedStructDesc,
+		L"DerivedUintParam", true) );
+	EXPECT_EQ(456, ((rs2::UintParam*)param)->GetConst());
+
+	// Find covers only own parameters, FindInherited also base ones.
+	EXPECT_EQ((size_t)-1, derivedStructDesc->Find(L"UintParam"));
+	EXPECT_EQ(0, derivedStructDesc->Find(L"derivedUintParam", false));
+	const rs2::StructDesc* foundStructDesc = nullptr;
+	size_t foundIndex = 0;
+	ASSERT_TRUE(derivedStructDesc->FindInherited(foundStructDesc, foundIndex, L"UintParam"));
+	EXPECT_EQ(simpleStructDesc, foundStructDesc);
+	EXPECT_EQ(2, foundIndex);
+	EXPECT_FALSE(derivedStructDesc->FindInherited(foundStructDesc, foundIndex, L"UINTPARAM"));
+}
+
+TEST(FindObjParamByPath, NameIndexOfBaseUpdated)
+{
+	rs2::StructDesc baseDesc(L"Base", sizeof(int32_t) * 2);
+	baseDesc.AddParam(L"A", 0, new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+	rs2::StructDesc derivedDesc(L"Derived", sizeof(int32_t) * 2, &baseDesc);
+	const rs2::StructDesc* foundStructDesc = nullptr;
+	size_t foundIndex = 0;
+	EXPECT_FALSE(derivedDesc.FindInherited(foundStructDesc, foundIndex, L"B"));
+
+	// Parameter added to base after derived index was built.
+	baseDesc.AddParam(L"B", sizeof(int32_t), new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+	ASSERT_TRUE(derivedDesc.FindInherited(foundStructDesc, foundIndex, L"B"));
+	EXPECT_EQ(&baseDesc, foundStructDesc);
+	EXPECT_EQ(1, foundIndex);
+}
+
+TEST(FindObjParamByPath, ConcurrentFirstFind)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> derivedStructDesc = DerivedStruct::CreateStructDesc(simpleStructDesc);
+	bool results[8] = {};
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < _countof(results); ++i)
+	{
+		threads.emplace_back([&results, &derivedStructDesc, i]()
+		{
+			const rs2::StructDesc* foundStructDesc = nullptr;
+			size_t foundIndex = 0;
+			results[i] = derivedStructDesc->FindInherited(foundStructDesc, foundIndex, L"UintParam") &&
+				foundIndex == 2;
+		});
+	}
+	for(size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+	for(size_t i = 0; i < _countof(results); ++i)
+		EXPECT_TRUE(results[i]);
+}
+
+TEST(FindObjParamByPath, CompilePath)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	ContainerStruct objs[2];
+	objs[0].StructParam.UintParam = 123;
+	objs[1].StructParam.UintParam = 456;
+	objs[1].FixedSizeArrayParam[2] = 789;
+
+	rs2::ParamPath uintPath = rs2::CompilePath(*containerStructDesc, L"structparam\\uintparam", false);
+	ASSERT_TRUE(uintPath.IsValid());
+	EXPECT_EQ(containerStructDesc.get(), uintPath.GetStructDesc());
+	EXPECT_EQ(rs2::PARAM_TYPE::UINT, uintPath.GetParamDesc()->GetType());
+	EXPECT_EQ(123, ((const rs2::UintParam*)uintPath.Access(&objs[0]))->GetConst());
+	EXPECT_EQ(456, ((const rs2::UintParam*)uintPath.Access(&objs[1]))->GetConst());
+
+	rs2::ParamPath elementPath = rs2::CompilePath(*containerStructDesc, L"FixedSizeArrayParam[2]");
+	ASSERT_TRUE(elementPath.IsValid());
+	EXPECT_EQ(&objs[1].FixedSizeArrayParam[2], elementPath.Access(&objs[1]));
+
+	EXPECT_FALSE(rs2::CompilePath(*containerStructDesc, L"").IsValid());
+	EXPECT_FALSE(rs2::CompilePath(*containerStructDesc, L"FixedSizeArrayParam[3]").IsValid());
+	EXPECT_FALSE(rs2::CompilePath(*containerStructDesc, L"FixedSizeArrayParam[]").IsValid());
+	EXPECT_FALSE(rs2::CompilePath(*containerStructDesc, L"FixedSizeArrayParam[1x]").IsValid());
+	EXPECT_FALSE(rs2::CompilePath(*containerStructDesc, L"StructParam\\UintParam\\").IsValid());
+	EXPECT_FALSE(rs2::ParamPath().IsValid());
+}
+
 TEST(FindObjParamByPath, Negative)
 {
 	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
@@ -1779,6 +2895,73 @@ TEST(RawValues, Copy)
 	EXPECT_EQ(VEC4(1.f, 2.f, 3.f, 4.f), obj2.Vec4Value);
 }
 
+TEST(RawValues, PodRuns)
+{
+	unique_ptr<rs2::StructDesc> rawValuesStructDesc = RawValuesStruct::CreateStructDesc();
+	EXPECT_FALSE(rawValuesStructDesc->IsPod());
+
+	// IntValue, UintValue, FloatValue are adjacent, so they are copied with single memcpy.
+	// StringValue is copied through its ParamDesc.
+	const rs2::LayoutPlan& plan = rawValuesStructDesc->GetLayoutPlan();
+	bool intRunFound = false, stringOpFound = false;
+	for(const rs2::LayoutPlan::Op& op : plan.CopyOps)
+	{
+		if(op.Offset == offsetof(RawValuesStruct, IntValue))
+		{
+			EXPECT_EQ(offsetof(RawValuesStruct, FloatValue) + sizeof(float) - offsetof(RawValuesStruct, IntValue), op.Size);
+			intRunFound = true;
+		}
+		else if(op.Offset == offsetof(RawValuesStruct, StringValue))
+		{
+			EXPECT_EQ(0, op.Size);
+			stringOpFound = true;
+		}
+	}
+	EXPECT_TRUE(intRunFound);
+	EXPECT_TRUE(stringOpFound);
+}
+
+struct PodStruct
+{
+	int32_t IntValue;
+	float FloatArray[3];
+	VEC2 Vec2Value;
+};
+
+TEST(RawValues, PodStruct)
+{
+	rs2::StructDesc structDesc(L"PodStruct", sizeof(PodStruct));
+	structDesc.AddParam(
+		L"IntValue",
+		offsetof(PodStruct, IntValue),
+		new rs2::IntParamDesc(rs2::STORAGE::RAW, 10));
+	structDesc.AddParam(
+		L"FloatArray",
+		offsetof(PodStruct, FloatArray),
+		new rs2::FixedSizeArrayParamDesc(new rs2::FloatParamDesc(rs2::STORAGE::RAW, 0.5f), 3));
+	structDesc.AddParam(
+		L"Vec2Value",
+		offsetof(PodStruct, Vec2Value),
+		new rs2::Vec2ParamDesc(rs2::STORAGE::RAW, VEC2(1.f, 2.f)));
+	ASSERT_TRUE(structDesc.IsPod());
+
+	PodStruct obj1, obj2;
+	structDesc.SetObjToDefault(&obj1);
+	EXPECT_EQ(10, obj1.IntValue);
+	EXPECT_EQ(0.5f, obj1.FloatArray[2]);
+	EXPECT_EQ(VEC2(1.f, 2.f), obj1.Vec2Value);
+
+	obj1.FloatArray[1] = 7.f;
+	structDesc.CopyObj(&obj2, &obj1);
+	EXPECT_EQ(10, obj2.IntValue);
+	EXPECT_EQ(7.f, obj2.FloatArray[1]);
+	EXPECT_EQ(VEC2(1.f, 2.f), obj2.Vec2Value);
+
+	structDesc.Params[0]->Flags |= rs2::ParamDesc::FLAG_MINMAX_CLAMP_ON_SET;
+	structDesc.InvalidateLayoutPlan();
+	EXPECT_FALSE(structDesc.IsPod());
+}
+
 TEST(RawValues, MinMaxClampOnSet)
 {
 	unique_ptr<rs2::StructDesc> rawValuesStructDesc = RawValuesStruct::CreateStructDesc(
@@ -1826,6 +3009,71 @@ TEST(RawValues, MinMaxClampOnSet)
 	EXPECT_EQ(VEC4(200.f, 200.f, 200.f, 200.f), obj.Vec4Value);
 }
 
+TEST(RawValues, Batch)
+{
+	unique_ptr<rs2::StructDesc> rawValuesStructDesc = RawValuesStruct::CreateStructDesc(
+		rs2::ParamDesc::FLAG_MINMAX_CLAMP_ON_SET);
+	const rs2::IntParamDesc* intParamDesc = (const rs2::IntParamDesc*)rawValuesStructDesc->Params[1].get();
+	const rs2::UintParamDesc* uintParamDesc = (const rs2::UintParamDesc*)rawValuesStructDesc->Params[2].get();
+	const rs2::FloatParamDesc* floatParamDesc = (const rs2::FloatParamDesc*)rawValuesStructDesc->Params[3].get();
+
+	const size_t count = 7;
+	RawValuesStruct objs[count];
+	const int32_t ints[count] = { -1000, 5, 10, 15, 20, 25, INT32_MAX };
+	const uint32_t uints[count] = { 0, 99, 100, 150, 200, 201, UINT32_MAX };
+	const float floats[count] = { -FLT_MAX, 50.f, 100.f, 150.f, 200.f, NAN, INFINITY };
+	intParamDesc->SetBatch(&objs[0].IntValue, sizeof(RawValuesStruct), ints, count);
+	uintParamDesc->SetBatch(&objs[0].UintValue, sizeof(RawValuesStruct), uints, count);
+	floatParamDesc->SetBatch(&objs[0].FloatValue, sizeof(RawValuesStruct), floats, count);
+
+	const int32_t expectedInts[count] = { 10, 10, 10, 15, 20, 20, 20 };
+	const uint32_t expectedUints[count] = { 100, 100, 100, 150, 200, 200, 200 };
+	const float expectedFloats[count] = { 100.f, 100.f, 100.f, 150.f, 200.f, 100.f, 200.f };
+	int32_t outInts[count];
+	uint32_t outUints[count];
+	float outFloats[count];
+	intParamDesc->GetBatch(outInts, &objs[0].IntValue, sizeof(RawValuesStruct), count);
+	uintParamDesc->GetBatch(outUints, &objs[0].UintValue, sizeof(RawValuesStruct), count);
+	floatParamDesc->GetBatch(outFloats, &objs[0].FloatValue, sizeof(RawValuesStruct), count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		EXPECT_EQ(expectedInts[i], objs[i].IntValue);
+		EXPECT_EQ(expectedUints[i], objs[i].UintValue);
+		EXPECT_EQ(expectedFloats[i], objs[i].FloatValue);
+		EXPECT_EQ(expectedInts[i], outInts[i]);
+		EXPECT_EQ(expectedUints[i], outUints[i]);
+		EXPECT_EQ(expectedFloats[i], outFloats[i]);
+	}
+
+	// Contiguous values, clamped on get.
+	float contiguousFloats[count];
+	memcpy(contiguousFloats, floats, sizeof(floats));
+	rs2::FloatParamDesc clampOnGetParamDesc(rs2::STORAGE::RAW, 0.f, rs2::ParamDesc::FLAG_MINMAX_CLAMP_ON_GET);
+	clampOnGetParamDesc.SetMin(100.f).SetMax(200.f);
+	clampOnGetParamDesc.GetBatch(outFloats, contiguousFloats, sizeof(float), count);
+	for(size_t i = 0; i < count; ++i)
+		EXPECT_EQ(expectedFloats[i], outFloats[i]);
+
+	// All values are checked before any is written.
+	unique_ptr<rs2::StructDesc> failStructDesc = RawValuesStruct::CreateStructDesc(
+		rs2::ParamDesc::FLAG_MINMAX_FAIL_ON_SET);
+	const rs2::IntParamDesc* failIntParamDesc = (const rs2::IntParamDesc*)failStructDesc->Params[1].get();
+	EXPECT_THROW(
+		failIntParamDesc->SetBatch(&objs[0].IntValue, sizeof(RawValuesStruct), ints + 2, 4),
+		common::Error);
+	EXPECT_EQ(10, objs[1].IntValue);
+	EXPECT_EQ(15, objs[3].IntValue);
+
+	// Other storage types go through SetConst and GetConst.
+	SimpleStruct simpleObjs[3];
+	const rs2::UintParamDesc* paramUintParamDesc = (const rs2::UintParamDesc*)SimpleStruct::GetStructDesc()->Params[2].get();
+	paramUintParamDesc->SetBatch(&simpleObjs[0].UintParam, sizeof(SimpleStruct), uints + 1, 3);
+	EXPECT_EQ(99, simpleObjs[0].UintParam.GetConst());
+	EXPECT_EQ(150, simpleObjs[2].UintParam.GetConst());
+	paramUintParamDesc->GetBatch(outUints, &simpleObjs[0].UintParam, sizeof(SimpleStruct), 3);
+	EXPECT_EQ(100, outUints[1]);
+}
+
 TEST(RawValues, MinMaxFailOnSet)
 {
 	unique_ptr<rs2::StructDesc> rawValuesStructDesc = RawValuesStruct::CreateStructDesc(
@@ -2026,6 +3274,805 @@ TEST(Funcs, SetObjToDefault_GetSet)
 	EXPECT_EQ(VEC4(1.f, 2.f, 1.f, 54.f), obj.Vec4Value);
 }
 
+class AccessorObj
+{
+public:
+	float GetFloat() const { return m_Float; }
+	void SetFloat(float value) { m_Float = value; }
+	const wstring& GetString() const { return m_String; }
+	bool SetString(const wstring& value) { if(value.empty()) return false; m_String = value; return true; }
+
+private:
+	float m_Float = 0.f;
+	wstring m_String;
+};
+
+TEST(Funcs, Accessor)
+{
+	rs2::StructDesc structDescObj(L"AccessorStruct", sizeof(AccessorObj));
+	rs2::StructDesc* structDesc = &structDescObj;
+
+	RS2_ADD_PARAM_FLOAT_ACCESSOR(FloatParam, RS2_MEMBER_ACCESSOR(&AccessorObj::GetFloat, &AccessorObj::SetFloat), 2.5f);
+	RS2_ADD_PARAM_STRING_ACCESSOR(StringParam, RS2_MEMBER_ACCESSOR(&AccessorObj::GetString, &AccessorObj::SetString), L"Default");
+	// Plain function with context, getter only.
+	uint32_t counter = 0;
+	RS2_ADD_PARAM_UINT_ACCESSOR(CounterParam, rs2::FunctionAccessor<uint32_t>(
+		[](uint32_t& outValue, const void* param, void* context) -> bool
+		{
+			outValue = ++*(uint32_t*)context; return true;
+		},
+		nullptr,
+		&counter));
+
+	const rs2::FloatParamDesc* floatParamDesc = (const rs2::FloatParamDesc*)structDesc->Params[0].get();
+	const rs2::StringParamDesc* stringParamDesc = (const rs2::StringParamDesc*)structDesc->Params[1].get();
+	const rs2::UintParamDesc* counterParamDesc = (const rs2::UintParamDesc*)structDesc->Params[2].get();
+	EXPECT_EQ(rs2::STORAGE::FUNCTION, floatParamDesc->GetStorage());
+	EXPECT_FALSE(floatParamDesc->GetFunc);
+	EXPECT_TRUE(floatParamDesc->CanRead() && floatParamDesc->CanWrite());
+	EXPECT_TRUE(counterParamDesc->CanRead());
+	EXPECT_FALSE(counterParamDesc->CanWrite());
+
+	AccessorObj obj1, obj2;
+	floatParamDesc->SetToDefault(&obj1);
+	stringParamDesc->SetToDefault(&obj1);
+	EXPECT_EQ(2.5f, obj1.GetFloat());
+	EXPECT_EQ(L"Default", obj1.GetString());
+
+	floatParamDesc->Copy(&obj2, &obj1);
+	stringParamDesc->Copy(&obj2, &obj1);
+	EXPECT_EQ(2.5f, floatParamDesc->GetConst(&obj2));
+	wstring str;
+	stringParamDesc->GetConst(str, &obj2);
+	EXPECT_EQ(L"Default", str);
+
+	// Setter returning false.
+	EXPECT_FALSE(stringParamDesc->TrySetConst(&obj2, wstring()));
+	EXPECT_EQ(L"Default", obj2.GetString());
+
+	EXPECT_EQ(1, counterParamDesc->GetConst(&obj1));
+	EXPECT_EQ(2, counterParamDesc->GetConst(&obj1));
+}
+
+class RegisteredStruct
+{
+public:
+	rs2::UintParam UintParam;
+
+	static const rs2::StructDesc* GetStructDesc();
+};
+
+const rs2::StructDesc* RegisteredStruct::GetStructDesc()
+{
+	RS2_GET_STRUCT_DESC_BEGIN(RegisteredStruct);
+	RS2_ADD_PARAM_UINT(UintParam, rs2::STORAGE::PARAM, 7u);
+	RS2_GET_STRUCT_DESC_END();
+}
+
+RS2_REGISTER_STRUCT(RegisteredStruct)
+
+class LazyRegisteredStruct
+{
+public:
+	rs2::FloatParam FloatParam;
+
+	static const rs2::StructDesc* GetStructDesc();
+};
+
+const rs2::StructDesc* LazyRegisteredStruct::GetStructDesc()
+{
+	RS2_GET_STRUCT_DESC_BEGIN(LazyRegisteredStruct);
+	RS2_ADD_PARAM_FLOAT(FloatParam, rs2::STORAGE::PARAM, 1.f);
+	RS2_GET_STRUCT_DESC_END();
+}
+
+namespace FirstNamespace
+{
+	struct SameNameStruct
+	{
+		rs2::UintParam UintParam;
+
+		static const rs2::StructDesc* GetStructDesc(uint32_t defaultValue);
+	};
+
+	// Body uses function parameter and local variable.
+	const rs2::StructDesc* SameNameStruct::GetStructDesc(uint32_t defaultValue)
+	{
+		const uint32_t maxValue = defaultValue * 2;
+		RS2_GET_STRUCT_DESC_BEGIN(SameNameStruct);
+		RS2_ADD_PARAM_UINT(UintParam, rs2::STORAGE::PARAM, defaultValue).SetMax(maxValue);
+		RS2_GET_STRUCT_DESC_END();
+	}
+}
+
+namespace SecondNamespace
+{
+	struct SameNameStruct
+	{
+		rs2::FloatParam FloatParam;
+
+		static const rs2::StructDesc* GetStructDesc();
+	};
+
+	const rs2::StructDesc* SameNameStruct::GetStructDesc()
+	{
+		RS2_GET_STRUCT_DESC_BEGIN(SameNameStruct);
+		RS2_ADD_PARAM_FLOAT(FloatParam, rs2::STORAGE::PARAM, 1.f);
+		RS2_GET_STRUCT_DESC_END();
+	}
+}
+
+static const rs2::TypedEnumDesc<NewEnumWithValues>* GetRegisteredEnumDesc()
+{
+	RS2_GET_ENUM_DESC_BODY(NewEnumWithValues, _countof(NewEnumWithValuesNames), NewEnumWithValuesNames, NewEnumWithValuesValues);
+}
+
+RS2_REGISTER_ENUM(GetRegisteredEnumDesc)
+
+TEST(TypeRegistry, Find)
+{
+	const rs2::TypeRegistry& registry = rs2::GetTypeRegistry();
+	EXPECT_EQ(RegisteredStruct::GetStructDesc(), registry.FindStruct(L"RegisteredStruct"));
+	EXPECT_EQ(RegisteredStruct::GetStructDesc(), registry.FindStruct(L"registeredstruct", false));
+	EXPECT_EQ(nullptr, registry.FindStruct(L"registeredstruct"));
+	EXPECT_EQ(SimpleStruct::GetStructDesc(), registry.FindStruct(L"SimpleStruct"));
+	EXPECT_EQ(GetRegisteredEnumDesc(), registry.FindEnum(L"NewEnumWithValues"));
+	EXPECT_EQ(nullptr, registry.FindEnum(L"RegisteredStruct"));
+
+	rs2::StructDesc duplicateDesc(L"RegisteredStruct", sizeof(RegisteredStruct));
+	EXPECT_THROW(rs2::GetTypeRegistry().RegisterStruct(duplicateDesc), common::Error);
+}
+
+TEST(TypeRegistry, SameNameInDifferentNamespaces)
+{
+	const rs2::StructDesc* firstDesc = nullptr;
+	const rs2::StructDesc* secondDesc = nullptr;
+	ASSERT_NO_THROW(firstDesc = FirstNamespace::SameNameStruct::GetStructDesc(5u));
+	ASSERT_NO_THROW(secondDesc = SecondNamespace::SameNameStruct::GetStructDesc());
+	EXPECT_NE(firstDesc, secondDesc);
+	EXPECT_EQ(5u, ((const rs2::UintParamDesc*)firstDesc->Params[0].get())->DefaultValue);
+	EXPECT_EQ(10u, ((const rs2::UintParamDesc*)firstDesc->Params[0].get())->MaxValue);
+
+	const rs2::TypeRegistry& registry = rs2::GetTypeRegistry();
+	EXPECT_EQ(firstDesc, registry.FindStruct(typeid(FirstNamespace::SameNameStruct)));
+	EXPECT_EQ(secondDesc, registry.FindStruct(typeid(SecondNamespace::SameNameStruct)));
+	EXPECT_EQ(firstDesc, registry.FindStruct(L"SameNameStruct"));
+	EXPECT_EQ(nullptr, registry.FindStruct(typeid(int)));
+	EXPECT_EQ(GetRegisteredEnumDesc(), registry.FindEnum(typeid(NewEnumWithValues)));
+}
+
+TEST(TypeRegistry, ConcurrentFirstUse)
+{
+	const rs2::StructDesc* results[8] = {};
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < _countof(results); ++i)
+		threads.emplace_back([&results, i]() { results[i] = LazyRegisteredStruct::GetStructDesc(); });
+	for(size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+
+	for(size_t i = 0; i < _countof(results); ++i)
+		EXPECT_EQ(results[0], results[i]);
+	ASSERT_EQ(1, results[0]->Params.size());
+	EXPECT_EQ(results[0], rs2::GetTypeRegistry().FindStruct(L"LazyRegisteredStruct"));
+}
+
+struct AccessFlagsStruct
+{
+	int32_t Value;
+	int32_t ReadOnly;
+	int32_t WriteOnly;
+
+	static const rs2::StructDesc* GetStructDesc();
+};
+
+const rs2::StructDesc* AccessFlagsStruct::GetStructDesc()
+{
+	RS2_GET_STRUCT_DESC_BEGIN(AccessFlagsStruct);
+	RS2_ADD_PARAM_INT(Value, rs2::STORAGE::RAW, 0);
+	RS2_ADD_PARAM_INT(ReadOnly, rs2::STORAGE::RAW, 0).SetFlags(rs2::ParamDesc::FLAG_READ_ONLY);
+	RS2_ADD_PARAM_INT(WriteOnly, rs2::STORAGE::RAW, 0).SetFlags(rs2::ParamDesc::FLAG_WRITE_ONLY);
+	RS2_GET_STRUCT_DESC_END();
+}
+
+struct AccessFlagsContainer
+{
+	AccessFlagsStruct Inner;
+	int32_t Last;
+};
+
+TEST(Binary, ReadOnlyAndWriteOnly)
+{
+	const rs2::StructDesc* structDesc = AccessFlagsStruct::GetStructDesc();
+	rs2::StructDesc containerStructDesc(L"AccessFlagsContainer", sizeof(AccessFlagsContainer));
+	containerStructDesc.AddParam(L"Inner", offsetof(AccessFlagsContainer, Inner),
+		new rs2::StructParamDesc(structDesc)).SetFlags(rs2::ParamDesc::FLAG_READ_ONLY);
+	containerStructDesc.AddParam(L"Last", offsetof(AccessFlagsContainer, Last),
+		new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+
+	const AccessFlagsStruct obj = { 1, 2, 3 };
+	const AccessFlagsContainer containerObj = { { 4, 5, 6 }, 7 };
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToBinary(writer, &obj, *structDesc);
+	EXPECT_EQ(2 * sizeof(int32_t), writer.GetSize());
+	rs2::SaveObjToBinary(writer, &containerObj, containerStructDesc);
+	EXPECT_EQ(5 * sizeof(int32_t), writer.GetSize());
+
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	AccessFlagsStruct loadedObj = { 10, 20, 30 };
+	rs2::LoadObjFromBinary(&loadedObj, *structDesc, reader);
+	EXPECT_EQ(1, loadedObj.Value);
+	EXPECT_EQ(20, loadedObj.ReadOnly);
+	EXPECT_EQ(30, loadedObj.WriteOnly);
+	// Whole structure that cannot be written is skipped.
+	AccessFlagsContainer loadedContainerObj = { { 40, 50, 60 }, 70 };
+	rs2::LoadObjFromBinary(&loadedContainerObj, containerStructDesc, reader);
+	EXPECT_EQ(40, loadedContainerObj.Inner.Value);
+	EXPECT_EQ(50, loadedContainerObj.Inner.ReadOnly);
+	EXPECT_EQ(7, loadedContainerObj.Last);
+	EXPECT_TRUE(reader.IsEnd());
+}
+
+TEST(Binary, StringOutsideOfBmp)
+{
+	// U+1F600 and U+00E9.
+	const wstring str = L"A\U0001F600\u00E9";
+	rs2::BinaryWriter writer;
+	writer.WriteString(str.data(), str.length());
+	// Surrogate pair takes two code units, also where wchar_t has 4 bytes.
+	ASSERT_EQ(sizeof(uint32_t) + 4 * sizeof(uint16_t), writer.GetSize());
+	uint16_t units[4];
+	memcpy(units, writer.GetData().data() + sizeof(uint32_t), sizeof(units));
+	EXPECT_EQ(0xD83D, units[1]);
+	EXPECT_EQ(0xDE00, units[2]);
+
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	wstring loadedStr;
+	reader.ReadString(loadedStr);
+	EXPECT_EQ(str, loadedStr);
+}
+
+TEST(Binary, SimpleStructSaveLoad)
+{
+	const rs2::StructDesc* structDesc = SimpleStruct::GetStructDesc();
+	rs2::BinaryWriter writer;
+	{
+		SimpleStruct obj;
+		obj.SetCustomValues();
+		rs2::SaveObjToBinary(writer, &obj, *structDesc);
+	}
+	{
+		SimpleStruct obj;
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		rs2::LoadObjFromBinary(&obj, *structDesc, reader);
+		EXPECT_TRUE(reader.IsEnd());
+		obj.CheckCustomValues();
+	}
+}
+
+TEST(Binary, DerivedAndContainerStructSaveLoad)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> derivedStructDesc = DerivedStruct::CreateStructDesc(simpleStructDesc);
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	rs2::BinaryWriter writer;
+	{
+		DerivedStruct derivedObj;
+		derivedObj.SetCustomValues();
+		rs2::SaveObjToBinary(writer, &derivedObj, *derivedStructDesc);
+		ContainerStruct containerObj;
+		containerObj.SetCustomValues();
+		rs2::SaveObjToBinary(writer, &containerObj, *containerStructDesc);
+	}
+	{
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		DerivedStruct derivedObj;
+		rs2::LoadObjFromBinary(&derivedObj, *derivedStructDesc, reader);
+		derivedObj.CheckCustomValues();
+		ContainerStruct containerObj;
+		rs2::LoadObjFromBinary(&containerObj, *containerStructDesc, reader);
+		containerObj.CheckCustomValues();
+		EXPECT_TRUE(reader.IsEnd());
+	}
+}
+
+TEST(Binary, MathStructSaveLoad)
+{
+	const rs2::StructDesc* structDesc = MathStruct::GetStructDesc();
+	rs2::BinaryWriter writer;
+	{
+		MathStruct obj;
+		obj.SetCustomValues();
+		rs2::SaveObjToBinary(writer, &obj, *structDesc);
+	}
+	EXPECT_EQ(sizeof(VEC2) + sizeof(VEC3) + sizeof(VEC4), writer.GetSize());
+	{
+		MathStruct obj;
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		rs2::LoadObjFromBinary(&obj, *structDesc, reader);
+		obj.CheckCustomValues();
+	}
+}
+
+TEST(Binary, PodAndIncomplete)
+{
+	rs2::StructDesc structDesc(L"PodStruct", sizeof(PodStruct));
+	structDesc.AddParam(
+		L"IntValue",
+		offsetof(PodStruct, IntValue),
+		new rs2::IntParamDesc(rs2::STORAGE::RAW, 10));
+	structDesc.AddParam(
+		L"FloatArray",
+		offsetof(PodStruct, FloatArray),
+		new rs2::FixedSizeArrayParamDesc(new rs2::FloatParamDesc(rs2::STORAGE::RAW, 0.5f), 3));
+	structDesc.AddParam(
+		L"Vec2Value",
+		offsetof(PodStruct, Vec2Value),
+		new rs2::Vec2ParamDesc(rs2::STORAGE::RAW, VEC2(1.f, 2.f)));
+	ASSERT_TRUE(structDesc.IsPod());
+
+	PodStruct obj1 = { 5, { 1.f, 2.f, 3.f }, VEC2(4.f, 5.f) };
+	rs2::BinaryWriter podWriter;
+	rs2::SaveObjToBinary(podWriter, &obj1, structDesc);
+	EXPECT_EQ(sizeof(PodStruct), podWriter.GetSize());
+
+	// Parameters saved one by one must produce same data as bulk copy.
+	structDesc.Params[0]->Flags |= rs2::ParamDesc::FLAG_MINMAX_CLAMP_ON_SET;
+	structDesc.InvalidateLayoutPlan();
+	ASSERT_FALSE(structDesc.IsPod());
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToBinary(writer, &obj1, structDesc);
+	EXPECT_EQ(podWriter.GetData(), writer.GetData());
+
+	PodStruct obj2;
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	rs2::LoadObjFromBinary(&obj2, structDesc, reader);
+	EXPECT_EQ(5, obj2.IntValue);
+	EXPECT_EQ(3.f, obj2.FloatArray[2]);
+	EXPECT_EQ(VEC2(4.f, 5.f), obj2.Vec2Value);
+
+	rs2::BinaryReader incompleteReader(writer.GetData().data(), writer.GetSize() - 1);
+	EXPECT_THROW(rs2::LoadObjFromBinary(&obj2, structDesc, incompleteReader), common::Error);
+}
+
+TEST(ChunkedBinary, SaveLoad)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> derivedStructDesc = DerivedStruct::CreateStructDesc(simpleStructDesc);
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	rs2::BinaryWriter writer;
+	rs2::WriteChunkedBinaryHeader(writer);
+	{
+		DerivedStruct derivedObj;
+		derivedObj.SetCustomValues();
+		rs2::SaveObjToChunkedBinary(writer, &derivedObj, *derivedStructDesc);
+		ContainerStruct containerObj;
+		containerObj.SetCustomValues();
+		rs2::SaveObjToChunkedBinary(writer, &containerObj, *containerStructDesc);
+	}
+	{
+		const rs2::STokDocLoadConfig config(rs2::TOKDOC_FLAG_REQUIRED);
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		EXPECT_EQ(rs2::CHUNKED_BINARY_VERSION, rs2::ReadChunkedBinaryHeader(reader));
+		DerivedStruct derivedObj;
+		EXPECT_TRUE(rs2::LoadObjFromChunkedBinary(&derivedObj, *derivedStructDesc, reader, config));
+		derivedObj.CheckCustomValues();
+		ContainerStruct containerObj;
+		EXPECT_TRUE(rs2::LoadObjFromChunkedBinary(&containerObj, *containerStructDesc, reader, config));
+		containerObj.CheckCustomValues();
+		EXPECT_TRUE(reader.IsEnd());
+	}
+
+	rs2::BinaryReader invalidReader(writer.GetData().data() + 1, writer.GetSize() - 1);
+	EXPECT_THROW(rs2::ReadChunkedBinaryHeader(invalidReader), common::Error);
+}
+
+struct VersionedStruct
+{
+	int32_t IntValue;
+	float FloatValue;
+	wstring StringValue;
+	uint32_t UintValue;
+	int32_t Array[2];
+};
+
+TEST(ChunkedBinary, SchemaChange)
+{
+	rs2::StructDesc oldDesc(L"VersionedStruct", sizeof(VersionedStruct));
+	oldDesc.AddParam(L"IntValue", offsetof(VersionedStruct, IntValue), new rs2::IntParamDesc(rs2::STORAGE::RAW, 1));
+	oldDesc.AddParam(L"FloatValue", offsetof(VersionedStruct, FloatValue), new rs2::FloatParamDesc(rs2::STORAGE::RAW, 2.f));
+	oldDesc.AddParam(L"StringValue", offsetof(VersionedStruct, StringValue), new rs2::StringParamDesc(rs2::STORAGE::RAW, L"Old"));
+	oldDesc.AddParam(L"Array", offsetof(VersionedStruct, Array),
+		new rs2::FixedSizeArrayParamDesc(new rs2::IntParamDesc(rs2::STORAGE::RAW, 3), 2));
+
+	VersionedStruct oldObj = { 10, 20.f, L"Saved", 0, { 30, 40 } };
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToChunkedBinary(writer, &oldObj, oldDesc);
+
+	// IntValue removed, params reordered, UintValue added.
+	rs2::StructDesc newDesc(L"VersionedStruct", sizeof(VersionedStruct));
+	newDesc.AddParam(L"Array", offsetof(VersionedStruct, Array),
+		new rs2::FixedSizeArrayParamDesc(new rs2::IntParamDesc(rs2::STORAGE::RAW, 3), 2));
+	newDesc.AddParam(L"StringValue", offsetof(VersionedStruct, StringValue), new rs2::StringParamDesc(rs2::STORAGE::RAW, L"New"));
+	newDesc.AddParam(L"UintValue", offsetof(VersionedStruct, UintValue), new rs2::UintParamDesc(rs2::STORAGE::RAW, 5u));
+	newDesc.AddParam(L"FloatValue", offsetof(VersionedStruct, FloatValue), new rs2::FloatParamDesc(rs2::STORAGE::RAW, 7.f));
+
+	{
+		VersionedStruct newObj = {};
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		EXPECT_THROW(
+			rs2::LoadObjFromChunkedBinary(&newObj, newDesc, reader, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED)),
+			common::Error);
+	}
+	{
+		VersionedStruct newObj = {};
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		bool ok = rs2::LoadObjFromChunkedBinary(&newObj, newDesc, reader,
+			rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_OPTIONAL | rs2::TOKDOC_FLAG_DEFAULT));
+		EXPECT_FALSE(ok);
+		EXPECT_TRUE(reader.IsEnd());
+		EXPECT_EQ(0, newObj.IntValue);
+		EXPECT_EQ(20.f, newObj.FloatValue);
+		EXPECT_EQ(L"Saved", newObj.StringValue);
+		EXPECT_EQ(5u, newObj.UintValue);
+		EXPECT_EQ(40, newObj.Array[1]);
+	}
+	{
+		// Incorrect value: saved int loaded as string.
+		rs2::StructDesc stringDesc(L"VersionedStruct", sizeof(VersionedStruct));
+		stringDesc.AddParam(L"IntValue", offsetof(VersionedStruct, StringValue), new rs2::StringParamDesc(rs2::STORAGE::RAW, L"Default"));
+		VersionedStruct newObj = {};
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		bool ok = rs2::LoadObjFromChunkedBinary(&newObj, stringDesc, reader,
+			rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_OPTIONAL | rs2::TOKDOC_FLAG_DEFAULT));
+		EXPECT_FALSE(ok);
+		EXPECT_EQ(L"Default", newObj.StringValue);
+	}
+}
+
+TEST(ChunkedBinary, TypeChange)
+{
+	rs2::StructDesc oldDesc(L"VersionedStruct", sizeof(VersionedStruct));
+	oldDesc.AddParam(L"IntValue", offsetof(VersionedStruct, IntValue), new rs2::IntParamDesc(rs2::STORAGE::RAW, 1));
+	oldDesc.AddParam(L"UintValue", offsetof(VersionedStruct, UintValue), new rs2::UintParamDesc(rs2::STORAGE::RAW, 2u));
+
+	VersionedStruct oldObj = { 10, 0.f, L"", 20, { 0, 0 } };
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToChunkedBinary(writer, &oldObj, oldDesc);
+
+	// IntValue changed to float of the same size, UintValue changed to array.
+	rs2::StructDesc newDesc(L"VersionedStruct", sizeof(VersionedStruct));
+	newDesc.AddParam(L"IntValue", offsetof(VersionedStruct, FloatValue), new rs2::FloatParamDesc(rs2::STORAGE::RAW, 7.f));
+	newDesc.AddParam(L"UintValue", offsetof(VersionedStruct, Array),
+		new rs2::FixedSizeArrayParamDesc(new rs2::IntParamDesc(rs2::STORAGE::RAW, 3), 2));
+
+	{
+		VersionedStruct newObj = {};
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		EXPECT_THROW(
+			rs2::LoadObjFromChunkedBinary(&newObj, newDesc, reader, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_REQUIRED)),
+			common::Error);
+	}
+	{
+		VersionedStruct newObj = {};
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		bool ok = rs2::LoadObjFromChunkedBinary(&newObj, newDesc, reader,
+			rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_OPTIONAL | rs2::TOKDOC_FLAG_DEFAULT));
+		EXPECT_FALSE(ok);
+		EXPECT_TRUE(reader.IsEnd());
+		EXPECT_EQ(7.f, newObj.FloatValue);
+		EXPECT_EQ(3, newObj.Array[0]);
+		EXPECT_EQ(3, newObj.Array[1]);
+	}
+}
+
+TEST(ChunkedBinary, NameHashCollision)
+{
+	// Derived structure has parameter with the same name as its base.
+	rs2::StructDesc baseDesc(L"VersionedStruct", sizeof(VersionedStruct));
+	baseDesc.AddParam(L"IntValue", offsetof(VersionedStruct, IntValue), new rs2::IntParamDesc(rs2::STORAGE::RAW, 1));
+	rs2::StructDesc derivedDesc(L"DerivedVersionedStruct", sizeof(VersionedStruct), &baseDesc);
+	derivedDesc.AddParam(L"IntValue", offsetof(VersionedStruct, UintValue), new rs2::UintParamDesc(rs2::STORAGE::RAW, 2u));
+	EXPECT_FALSE(baseDesc.HasNameHashCollision());
+	EXPECT_TRUE(derivedDesc.HasNameHashCollision());
+
+	VersionedStruct obj = {};
+	rs2::BinaryWriter writer;
+	EXPECT_THROW(rs2::SaveObjToChunkedBinary(writer, &obj, derivedDesc), common::Error);
+	EXPECT_THROW(rs2::SaveObjToChunkedBinaryDelta(writer, &obj, nullptr, derivedDesc), common::Error);
+
+	rs2::SaveObjToChunkedBinary(writer, &obj, baseDesc);
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	EXPECT_THROW(
+		rs2::LoadObjFromChunkedBinary(&obj, derivedDesc, reader, rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_OPTIONAL)),
+		common::Error);
+}
+
+TEST(ChunkedBinary, DeltaSaveLoad)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	ContainerStruct defaultObj;
+	containerStructDesc->SetObjToDefault(&defaultObj);
+	rs2::BinaryWriter fullWriter, emptyWriter, writer;
+	rs2::SaveObjToChunkedBinary(fullWriter, &defaultObj, *containerStructDesc);
+	rs2::SaveObjToChunkedBinaryDelta(emptyWriter, &defaultObj, nullptr, *containerStructDesc);
+	// Only header of the object.
+	EXPECT_EQ(9, emptyWriter.GetSize());
+
+	ContainerStruct obj;
+	containerStructDesc->CopyObj(&obj, &defaultObj);
+	obj.StructParam.FloatParam = 13.5f;
+	obj.StructParam.GameTimeParam = common::MillisecondsToGameTime(123);
+	rs2::SaveObjToChunkedBinaryDelta(writer, &obj, &defaultObj, *containerStructDesc);
+	EXPECT_LT(writer.GetSize(), fullWriter.GetSize());
+
+	ContainerStruct loadedObj;
+	containerStructDesc->SetObjToDefault(&loadedObj);
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	EXPECT_TRUE(rs2::LoadObjFromChunkedBinary(&loadedObj, *containerStructDesc, reader,
+		rs2::STokDocLoadConfig(rs2::TOKDOC_FLAG_PATCH)));
+	EXPECT_TRUE(reader.IsEnd());
+	EXPECT_TRUE(rs2::ParamEquals(&obj, &loadedObj, rs2::StructParamDesc(containerStructDesc.get())));
+	EXPECT_EQ(13.5f, loadedObj.StructParam.FloatParam.GetConst());
+	EXPECT_EQ(-10, loadedObj.StructParam.IntParam.GetConst());
+}
+
+struct QuantizedStruct
+{
+	float Percent;
+	common::VEC3 Color;
+	float Unbounded;
+	bool Flag;
+	int32_t Count;
+	wstring Name;
+
+	static const rs2::StructDesc* GetStructDesc();
+};
+
+const rs2::StructDesc* QuantizedStruct::GetStructDesc()
+{
+	RS2_GET_STRUCT_DESC_BEGIN(QuantizedStruct);
+	RS2_ADD_PARAM_FLOAT_PERCENT(Percent, rs2::STORAGE::RAW, 0.5f);
+	RS2_ADD_PARAM_VEC3_COLOR(Color, rs2::STORAGE::RAW, common::VEC3(1.f, 1.f, 1.f));
+	RS2_ADD_PARAM_FLOAT(Unbounded, rs2::STORAGE::RAW, 0.f);
+	RS2_ADD_PARAM_BOOL(Flag, rs2::STORAGE::RAW, false);
+	RS2_ADD_PARAM_INT(Count, rs2::STORAGE::RAW, 0);
+	RS2_ADD_PARAM_STRING(Name, rs2::STORAGE::RAW, L"");
+	RS2_GET_STRUCT_DESC_END();
+}
+
+TEST(QuantizedBinary, SaveLoad)
+{
+	EXPECT_EQ(7, rs2::GetQuantizedBitCount(0.f, 1.f, 0.01f));
+	EXPECT_EQ(9, rs2::GetQuantizedBitCount(0.f, 1.f, 1.f / 256.f));
+	EXPECT_EQ(8, rs2::GetQuantizedBitCount(0.f, 1.f, 1.f / 255.f));
+	EXPECT_EQ(0, rs2::GetQuantizedBitCount(-FLT_MAX, FLT_MAX, 1.f));
+	EXPECT_EQ(0, rs2::GetQuantizedBitCount(0.f, 1.f, 0.f));
+	EXPECT_EQ(0.f, rs2::GetQuantizationMaxError(-FLT_MAX, 1.f, 1.f));
+
+	const rs2::StructDesc* structDesc = QuantizedStruct::GetStructDesc();
+	const rs2::FloatParamDesc& percentDesc = *(const rs2::FloatParamDesc*)structDesc->GetParamDesc(0);
+	const rs2::Vec3ParamDesc& colorDesc = *(const rs2::Vec3ParamDesc*)structDesc->GetParamDesc(1);
+	const float percentMaxError = rs2::GetQuantizationMaxError(percentDesc);
+	const float colorMaxError = rs2::GetQuantizationMaxError(colorDesc);
+	EXPECT_EQ(0.005f, percentMaxError);
+
+	const float testValues[] = { 0.f, 1.f, 0.3333f, 0.505f, 0.99f, 0.996f, 0.0049f };
+	for(float testValue : testValues)
+	{
+		QuantizedStruct obj;
+		structDesc->SetObjToDefault(&obj);
+		obj.Percent = testValue;
+		obj.Color = common::VEC3(testValue, 1.f - testValue, 0.25f);
+		obj.Unbounded = 1234.5678f + testValue;
+		obj.Flag = true;
+		obj.Count = -7;
+		obj.Name = L"ABC";
+		rs2::BinaryWriter writer;
+		rs2::SaveObjToQuantizedBinary(writer, &obj, *structDesc);
+		// 7 + 3 * 9 + 32 + 1 + 8 (varint -7) + 8 (varint 3) + 3 * 16 bits.
+		EXPECT_EQ(17, writer.GetSize());
+
+		QuantizedStruct loadedObj;
+		rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+		rs2::LoadObjFromQuantizedBinary(&loadedObj, *structDesc, reader);
+		EXPECT_TRUE(reader.IsEnd());
+		EXPECT_LE(fabsf(loadedObj.Percent - obj.Percent), percentMaxError * 1.0001f);
+		EXPECT_LE(fabsf(loadedObj.Color.x - obj.Color.x), colorMaxError * 1.0001f);
+		EXPECT_LE(fabsf(loadedObj.Color.y - obj.Color.y), colorMaxError * 1.0001f);
+		EXPECT_EQ(0.25f, loadedObj.Color.z);
+		EXPECT_EQ(obj.Unbounded, loadedObj.Unbounded);
+		EXPECT_TRUE(loadedObj.Flag);
+		EXPECT_EQ(-7, loadedObj.Count);
+		EXPECT_EQ(L"ABC", loadedObj.Name);
+	}
+}
+
+TEST(QuantizedBinary, ReadOnlyAndWriteOnly)
+{
+	const rs2::StructDesc* structDesc = AccessFlagsStruct::GetStructDesc();
+	const AccessFlagsStruct obj = { 1, 2, 3 };
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToQuantizedBinary(writer, &obj, *structDesc);
+	// Varints of 1 and 2.
+	EXPECT_EQ(2, writer.GetSize());
+
+	AccessFlagsStruct loadedObj = { 10, 20, 30 };
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	rs2::LoadObjFromQuantizedBinary(&loadedObj, *structDesc, reader);
+	EXPECT_TRUE(reader.IsEnd());
+	EXPECT_EQ(1, loadedObj.Value);
+	EXPECT_EQ(20, loadedObj.ReadOnly);
+	EXPECT_EQ(30, loadedObj.WriteOnly);
+}
+
+struct BitPackedStruct
+{
+	int32_t RangedInt;
+	uint32_t RangedUint;
+	int32_t UnboundedInt;
+	uint32_t UnboundedUint;
+	NewEnumWithValues Enum;
+	bool Flags[3];
+
+	static const rs2::StructDesc* GetStructDesc();
+};
+
+const rs2::StructDesc* BitPackedStruct::GetStructDesc()
+{
+	RS2_GET_STRUCT_DESC_BEGIN(BitPackedStruct);
+	RS2_ADD_PARAM_INT(RangedInt, rs2::STORAGE::RAW, 0).SetMin(-5).SetMax(10);
+	RS2_ADD_PARAM_UINT(RangedUint, rs2::STORAGE::RAW, 1000u).SetMin(1000u).SetMax(1255u);
+	RS2_ADD_PARAM_INT(UnboundedInt, rs2::STORAGE::RAW, 0);
+	RS2_ADD_PARAM_UINT(UnboundedUint, rs2::STORAGE::RAW, 0u);
+	RS2_ADD_PARAM_ENUM(Enum, rs2::STORAGE::RAW, &g_NewEnumWithValuesDesc, (int32_t)NewEnumWithValues::ZeroValue);
+	structDesc->EmplaceParam<rs2::FixedSizeArrayParamDesc>(L"Flags", offsetof(BitPackedStruct, Flags),
+		new rs2::BoolParamDesc(rs2::STORAGE::RAW, false), 3);
+	RS2_GET_STRUCT_DESC_END();
+}
+
+TEST(QuantizedBinary, BitPackedIntegers)
+{
+	EXPECT_EQ(0, rs2::GetBitCount(0));
+	EXPECT_EQ(1, rs2::GetBitCount(1));
+	EXPECT_EQ(8, rs2::GetBitCount(255));
+	EXPECT_EQ(9, rs2::GetBitCount(256));
+	EXPECT_EQ(32, rs2::GetBitCount(UINT_MAX));
+
+	const rs2::StructDesc* structDesc = BitPackedStruct::GetStructDesc();
+	BitPackedStruct obj;
+	obj.RangedInt = -5;
+	obj.RangedUint = 1255;
+	obj.UnboundedInt = -1000000;
+	obj.UnboundedUint = 0xFFFFFFFF;
+	obj.Enum = NewEnumWithValues::BigValue;
+	obj.Flags[0] = true;
+	obj.Flags[1] = false;
+	obj.Flags[2] = true;
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToQuantizedBinary(writer, &obj, *structDesc);
+	// 4 + 8 + 24 (varint of 1999999) + 40 + 3 + 3 bits.
+	EXPECT_EQ(11, writer.GetSize());
+
+	// Value of enum not among its items.
+	BitPackedStruct obj2 = obj;
+	obj2.RangedInt = 10;
+	obj2.UnboundedInt = 1;
+	obj2.UnboundedUint = 127;
+	obj2.Enum = (NewEnumWithValues)666;
+	rs2::SaveObjToQuantizedBinary(writer, &obj2, *structDesc);
+
+	rs2::BinaryReader reader(writer.GetData().data(), writer.GetSize());
+	BitPackedStruct loadedObj;
+	rs2::LoadObjFromQuantizedBinary(&loadedObj, *structDesc, reader);
+	EXPECT_EQ(-5, loadedObj.RangedInt);
+	EXPECT_EQ(1255, loadedObj.RangedUint);
+	EXPECT_EQ(-1000000, loadedObj.UnboundedInt);
+	EXPECT_EQ(0xFFFFFFFF, loadedObj.UnboundedUint);
+	EXPECT_EQ(NewEnumWithValues::BigValue, loadedObj.Enum);
+	EXPECT_TRUE(loadedObj.Flags[0]);
+	EXPECT_FALSE(loadedObj.Flags[1]);
+	EXPECT_TRUE(loadedObj.Flags[2]);
+	rs2::LoadObjFromQuantizedBinary(&loadedObj, *structDesc, reader);
+	EXPECT_EQ(10, loadedObj.RangedInt);
+	EXPECT_EQ(1, loadedObj.UnboundedInt);
+	EXPECT_EQ(127, loadedObj.UnboundedUint);
+	EXPECT_EQ(666, (int32_t)loadedObj.Enum);
+	EXPECT_TRUE(reader.IsEnd());
+}
+
+TEST(ConstObjView, FindAndGet)
+{
+	const rs2::StructDesc* simpleStructDesc = SimpleStruct::GetStructDesc();
+	unique_ptr<rs2::StructDesc> containerStructDesc = ContainerStruct::CreateStructDesc(simpleStructDesc);
+	const rs2::ViewLayout layout(*containerStructDesc);
+	rs2::BinaryWriter writer;
+	{
+		ContainerStruct obj;
+		containerStructDesc->SetObjToDefault(&obj);
+		rs2::SaveObjToView(writer, &obj, layout);
+	}
+	const size_t secondObjPosition = writer.GetSize();
+	{
+		ContainerStruct obj;
+		obj.SetCustomValues();
+		rs2::SaveObjToView(writer, &obj, layout);
+	}
+
+	const char* const data = writer.GetData().data();
+	rs2::ConstObjView firstView(data, secondObjPosition, layout);
+	rs2::ConstObjView secondView(data + secondObjPosition, writer.GetSize() - secondObjPosition, layout);
+
+	wstring str;
+	EXPECT_TRUE(firstView.FindParamByPath(L"StructParam\\StringParam").TryGetConst(str));
+	EXPECT_EQ(L"StringDefault", str);
+	EXPECT_TRUE(secondView.FindParamByPath(L"StructParam\\StringParam").TryGetConst(str));
+	EXPECT_EQ(L"ABC", str);
+
+	int32_t intValue = 0;
+	EXPECT_TRUE(secondView.FindParamByPath(L"structparam\\intparam", false).TryGetConst(intValue));
+	EXPECT_EQ(-20, intValue);
+	uint32_t uintValue = 0;
+	EXPECT_TRUE(secondView.FindParamByPath(L"FixedSizeArrayParam[2]").TryGetConst(uintValue));
+	EXPECT_EQ(0xDEAF, uintValue);
+	EXPECT_TRUE(firstView.FindParamByPath(L"FixedSizeArrayParam[0]").TryGetConst(uintValue));
+	EXPECT_EQ(124, uintValue);
+	GameTime gameTime;
+	EXPECT_TRUE(secondView.FindParamByPath(L"StructParam\\GameTimeParam").TryGetConst(gameTime));
+	EXPECT_EQ(common::MillisecondsToGameTime(123), gameTime);
+
+	// Wrong type, not found, struct.
+	float floatValue = 0.f;
+	EXPECT_FALSE(secondView.FindParamByPath(L"StructParam\\IntParam").TryGetConst(floatValue));
+	EXPECT_FALSE(secondView.FindParamByPath(L"StructParam\\Foo").IsValid());
+	rs2::ConstParamView structView = secondView.FindParamByPath(L"StructParam");
+	ASSERT_TRUE(structView.IsValid());
+	EXPECT_EQ(rs2::PARAM_TYPE::STRUCT, structView.GetParamDesc()->GetType());
+	EXPECT_FALSE(structView.TryGetConst(intValue));
+
+	EXPECT_THROW(rs2::ConstObjView(data, 4, layout), common::Error);
+}
+
+TEST(ConstObjView, ReadOnlyAndWriteOnly)
+{
+	const rs2::ViewLayout layout(*AccessFlagsStruct::GetStructDesc());
+	EXPECT_EQ(3 * sizeof(int32_t), layout.GetSize());
+	const AccessFlagsStruct obj = { 1, 2, 3 };
+	rs2::BinaryWriter writer;
+	rs2::SaveObjToView(writer, &obj, layout);
+
+	rs2::ConstObjView view(writer.GetData().data(), writer.GetSize(), layout);
+	int32_t value = 0;
+	EXPECT_TRUE(view.FindParamByPath(L"ReadOnly").TryGetConst(value));
+	EXPECT_EQ(2, value);
+	ASSERT_TRUE(view.FindParamByPath(L"WriteOnly").IsValid());
+	EXPECT_FALSE(view.FindParamByPath(L"WriteOnly").TryGetConst(value));
+
+	// Readable parameters inside structure that cannot be read are left zero.
+	rs2::StructDesc containerStructDesc(L"AccessFlagsContainer", sizeof(AccessFlagsContainer));
+	containerStructDesc.AddParam(L"Inner", offsetof(AccessFlagsContainer, Inner),
+		new rs2::StructParamDesc(AccessFlagsStruct::GetStructDesc())).SetFlags(rs2::ParamDesc::FLAG_WRITE_ONLY);
+	containerStructDesc.AddParam(L"Last", offsetof(AccessFlagsContainer, Last),
+		new rs2::IntParamDesc(rs2::STORAGE::RAW, 0));
+	const rs2::ViewLayout containerLayout(containerStructDesc);
+	const AccessFlagsContainer containerObj = { { 4, 5, 6 }, 7 };
+	rs2::BinaryWriter containerWriter;
+	rs2::SaveObjToView(containerWriter, &containerObj, containerLayout);
+	ASSERT_EQ(4 * sizeof(int32_t), containerWriter.GetSize());
+	int32_t values[4];
+	memcpy(values, containerWriter.GetData().data(), sizeof(values));
+	EXPECT_EQ(0, values[0]);
+	EXPECT_EQ(0, values[1]);
+	EXPECT_EQ(0, values[2]);
+	EXPECT_EQ(7, values[3]);
+
+	rs2::ConstObjView containerView(containerWriter.GetData().data(), containerWriter.GetSize(), containerLayout);
+	ASSERT_TRUE(containerView.FindParamByPath(L"Inner\\Value").IsValid());
+	EXPECT_FALSE(containerView.FindParamByPath(L"Inner\\Value").TryGetConst(value));
+	EXPECT_TRUE(containerView.FindParamByPath(L"Last").TryGetConst(value));
+	EXPECT_EQ(7, value);
+}
+
 int wmain(int argc, wchar_t** argv)
 {
 	::testing::AddGlobalTestEnvironment(new Environment());